@@ -0,0 +1,190 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <regex>
+#include <stdexcept>
+
+#include "bench.h"
+
+namespace {
+
+// two-sided 95% critical values of Student's t, by degrees of freedom
+constexpr std::array<double, 30> tCritical = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+constexpr double zCritical = 1.960;
+
+auto Critical(std::size_t freedom) -> double {
+  return (freedom <= tCritical.size()) ? tCritical.at(freedom - 1)
+                                       : zCritical;
+}
+
+} // namespace
+
+void bench8::Harness::Record(const std::string &name,
+                             const std::vector<double> &perOp) {
+  const auto count = static_cast<double>(perOp.size());
+  const double mean = std::accumulate(perOp.begin(), perOp.end(), 0.0) / count;
+
+  double ci95 = 0.0;
+  if (perOp.size() > 1) {
+    double squares = 0.0;
+    for (const auto value : perOp) {
+      squares += (value - mean) * (value - mean);
+    }
+    const double stdDev = std::sqrt(squares / (count - 1.0));
+    ci95 = Critical(perOp.size() - 1) * stdDev / std::sqrt(count);
+  }
+
+  results_.push_back({name, mean, ci95, perOp.size()});
+}
+
+void bench8::Harness::RecordEvents(const PerfCounters8::Counts &events,
+                                   std::size_t ops) {
+  auto &result = results_.back();
+  result.counted = true;
+  for (std::size_t event = 0; event < PerfCounters8::eventCount; event++) {
+    result.eventsPerOp.at(event) =
+        static_cast<double>(events.at(event)) / static_cast<double>(ops);
+  }
+}
+
+void bench8::Report(std::ostream &out, const std::vector<Result> &results,
+                    const Baseline &baseline) {
+  constexpr int nameWidth = 28;
+  constexpr int numWidth = 10;
+  constexpr int changeWidth = 9;
+  constexpr int eventWidth = 18;
+  constexpr double percent = 100.0;
+
+  std::size_t nameMax = nameWidth;
+  for (const auto &result : results) {
+    nameMax = std::max(nameMax, result.name.size() + 2);
+  }
+  const auto nameCol = static_cast<int>(nameMax);
+  const bool counted =
+      std::any_of(results.begin(), results.end(),
+                  [](const Result &result) { return result.counted; });
+
+  out << std::left << std::setw(nameCol) << "benchmark" << std::right
+      << std::setw(numWidth) << "ns/op" << std::setw(numWidth) << "+/-95%";
+  if (counted) {
+    for (std::size_t event = 0; event < PerfCounters8::eventCount; event++) {
+      out << std::setw(eventWidth)
+          << std::string(PerfCounters8::EventName(
+                 static_cast<PerfCounters8::Event>(event))) +
+                 "/op";
+    }
+  }
+  if (!baseline.empty()) {
+    out << std::setw(numWidth) << "baseline" << std::setw(changeWidth)
+        << "change";
+  }
+  out << '\n';
+
+  std::size_t faster = 0;
+  std::size_t slower = 0;
+  out << std::fixed << std::setprecision(2);
+  for (const auto &result : results) {
+    out << std::left << std::setw(nameCol) << result.name << std::right
+        << std::setw(numWidth) << result.nsPerOp << std::setw(numWidth)
+        << result.ci95;
+    if (counted) {
+      for (const auto perOp : result.eventsPerOp) {
+        out << std::setw(eventWidth) << perOp;
+      }
+    }
+
+    const auto base = baseline.find(result.name);
+    if (base != baseline.end()) {
+      const auto &old = base->second;
+      const double change = percent * (result.nsPerOp - old.nsPerOp) /
+                            old.nsPerOp;
+      out << std::setw(numWidth) << old.nsPerOp << std::setw(changeWidth - 1)
+          << std::showpos << change << std::noshowpos << '%';
+
+      if (std::abs(result.nsPerOp - old.nsPerOp) > result.ci95 + old.ci95) {
+        const bool better = (result.nsPerOp < old.nsPerOp);
+        out << (better ? "  faster" : "  slower");
+        (better ? faster : slower)++;
+      }
+    }
+    out << '\n';
+  }
+
+  if (!baseline.empty()) {
+    out << faster << " faster, " << slower << " slower, "
+        << (results.size() - faster - slower)
+        << " unchanged or not in baseline\n";
+  }
+}
+
+void bench8::SaveBaseline(const std::string &path,
+                          const std::vector<Result> &results) {
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("Could not write baseline: " + path);
+  }
+
+  // enough digits that a saved baseline reloads exactly
+  out << std::setprecision(std::numeric_limits<double>::max_digits10)
+      << "{\"benchmarks\": [\n";
+  for (std::size_t idx = 0; idx < results.size(); idx++) {
+    const auto &result = results[idx];
+    out << "  {\"name\": \"" << result.name << "\", \"ns\": " << result.nsPerOp
+        << ", \"ci95\": " << result.ci95 << ", \"samples\": " << result.samples
+        << ((idx + 1 < results.size()) ? "},\n" : "}\n");
+  }
+  out << "]}\n";
+}
+
+auto bench8::LoadBaseline(const std::string &path) -> Baseline {
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("Could not read baseline: " + path);
+  }
+
+  // only the layout written by SaveBaseline is understood
+  const std::regex entry(
+      R"re("name":\s*"([^"]*)",\s*"ns":\s*([-+.0-9eE]+),\s*)re"
+      R"re("ci95":\s*([-+.0-9eE]+),\s*"samples":\s*([0-9]+))re");
+
+  Baseline baseline;
+  std::string line;
+  std::smatch match;
+  while (std::getline(in, line)) {
+    if (std::regex_search(line, match, entry)) {
+      const auto &name = match[1].str();
+      baseline[name] = {name, std::stod(match[2].str()),
+                        std::stod(match[3].str()),
+                        std::stoul(match[4].str())};
+    }
+  }
+  return baseline;
+}
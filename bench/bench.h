@@ -0,0 +1,152 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_BENCH_H
+#define EMU8_BENCH_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "perf_counters.h"
+
+namespace bench8 {
+
+// keep the compiler from discarding a computed value, or from caching
+// memory across the barrier
+template <typename T> inline void Keep(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory"); // NOLINT
+}
+
+// hide a value from the optimizer, e.g. so a loop counter used as an address
+// cannot be used to fold away bounds checks
+template <typename T> inline auto Opaque(T value) -> T {
+  asm volatile("" : "+r"(value)); // NOLINT
+  return value;
+}
+
+inline void Clobber() {
+  asm volatile("" : : : "memory"); // NOLINT
+}
+
+struct Result {
+  std::string name{};
+  double nsPerOp{};
+  double ci95{}; // half-width of the 95% confidence interval of the mean
+  std::size_t samples{};
+
+  // hardware events per operation, over all samples, when counted
+  bool counted{false};
+  std::array<double, PerfCounters8::eventCount> eventsPerOp{};
+};
+
+using Baseline = std::map<std::string, Result>;
+
+struct Options {
+  std::size_t samples{20};
+  std::chrono::nanoseconds sampleTime{std::chrono::milliseconds(2)};
+  std::string filter{};
+
+  // count hardware events over each benchmark's samples, when given
+  const PerfCounters8 *counters{nullptr};
+};
+
+/*
+ * times small operations: each benchmark is calibrated until one sample of
+ * repeated calls takes at least sampleTime, then several samples are taken
+ * so the mean cost per operation comes with a confidence interval
+ */
+class Harness {
+public:
+  explicit Harness(Options options) : options_(std::move(options)) {}
+
+  // time body(), which performs ops operations per call
+  template <typename Body>
+  void Run(const std::string &name, std::size_t ops, Body &&body) {
+    if (!options_.filter.empty() &&
+        name.find(options_.filter) == std::string::npos) {
+      return;
+    }
+
+    std::size_t reps = 1;
+    while (Time(reps, body) < options_.sampleTime) {
+      reps *= 2;
+    }
+
+    const auto *counters = options_.counters;
+    const auto before =
+        (counters != nullptr) ? counters->Read() : PerfCounters8::Counts{};
+
+    std::vector<double> perOp;
+    for (std::size_t sample = 0; sample < options_.samples; sample++) {
+      const auto elapsed = Time(reps, body);
+      perOp.push_back(static_cast<double>(elapsed.count()) /
+                      static_cast<double>(reps * ops));
+    }
+    Record(name, perOp);
+
+    if (counters != nullptr) {
+      RecordEvents(PerfCounters8::Difference(counters->Read(), before),
+                   reps * ops * options_.samples);
+    }
+  }
+
+  [[nodiscard]] auto Results() const -> const std::vector<Result> & {
+    return results_;
+  }
+
+private:
+  Options options_;
+  std::vector<Result> results_{};
+
+  template <typename Body>
+  static auto Time(std::size_t reps, Body &body) -> std::chrono::nanoseconds {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t rep = 0; rep < reps; rep++) {
+      body();
+      Clobber();
+    }
+    return std::chrono::steady_clock::now() - start;
+  }
+
+  void Record(const std::string &name, const std::vector<double> &perOp);
+  void RecordEvents(const PerfCounters8::Counts &events, std::size_t ops);
+};
+
+// print results, with hardware events per operation when they were counted,
+// comparing against the baseline where it has an entry; a change counts only
+// when the two confidence intervals do not overlap
+void Report(std::ostream &out, const std::vector<Result> &results,
+            const Baseline &baseline);
+
+// baselines are JSON, one benchmark object per line
+void SaveBaseline(const std::string &path, const std::vector<Result> &results);
+auto LoadBaseline(const std::string &path) -> Baseline;
+
+} // namespace bench8
+
+#endif /* EMU8_BENCH_H */
@@ -0,0 +1,320 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "bench.h"
+#include "common.h"
+#include "frame_buffer.h"
+#include "instruction_set.h"
+#include "interface.h"
+#include "keypad.h"
+#include "memory.h"
+#include "perf_counters.h"
+#include "register_set.h"
+#include "tone.h"
+
+namespace bpo = boost::program_options;
+namespace fs = std::filesystem;
+
+namespace {
+
+// the machine pieces an instruction works on, without the frame loop
+struct Cpu {
+  RegisterSet8 reg{};
+  Memory8 mem{Memory8::loadAddrDefault};
+  FrameBuffer8 display{};
+  Keypad8 keypad{};
+  InstructionSet8 set{reg, mem, display, keypad};
+};
+
+struct DecodeCase {
+  std::string name;
+  std::vector<Instruction> codes;
+};
+
+// one case per opcode class, cycling through codes that leave the machine
+// able to run them again (calls are paired with returns, and so on)
+void BenchDecode(bench8::Harness &harness) {
+  const std::vector<DecodeCase> cases = {
+      {"decode 00E0 cls", {0x00E0}},
+      {"decode 1nnn jp", {0x1300}},
+      {"decode 2nnn+00EE call/ret", {0x2300, 0x00EE}},
+      {"decode 3xkk se", {0x3012}},
+      {"decode 4xkk sne", {0x4012}},
+      {"decode 5xy0 se", {0x5010}},
+      {"decode 6xkk ld", {0x6012}},
+      {"decode 7xkk add", {0x7101}},
+      {"decode 8xyN alu",
+       {0x8010, 0x8011, 0x8012, 0x8013, 0x8014, 0x8015, 0x8016, 0x8017,
+        0x801E}},
+      {"decode 9xy0 sne", {0x9010}},
+      {"decode Annn ld I", {0xA300}},
+      {"decode Bnnn jp V0", {0xB300}},
+      {"decode Cxkk rnd", {0xC0FF}},
+      {"decode Ex9E/ExA1 keys", {0xE09E, 0xE0A1}},
+      {"decode Fx07/15/18 timers", {0xF007, 0xF015, 0xF018}},
+      {"decode Fx0A key wait", {0xF00A}},
+      {"decode Fx1E..65 memory", {0xF029, 0xF01E, 0xF033, 0xF055, 0xF065}},
+  };
+
+  for (const auto &test : cases) {
+    Cpu cpu;
+    harness.Run(test.name, test.codes.size(), [&] {
+      for (const auto code : test.codes) {
+        cpu.set.DecodeExecuteInstruction(code);
+      }
+    });
+  }
+}
+
+struct DrawCase {
+  Byte rows;
+  Byte posX;
+  Byte posY;
+};
+
+// sprite heights, byte-aligned and unaligned columns, and edge wrapping
+void BenchDraw(bench8::Harness &harness) {
+  constexpr Address spriteAddr = 0x300;
+  constexpr Byte maxRows = 15;
+  constexpr Byte pattern = 0xA5;
+
+  const std::vector<DrawCase> cases = {
+      {1, 8, 4},  {5, 8, 4},  {8, 8, 4},   {15, 8, 4},
+      {5, 3, 4},  {15, 3, 4}, {8, 60, 10}, {8, 10, 28},
+      {15, 61, 27},
+  };
+
+  for (const auto &test : cases) {
+    Cpu cpu;
+    for (Address idx = 0; idx < maxRows; idx++) {
+      cpu.mem.setByte(spriteAddr + idx, pattern);
+    }
+    cpu.reg.regI = spriteAddr;
+    cpu.reg.registers[0] = test.posX;
+    cpu.reg.registers[1] = test.posY;
+
+    const auto code = static_cast<Instruction>(0xD010 | test.rows);
+    const auto name = "draw Dxyn n=" + std::to_string(test.rows) +
+                      " at " + std::to_string(test.posX) + "," +
+                      std::to_string(test.posY);
+    harness.Run(name, 1, [&] { cpu.set.DecodeExecuteInstruction(code); });
+  }
+}
+
+void BenchDisplay(bench8::Harness &harness) {
+  constexpr Byte halfLit = 0x5A;
+
+  FrameBuffer8 display;
+  harness.Run("display Clear", 1, [&] { display.Clear(); });
+
+  FrameBuffer8::Buffer screen = {};
+  screen.fill(halfLit);
+  std::array<Uint32, Interface8::pixelCount> texels = {};
+  harness.Run("display ExpandTexels", 1, [&] {
+    Interface8::ExpandTexels(screen, texels);
+    bench8::Keep(texels.data());
+  });
+}
+
+// each call walks one 256-byte page, so results are per access; addresses are
+// hidden from the optimizer and every access goes through a barrier, so bounds
+// checks are not folded away and the loops are not vectorized
+void BenchMemory(bench8::Harness &harness) {
+  constexpr Address page = 0x300;
+  constexpr Address pageSize = 0x100;
+  constexpr Word blockSize = 16;
+
+  Memory8 mem(Memory8::loadAddrDefault);
+
+  harness.Run("memory fetchByte", pageSize, [&] {
+    for (Address addr = page; addr < page + pageSize; addr++) {
+      bench8::Keep(mem.fetchByte(bench8::Opaque(addr)));
+    }
+  });
+
+  harness.Run("memory fetchByteUnchecked", pageSize, [&] {
+    for (Address addr = page; addr < page + pageSize; addr++) {
+      bench8::Keep(mem.fetchByteUnchecked(bench8::Opaque(addr)));
+    }
+  });
+
+  harness.Run("memory fetchInstruction", pageSize / 2, [&] {
+    for (Address addr = page; addr < page + pageSize; addr += 2) {
+      bench8::Keep(mem.fetchInstruction(bench8::Opaque(addr)));
+    }
+  });
+
+  harness.Run("memory setByte", pageSize, [&] {
+    for (Address addr = page; addr < page + pageSize; addr++) {
+      mem.setByte(bench8::Opaque(addr), static_cast<Byte>(addr));
+      bench8::Clobber();
+    }
+  });
+
+  harness.Run("memory viewSequence 16", pageSize / blockSize, [&] {
+    for (Address addr = page; addr < page + pageSize; addr += blockSize) {
+      bench8::Keep(mem.viewSequence(bench8::Opaque(addr), blockSize).data());
+    }
+  });
+
+  const std::array<Byte, blockSize> block = {};
+  harness.Run("memory setSequence 16", pageSize / blockSize, [&] {
+    for (Address addr = page; addr < page + pageSize; addr += blockSize) {
+      mem.setSequence(bench8::Opaque(addr), blockSize, block);
+      bench8::Clobber();
+    }
+  });
+}
+
+// results are per sample; the callback asks for one buffer at a time
+void BenchAudio(bench8::Harness &harness) {
+  Tone8 tone(static_cast<float>(Interface8::toneFreq),
+             static_cast<float>(Interface8::audioSampleFreq));
+  std::vector<float> buffer(Interface8::defaultAudioBufSize);
+
+  harness.Run("audio tone fill", buffer.size(), [&] {
+    tone.Fill(buffer);
+    bench8::Keep(buffer.data());
+  });
+}
+
+struct BenchSettings {
+  bench8::Options options{};
+  std::string baselineFile{};
+  std::string saveFile{};
+  bool counters{false};
+};
+
+void usage(const std::string &prog) {
+  const fs::path progPath{prog};
+  std::cerr << "usage: " << progPath.filename().string() << " "
+            << "[--baseline file] [--counters] [--filter text] [--help] "
+            << "[--samples count] "
+            << "[--save file] [--time ms]\n";
+}
+
+auto parse_options(int argc, std::vector<char *> &argv,
+                   BenchSettings &settings) -> bool {
+  auto &options = settings.options;
+  unsigned sampleMs = 2;
+
+  bpo::options_description visible("Options");
+  // clang-format off
+  visible.add_options()
+    ("baseline", bpo::value<std::string>(&settings.baselineFile),
+     "Compare against results saved with --save")
+    ("counters", bpo::bool_switch(&settings.counters),
+     "Also report CPU cycles, instructions, branch misses and L1 data cache "
+     "misses per operation (Linux)")
+    ("filter", bpo::value<std::string>(&options.filter),
+     "Only run benchmarks whose name contains this text")
+    ("help", "Display help message")
+    ("samples", bpo::value<std::size_t>(&options.samples)
+                    ->default_value(options.samples),
+     "Timed samples per benchmark")
+    ("save", bpo::value<std::string>(&settings.saveFile),
+     "Save the results as a JSON baseline")
+    ("time", bpo::value<unsigned>(&sampleMs)->default_value(sampleMs),
+     "Minimum length of one sample, in milliseconds");
+  // clang-format on
+
+  bpo::variables_map varMap;
+  bpo::store(bpo::command_line_parser(argc, argv.data()).options(visible).run(),
+             varMap);
+  bpo::notify(varMap);
+
+  if (varMap.count("help") != 0) {
+    std::cout << visible << '\n';
+    return false;
+  }
+
+  if (options.samples < 2) {
+    throw std::invalid_argument("At least 2 samples are needed");
+  }
+  options.sampleTime = std::chrono::milliseconds(sampleMs);
+
+  return true;
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  std::vector<char *> vecArgs(argv, argv + argc);
+
+  BenchSettings settings;
+  try {
+    if (!parse_options(argc, vecArgs, settings)) {
+      usage(vecArgs.front());
+      return EXIT_FAILURE;
+    }
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << '\n';
+    usage(vecArgs.front());
+    return EXIT_FAILURE;
+  }
+
+  try {
+    bench8::Baseline baseline;
+    if (!settings.baselineFile.empty()) {
+      baseline = bench8::LoadBaseline(settings.baselineFile);
+    }
+
+    // counters are an optional extra, so a host without them still runs
+    std::unique_ptr<PerfCounters8> counters;
+    if (settings.counters) {
+      try {
+        counters = std::make_unique<PerfCounters8>();
+        settings.options.counters = counters.get();
+      } catch (const std::runtime_error &err) {
+        std::cerr << "WARNING: " << err.what() << '\n';
+      }
+    }
+
+    bench8::Harness harness(settings.options);
+    BenchDecode(harness);
+    BenchDraw(harness);
+    BenchDisplay(harness);
+    BenchMemory(harness);
+    BenchAudio(harness);
+
+    bench8::Report(std::cout, harness.Results(), baseline);
+
+    if (!settings.saveFile.empty()) {
+      bench8::SaveBaseline(settings.saveFile, harness.Results());
+    }
+  } catch (const std::exception &err) {
+    std::cerr << "ERROR: " << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include "alloc_counter.h"
+
+// replacement global allocation functions, counting calls per thread so the
+// emulation thread can be checked for allocator use; a thread-local counter
+// keeps the cost to one increment and keeps other threads out of the totals
+
+namespace {
+
+thread_local std::size_t threadAllocCount = 0;
+
+auto CountedAlloc(std::size_t size) -> void * {
+  threadAllocCount++;
+
+  if (size == 0) {
+    size = 1;
+  }
+
+  // standard operator new semantics: retry through the new handler, if any
+  while (true) {
+    void *ptr = std::malloc(size); // NOLINT
+    if (ptr != nullptr) {
+      return ptr;
+    }
+
+    auto *handler = std::get_new_handler();
+    if (handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+auto CountedAlignedAlloc(std::size_t size, std::align_val_t align) -> void * {
+  threadAllocCount++;
+
+  // aligned_alloc requires the size to be a multiple of the alignment
+  const auto alignment = static_cast<std::size_t>(align);
+  const std::size_t padded = ((size + alignment - 1) / alignment) * alignment;
+  const std::size_t request = (padded == 0) ? alignment : padded;
+
+  while (true) {
+    void *ptr = std::aligned_alloc(alignment, request); // NOLINT
+    if (ptr != nullptr) {
+      return ptr;
+    }
+
+    auto *handler = std::get_new_handler();
+    if (handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+} // namespace
+
+auto alloc8::ThreadAllocations() -> std::size_t { return threadAllocCount; }
+
+// NOLINTBEGIN(cppcoreguidelines-no-malloc,cppcoreguidelines-owning-memory)
+auto operator new(std::size_t size) -> void * { return CountedAlloc(size); }
+
+auto operator new[](std::size_t size) -> void * { return CountedAlloc(size); }
+
+auto operator new(std::size_t size, const std::nothrow_t & /*unused*/) noexcept
+    -> void * {
+  try {
+    return CountedAlloc(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+auto operator new[](std::size_t size,
+                    const std::nothrow_t & /*unused*/) noexcept -> void * {
+  try {
+    return CountedAlloc(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+auto operator new(std::size_t size, std::align_val_t align) -> void * {
+  return CountedAlignedAlloc(size, align);
+}
+
+auto operator new[](std::size_t size, std::align_val_t align) -> void * {
+  return CountedAlignedAlloc(size, align);
+}
+
+auto operator new(std::size_t size, std::align_val_t align,
+                  const std::nothrow_t & /*unused*/) noexcept -> void * {
+  try {
+    return CountedAlignedAlloc(size, align);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+auto operator new[](std::size_t size, std::align_val_t align,
+                    const std::nothrow_t & /*unused*/) noexcept -> void * {
+  try {
+    return CountedAlignedAlloc(size, align);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t /*unused*/) noexcept {
+  std::free(ptr);
+}
+void operator delete[](void *ptr, std::size_t /*unused*/) noexcept {
+  std::free(ptr);
+}
+void operator delete(void *ptr, const std::nothrow_t & /*unused*/) noexcept {
+  std::free(ptr);
+}
+void operator delete[](void *ptr, const std::nothrow_t & /*unused*/) noexcept {
+  std::free(ptr);
+}
+void operator delete(void *ptr, std::align_val_t /*unused*/) noexcept {
+  std::free(ptr);
+}
+void operator delete[](void *ptr, std::align_val_t /*unused*/) noexcept {
+  std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t /*unused*/,
+                     std::align_val_t /*unused*/) noexcept {
+  std::free(ptr);
+}
+void operator delete[](void *ptr, std::size_t /*unused*/,
+                       std::align_val_t /*unused*/) noexcept {
+  std::free(ptr);
+}
+void operator delete(void *ptr, std::align_val_t /*unused*/,
+                     const std::nothrow_t & /*unused*/) noexcept {
+  std::free(ptr);
+}
+void operator delete[](void *ptr, std::align_val_t /*unused*/,
+                       const std::nothrow_t & /*unused*/) noexcept {
+  std::free(ptr);
+}
+// NOLINTEND(cppcoreguidelines-no-malloc,cppcoreguidelines-owning-memory)
@@ -0,0 +1,38 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_ALLOC_COUNTER_H
+#define EMU8_ALLOC_COUNTER_H
+
+#include <cstddef>
+
+namespace alloc8 {
+
+/*
+ * number of calls to global operator new made so far by the calling thread;
+ * the replacement operators in alloc_counter.cpp keep this count, so taking
+ * the difference around a frame gives the allocations made during it
+ */
+auto ThreadAllocations() -> std::size_t;
+
+} // namespace alloc8
+
+#endif /* EMU8_ALLOC_COUNTER_H */
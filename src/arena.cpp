@@ -0,0 +1,90 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+
+#include "arena.h"
+
+namespace {
+
+auto RoundUp(std::size_t value, std::size_t multiple) -> std::size_t {
+  return ((value + multiple - 1) / multiple) * multiple;
+}
+
+} // namespace
+
+Arena8::Arena8(std::size_t slotSize, std::size_t slots, bool hugePages)
+    : slotSize_(RoundUp(std::max<std::size_t>(slotSize, 1), cacheLine)),
+      slots_(slots) {
+  if (slots_ == 0) {
+    throw std::invalid_argument("Arena needs at least one slot");
+  }
+  if (slotSize_ > SIZE_MAX / slots_) {
+    throw std::length_error("Arena too large");
+  }
+
+  const int prot = PROT_READ | PROT_WRITE;
+  const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+  void *addr = MAP_FAILED; // NOLINT
+
+#ifdef __linux__
+  if (hugePages) {
+    bytes_ = RoundUp(slotSize_ * slots_, hugePageSize);
+    addr = ::mmap(nullptr, bytes_, prot, flags | MAP_HUGETLB, -1, 0);
+    hugePages_ = (addr != MAP_FAILED); // NOLINT
+  }
+#endif
+
+  if (addr == MAP_FAILED) { // NOLINT
+    bytes_ = RoundUp(slotSize_ * slots_, hugePages ? hugePageSize : 1);
+    addr = ::mmap(nullptr, bytes_, prot, flags, -1, 0);
+    if (addr == MAP_FAILED) { // NOLINT
+      throw std::runtime_error("Could not map arena of " +
+                               std::to_string(bytes_) +
+                               " bytes: " + std::strerror(errno));
+    }
+
+#ifdef __linux__
+    // no reserved huge pages; ask for transparent ones instead
+    if (hugePages) {
+      hugePages_ = (::madvise(addr, bytes_, MADV_HUGEPAGE) == 0);
+    }
+#endif
+  }
+
+  base_ = static_cast<Byte *>(addr);
+}
+
+Arena8::~Arena8() { ::munmap(base_, bytes_); }
+
+auto Arena8::Slot(std::size_t index) const -> void * {
+  if (index >= slots_) {
+    throw std::out_of_range("Arena slot " + std::to_string(index) +
+                            " out of range");
+  }
+  return base_ + (index * slotSize_); // NOLINT
+}
@@ -0,0 +1,68 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_ARENA_H
+#define EMU8_ARENA_H
+
+#include <span>
+
+#include "common.h"
+
+/*
+ * one anonymous mapping carved into equal, cache-line aligned slots, for
+ * placing many instances side by side instead of scattering them over the
+ * heap; with huge pages requested the mapping is backed by 2 MB pages where
+ * the system allows (reserved huge pages first, then transparent huge
+ * pages), which cuts TLB misses when thousands of instances are touched in
+ * turn
+ */
+class Arena8 {
+public:
+  static constexpr std::size_t cacheLine = 64;
+  static constexpr std::size_t hugePageSize = std::size_t{2} << 20;
+
+  Arena8(std::size_t slotSize, std::size_t slots, bool hugePages = false);
+  ~Arena8();
+
+  Arena8(const Arena8 &other) = delete;
+  Arena8(Arena8 &&other) = delete;
+  auto operator=(const Arena8 &other) -> Arena8 & = delete;
+  auto operator=(Arena8 &&other) -> Arena8 & = delete;
+
+  // zero-filled storage for one slot, aligned to cacheLine
+  [[nodiscard]] auto Slot(std::size_t index) const -> void *;
+
+  [[nodiscard]] auto SlotSize() const -> std::size_t { return slotSize_; }
+  [[nodiscard]] auto Slots() const -> std::size_t { return slots_; }
+  [[nodiscard]] auto Bytes() const -> std::size_t { return bytes_; }
+
+  // whether the mapping got huge pages, reserved or transparent
+  [[nodiscard]] auto HugePages() const -> bool { return hugePages_; }
+
+private:
+  std::size_t slotSize_;
+  std::size_t slots_;
+  std::size_t bytes_{0};
+  bool hugePages_{false};
+  Byte *base_{nullptr};
+};
+
+#endif /* EMU8_ARENA_H */
@@ -0,0 +1,180 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <sstream>
+#include <vector>
+
+#include "batch_run.h"
+#include "hash.h"
+#include "save_state.h"
+
+namespace {
+
+// frames between checks of the wall clock
+constexpr uint64_t clockInterval = 64;
+
+auto JsonString(const std::string &text) -> std::string {
+  std::string out = "\"";
+  for (const char chr : text) {
+    switch (chr) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    default:
+      if (static_cast<unsigned char>(chr) < ' ') {
+        std::array<char, 8> escaped = {};
+        std::snprintf(escaped.data(), escaped.size(), "\\u%04x", // NOLINT
+                      static_cast<unsigned>(chr));
+        out += escaped.data();
+      } else {
+        out += chr;
+      }
+      break;
+    }
+  }
+  return out + "\"";
+}
+
+auto HexString(uint64_t val) -> std::string {
+  std::ostringstream hex;
+  hex << '"' << std::hex;
+  hex.width(16);
+  hex.fill('0');
+  hex << val << '"';
+  return hex.str();
+}
+
+} // namespace
+
+auto batch8::Run(std::span<const Byte> rom, const RunConfig &config)
+    -> RunResult {
+  const auto *movie = config.movie;
+  const auto memBase = (movie != nullptr) ? movie->MemBase() : config.memBase;
+  const auto ipt = (movie != nullptr) ? movie->Ipt() : config.ipt;
+  const auto seed = (movie != nullptr) ? movie->Seed() : config.seed;
+  const auto &budget = config.budget;
+
+  RunResult result;
+  const auto start = std::chrono::steady_clock::now();
+  auto elapsed = [&] {
+    const std::chrono::duration<double> secs =
+        std::chrono::steady_clock::now() - start;
+    return secs.count();
+  };
+
+  Machine8 machine(memBase, ipt, seed);
+  try {
+    if (movie != nullptr) {
+      movie8::CheckRom(*movie, rom);
+    }
+    machine.LoadProgram(rom);
+  } catch (const std::exception &err) {
+    result.status = "error";
+    result.message = err.what();
+    return result;
+  }
+
+  try {
+    while (true) {
+      const auto frame = machine.FrameCount();
+      if (budget.frames != 0 && frame >= budget.frames) {
+        result.stop = "frames";
+        break;
+      }
+      if (budget.instructions != 0 &&
+          machine.InstructionCount() + ipt > budget.instructions) {
+        result.stop = "instructions";
+        break;
+      }
+      if (budget.seconds > 0.0 && frame % clockInterval == 0 &&
+          elapsed() >= budget.seconds) {
+        result.stop = "time";
+        break;
+      }
+
+      Word keyMask = 0x0;
+      if (movie != nullptr) {
+        if (frame < movie->FrameCount()) {
+          keyMask = movie->KeyMask(frame);
+        } else if (budget.frames == 0) {
+          result.stop = "movie";
+          break;
+        }
+      }
+
+      machine.RunFrame(keyMask);
+    }
+  } catch (const std::exception &err) {
+    result.status = "fault";
+    result.message = err.what();
+    result.pc = machine.Registers().pc;
+  }
+
+  result.seconds = elapsed();
+  result.frames = machine.FrameCount();
+  result.instructions = machine.InstructionCount();
+  result.displayHash = hash8::Fnv1a(machine.Display().Data());
+
+  MachineState8 state;
+  machine.SaveState(state);
+  std::vector<Byte> image;
+  state8::Serialize(state, image);
+  result.stateHash = hash8::Fnv1a(image);
+
+  return result;
+}
+
+auto batch8::ToJson(const std::string &romPath, const RunResult &result)
+    -> std::string {
+  std::ostringstream json;
+  json << "{\"rom\":" << JsonString(romPath)
+       << ",\"status\":" << JsonString(result.status);
+
+  if (result.status == "ok") {
+    json << ",\"stop\":" << JsonString(result.stop);
+  } else {
+    json << ",\"message\":" << JsonString(result.message);
+  }
+
+  if (result.status != "error") {
+    if (result.status == "fault") {
+      json << ",\"pc\":" << result.pc;
+    }
+    json << ",\"frames\":" << result.frames
+         << ",\"instructions\":" << result.instructions
+         << ",\"seconds\":" << result.seconds
+         << ",\"framebufferHash\":" << HexString(result.displayHash)
+         << ",\"stateHash\":" << HexString(result.stateHash);
+  }
+
+  json << '}';
+  return json.str();
+}
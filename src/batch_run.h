@@ -0,0 +1,80 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_BATCH_RUN_H
+#define EMU8_BATCH_RUN_H
+
+#include <span>
+#include <string>
+
+#include "common.h"
+#include "machine.h"
+#include "memory.h"
+#include "movie.h"
+#include "random.h"
+
+/*
+ * single headless run of a ROM under fixed limits, as used by the batch
+ * runner; a run never throws for a misbehaving program, the fault is recorded
+ * in the result instead
+ */
+namespace batch8 {
+
+// zero leaves a limit off; limits are checked between frames, and a frame is
+// never started if it would run past the instruction limit
+struct Budget {
+  uint64_t frames{0};
+  uint64_t instructions{0};
+  double seconds{0.0};
+};
+
+struct RunConfig {
+  std::size_t memBase{Memory8::loadAddrDefault};
+  std::size_t ipt{Machine8::iptDefault};
+  uint64_t seed{Random8::defaultSeed};
+  Budget budget{};
+
+  // input to replay, overriding the settings above; with no frame limit the
+  // run ends with the movie
+  const movie8::Movie *movie{nullptr};
+};
+
+struct RunResult {
+  std::string status{"ok"}; // "ok", "fault" or "error"
+  std::string stop{};       // which limit ended an "ok" run
+  std::string message{};    // fault or error description
+  Address pc{0};            // program counter when a fault was raised
+  uint64_t frames{0};
+  uint64_t instructions{0};
+  double seconds{0.0};
+  uint64_t displayHash{0};
+  uint64_t stateHash{0};
+};
+
+auto Run(std::span<const Byte> rom, const RunConfig &config) -> RunResult;
+
+// one JSON object on a single line, without the trailing newline
+auto ToJson(const std::string &romPath, const RunResult &result)
+    -> std::string;
+
+} // namespace batch8
+
+#endif /* EMU8_BATCH_RUN_H */
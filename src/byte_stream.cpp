@@ -0,0 +1,40 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "byte_stream.h"
+
+auto ReadFileBytes(const std::string &path) -> std::vector<Byte> {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.good()) {
+    throw std::runtime_error("Could not open file: " + path);
+  }
+
+  std::vector<Byte> bytes(std::istreambuf_iterator<char>(file),
+                          std::istreambuf_iterator<char>{});
+  if (file.bad()) {
+    throw std::runtime_error("Could not read file: " + path);
+  }
+  return bytes;
+}
@@ -0,0 +1,102 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_BYTE_STREAM_H
+#define EMU8_BYTE_STREAM_H
+
+#include <climits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common.h"
+
+// append fixed-width little-endian fields to a byte buffer
+class ByteWriter {
+public:
+  explicit ByteWriter(std::vector<Byte> &buf) : buf_(buf) {}
+
+  template <typename T> void Put(T val) {
+    for (std::size_t idx = 0; idx < sizeof(T); idx++) {
+      buf_.push_back(static_cast<Byte>(val >> (CHAR_BIT * idx)));
+    }
+  }
+
+  template <typename T> void PutRange(std::span<const T> vals) {
+    for (const auto &val : vals) {
+      Put(val);
+    }
+  }
+
+private:
+  std::vector<Byte> &buf_;
+};
+
+// read fixed-width little-endian fields, checking every access against the
+// end of the image; name identifies the image in error messages
+class ByteReader {
+public:
+  ByteReader(std::span<const Byte> image, std::string_view name)
+      : image_(image), name_(name) {}
+
+  template <typename T> auto Get() -> T {
+    const auto bytes = Take(sizeof(T));
+
+    T val = 0;
+    for (std::size_t idx = 0; idx < sizeof(T); idx++) {
+      const auto shifted = static_cast<T>(bytes[idx]) << (CHAR_BIT * idx);
+      val = static_cast<T>(val | shifted);
+    }
+    return val;
+  }
+
+  template <typename T> void GetRange(std::span<T> vals) {
+    for (auto &val : vals) {
+      val = Get<T>();
+    }
+  }
+
+  auto Take(std::size_t count) -> std::span<const Byte> {
+    if (count > Remaining()) {
+      throw std::runtime_error(std::string(name_) + " is truncated");
+    }
+
+    const auto bytes = image_.subspan(offset_, count);
+    offset_ += count;
+    return bytes;
+  }
+
+  [[nodiscard]] auto Remaining() const -> std::size_t {
+    return image_.size() - offset_;
+  }
+
+private:
+  std::span<const Byte> image_;
+  std::string_view name_;
+  std::size_t offset_ = {0};
+};
+
+// read a whole file, e.g. a ROM image, throwing std::runtime_error on failure
+auto ReadFileBytes(const std::string &path) -> std::vector<Byte>;
+
+#endif /* EMU8_BYTE_STREAM_H */
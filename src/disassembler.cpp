@@ -0,0 +1,693 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include "bits.h"
+#include "disassembler.h"
+#include "instruction_set.h"
+
+namespace {
+
+using dis8::Analysis;
+using dis8::Block;
+
+constexpr Byte clearCode = 0xE0;
+constexpr Byte returnCode = 0xEE;
+constexpr Byte jumpNibble = 0x1;
+constexpr Byte callNibble = 0x2;
+constexpr Byte tableNibble = 0xB;
+constexpr Byte bcdCode = 0x33;
+constexpr Byte storeCode = 0x55;
+constexpr std::size_t bcdSize = 3;
+constexpr Address instructionSize = 2;
+
+auto Nibble(Instruction opcode) -> Byte {
+  return bits8::highNibble(bits8::splitWord(opcode).first);
+}
+
+auto RegX(Instruction opcode) -> Byte {
+  return bits8::lowNibble(bits8::splitWord(opcode).first);
+}
+
+auto Low(Instruction opcode) -> Byte { return bits8::splitWord(opcode).second; }
+
+// whether the machine can run opcode at all, by the decoder's own rules
+auto Decodes(Instruction opcode) -> bool {
+  try {
+    std::ignore = InstructionSet8::Decode(opcode);
+  } catch (const std::invalid_argument &err) {
+    return false;
+  }
+  return true;
+}
+
+auto IsSkip(Instruction opcode) -> bool {
+  switch (Nibble(opcode)) {
+  case 0x3:
+  case 0x4:
+  case 0x5:
+  case 0x9:
+  case 0xE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Fx33 and Fx55 write memory at I; the bytes written, or 0 for neither
+auto StoreSize(Instruction opcode) -> std::size_t {
+  if (Nibble(opcode) != 0xF) {
+    return 0;
+  }
+  if (Low(opcode) == bcdCode) {
+    return bcdSize;
+  }
+  return (Low(opcode) == storeCode) ? RegX(opcode) + 1U : 0;
+}
+
+// the value of V0 after opcode runs, as far as the opcode alone shows
+auto NextV0(Instruction opcode, std::optional<Byte> val0)
+    -> std::optional<Byte> {
+  constexpr Byte loadCode = 0x65;
+  const auto nibble = Nibble(opcode);
+  if (nibble == 0xF && Low(opcode) == loadCode) {
+    return std::nullopt;
+  }
+  if (RegX(opcode) != 0) {
+    return val0;
+  }
+
+  switch (nibble) {
+  case 0x6:
+    return Low(opcode);
+  case 0x7:
+    return val0 ? std::optional<Byte>(static_cast<Byte>(*val0 + Low(opcode)))
+                : std::nullopt;
+  case 0x8:
+  case 0xC:
+    return std::nullopt;
+  case 0xF:
+    return (Low(opcode) == 0x07 || Low(opcode) == 0x0A)
+               ? std::nullopt
+               : val0;
+  default:
+    return val0;
+  }
+}
+
+// finds the code by following every path from the load address
+class Explorer {
+public:
+  Explorer(std::span<const Byte> rom, Analysis &analysis)
+      : rom_(rom), analysis_(analysis) {}
+
+  // a Bnnn resolved from V0 is only sound if no other path joins between
+  // the LD V0 and it; when the finished exploration shows one that does, it
+  // is explored again with that Bnnn taken as a table
+  void Run() {
+    do {
+      Reset();
+      Follow(analysis_.base);
+      while (!work_.empty()) {
+        const auto start = work_.back();
+        work_.pop_back();
+        Walk(start);
+      }
+    } while (FindJoinedTables());
+    BuildBlocks();
+  }
+
+  [[nodiscard]] auto Code() const -> const std::set<Address> & {
+    return code_;
+  }
+
+private:
+  std::span<const Byte> rom_;
+  Analysis &analysis_;
+  std::vector<Address> work_{};
+  std::set<Address> code_{};
+  std::set<Address> leaders_{};
+
+  // where control can go after each instruction that ends a block
+  std::map<Address, std::vector<Address>> exits_{};
+  std::set<Address> indirect_{};
+  std::set<Address> invalid_{};
+
+  // each Bnnn resolved from V0, with the address of the LD V0 it relied on
+  std::map<Address, Address> resolved_{};
+  std::set<Address> unresolvable_{};
+
+  void Reset() {
+    work_.clear();
+    code_.clear();
+    leaders_.clear();
+    exits_.clear();
+    indirect_.clear();
+    invalid_.clear();
+    resolved_.clear();
+    analysis_.calls.clear();
+    analysis_.external.clear();
+  }
+
+  // whether any resolved Bnnn has a leader after its LD V0
+  auto FindJoinedTables() -> bool {
+    bool found = false;
+    for (const auto &[addr, load] : resolved_) {
+      const auto join = leaders_.upper_bound(load);
+      if (join != leaders_.end() && *join <= addr) {
+        unresolvable_.insert(addr);
+        found = true;
+      }
+    }
+    return found;
+  }
+
+  [[nodiscard]] auto InImage(Address addr) const -> bool {
+    return addr >= analysis_.base &&
+           addr + std::size_t{instructionSize} <=
+               analysis_.base + rom_.size();
+  }
+
+  [[nodiscard]] auto Fetch(Address addr) const -> Instruction {
+    const std::size_t offset = addr - analysis_.base;
+    return bits8::fuseBytes(rom_[offset], rom_[offset + 1]);
+  }
+
+  void Follow(Address target) {
+    if (!InImage(target)) {
+      analysis_.external.insert(target);
+      return;
+    }
+    leaders_.insert(target);
+    if (code_.count(target) == 0) {
+      work_.push_back(target);
+    }
+  }
+
+  // straight-line code from start, until it leaves or joins known code;
+  // V0 is tracked within the block so that a Bnnn can often be resolved,
+  // and forgotten wherever another path may join or a call may change it
+  void Walk(Address start) {
+    std::optional<Byte> val0;
+    Address load = start;
+    for (auto addr = start;; addr = static_cast<Address>(addr +
+                                                          instructionSize)) {
+      if (!InImage(addr)) {
+        analysis_.external.insert(addr);
+        return;
+      }
+      if (!code_.insert(addr).second) {
+        // running into known code from here is another way in
+        leaders_.insert(addr);
+        return;
+      }
+
+      const auto opcode = Fetch(addr);
+      const auto next = static_cast<Address>(addr + instructionSize);
+      const auto target = bits8::maskAddress(opcode);
+      if (!Decodes(opcode)) {
+        invalid_.insert(addr);
+        exits_[addr] = {};
+        return;
+      }
+
+      if (Nibble(opcode) == 0x0 && Low(opcode) == returnCode) {
+        exits_[addr] = {};
+        return;
+      }
+      if (leaders_.count(addr) != 0) {
+        val0.reset();
+      }
+
+      switch (Nibble(opcode)) {
+      case jumpNibble:
+        exits_[addr] = {target};
+        Follow(target);
+        return;
+      case callNibble:
+        analysis_.calls[target];
+        Follow(target);
+        exits_[addr] = {next};
+        leaders_.insert(next);
+        val0.reset();
+        continue;
+      case tableNibble:
+        if (val0 && unresolvable_.count(addr) == 0) {
+          resolved_[addr] = load;
+        } else {
+          val0.reset();
+        }
+        JumpTable(addr, target, val0);
+        return;
+      default:
+        if (IsSkip(opcode)) {
+          const auto skipped = static_cast<Address>(next + instructionSize);
+          exits_[addr] = {next, skipped};
+          leaders_.insert(next);
+          Follow(skipped);
+        }
+        break;
+      }
+      if (Nibble(opcode) == 0x6 && RegX(opcode) == 0) {
+        load = addr;
+      }
+      val0 = NextV0(opcode, val0);
+    }
+  }
+
+  // Bnnn jumps to nnn + V0: one target when V0 is known, otherwise the
+  // usual table of 1nnn jumps at nnn, taking each entry as a target
+  void JumpTable(Address addr, Address table, std::optional<Byte> val0) {
+    auto &exits = exits_[addr];
+    if (val0) {
+      exits.push_back(static_cast<Address>(table + *val0));
+    } else {
+      for (std::size_t entry = 0; entry < dis8::maxTableEntries; entry++) {
+        const auto slot = static_cast<Address>(table + entry * instructionSize);
+        if (!InImage(slot) || Nibble(Fetch(slot)) != jumpNibble) {
+          break;
+        }
+        exits.push_back(slot);
+      }
+      if (exits.empty()) {
+        exits.push_back(table);
+        indirect_.insert(addr);
+      }
+    }
+
+    for (const auto target : exits) {
+      Follow(target);
+    }
+  }
+
+  void BuildBlocks() {
+    for (const auto start : leaders_) {
+      if (code_.count(start) == 0) {
+        continue;
+      }
+
+      auto last = start;
+      while (exits_.count(last) == 0) {
+        const auto next = static_cast<Address>(last + instructionSize);
+        if (code_.count(next) == 0 || leaders_.count(next) != 0) {
+          break;
+        }
+        last = next;
+      }
+
+      Block block;
+      block.start = start;
+      block.end = static_cast<Address>(last + instructionSize);
+      const auto exits = exits_.find(last);
+      block.successors = (exits != exits_.end())
+                             ? exits->second
+                             : std::vector<Address>{block.end};
+      block.indirect = (indirect_.count(last) != 0);
+      block.invalid = (invalid_.count(last) != 0);
+      analysis_.blocks[start] = std::move(block);
+    }
+  }
+};
+
+// the routines each routine calls, following its blocks from its entry
+void BuildCallGraph(std::span<const Byte> rom, Analysis &analysis) {
+  analysis.calls[analysis.base];
+  for (auto &[entry, callees] : analysis.calls) {
+    std::set<Address> seen;
+    std::vector<Address> work{entry};
+    while (!work.empty()) {
+      const auto addr = work.back();
+      work.pop_back();
+      const auto found = analysis.blocks.find(addr);
+      if (found == analysis.blocks.end() || !seen.insert(addr).second) {
+        continue;
+      }
+
+      const auto &block = found->second;
+      const std::size_t offset = block.end - instructionSize - analysis.base;
+      const auto last = bits8::fuseBytes(rom[offset], rom[offset + 1]);
+      if (Nibble(last) == callNibble) {
+        callees.insert(bits8::maskAddress(last));
+      }
+      work.insert(work.end(), block.successors.begin(),
+                  block.successors.end());
+    }
+  }
+}
+
+// I is known at a block's start when every way in sets it to the same
+// address; calls pass I on, and after a call returns it is unknown
+void FindSelfWrites(std::span<const Byte> rom, const std::set<Address> &code,
+                    Analysis &analysis) {
+  using State = std::optional<Address>;
+  std::map<Address, State> entry;
+  std::vector<Address> work;
+  const auto merge = [&](Address target, State state) {
+    if (analysis.blocks.count(target) == 0) {
+      return;
+    }
+    const auto [found, added] = entry.emplace(target, state);
+    if (!added) {
+      if (found->second == state || !found->second) {
+        return;
+      }
+      found->second = std::nullopt;
+    }
+    work.push_back(target);
+  };
+
+  const auto fetch = [&](Address addr) {
+    const std::size_t offset = addr - analysis.base;
+    return bits8::fuseBytes(rom[offset], rom[offset + 1]);
+  };
+
+  // runs a block from state, reporting stores when record is set
+  const auto run = [&](const Block &block, State regI, bool record) {
+    for (auto addr = block.start; addr < block.end;
+         addr = static_cast<Address>(addr + instructionSize)) {
+      const auto opcode = fetch(addr);
+      const auto stored = StoreSize(opcode);
+      if (record && stored > 0) {
+        // an instruction at I - 1 already has its second byte at I
+        bool hitsCode = false;
+        if (regI) {
+          const auto first = code.lower_bound(
+              static_cast<Address>(std::max(*regI, Address{1}) - 1));
+          hitsCode = (first != code.end() && *first < *regI + stored);
+        }
+        if (!regI || hitsCode) {
+          analysis.selfWrites.push_back(
+              {addr, regI.has_value(), regI.value_or(0), stored});
+        }
+      }
+
+      if (Nibble(opcode) == 0xA) {
+        regI = bits8::maskAddress(opcode);
+      } else if (Nibble(opcode) == 0xF &&
+                 (Low(opcode) == 0x1E || Low(opcode) == 0x29)) {
+        regI = std::nullopt;
+      }
+    }
+    return regI;
+  };
+
+  merge(analysis.base, std::nullopt);
+  while (!work.empty()) {
+    const auto start = work.back();
+    work.pop_back();
+    const auto &block = analysis.blocks.at(start);
+    const auto regI = run(block, entry.at(start), false);
+
+    const auto last = fetch(static_cast<Address>(block.end - instructionSize));
+    if (Nibble(last) == callNibble) {
+      merge(bits8::maskAddress(last), regI);
+      merge(block.end, std::nullopt);
+    } else {
+      for (const auto target : block.successors) {
+        merge(target, regI);
+      }
+    }
+  }
+
+  for (const auto &[start, regI] : entry) {
+    run(analysis.blocks.at(start), regI, true);
+  }
+  std::sort(analysis.selfWrites.begin(), analysis.selfWrites.end(),
+            [](const auto &lhs, const auto &rhs) { return lhs.pc < rhs.pc; });
+}
+
+void FindData(const std::set<Address> &code, Analysis &analysis) {
+  const auto end = static_cast<std::size_t>(analysis.base) + analysis.size;
+  std::size_t addr = analysis.base;
+  while (addr < end) {
+    const auto covered = [&code](std::size_t pos) {
+      const auto byte = static_cast<Address>(pos);
+      return code.count(byte) != 0 ||
+             (pos > 0 && code.count(static_cast<Address>(byte - 1)) != 0);
+    };
+    if (covered(addr)) {
+      addr++;
+      continue;
+    }
+
+    const auto start = addr;
+    while (addr < end && !covered(addr)) {
+      addr++;
+    }
+    analysis.data.emplace_back(static_cast<Address>(start),
+                               static_cast<Address>(addr));
+  }
+}
+
+auto Hex(unsigned value, int width) -> std::string {
+  std::ostringstream out;
+  out << "0x" << std::hex << std::uppercase << std::setfill('0')
+      << std::setw(width) << value;
+  return out.str();
+}
+
+auto Reg(unsigned reg) -> std::string {
+  std::ostringstream out;
+  out << 'V' << std::hex << std::uppercase << reg;
+  return out.str();
+}
+
+auto RoutineName(const Analysis &analysis, Address entry) -> std::string {
+  constexpr int addrWidth = 3;
+  if (entry == analysis.base) {
+    return "main";
+  }
+  auto name = Hex(entry, addrWidth);
+  return "sub_" + name.substr(2);
+}
+
+} // namespace
+
+auto dis8::Analysis::Instructions() const -> std::size_t {
+  std::size_t count = 0;
+  for (const auto &[start, block] : blocks) {
+    count += static_cast<std::size_t>(block.end - block.start) /
+             instructionSize;
+  }
+  return count;
+}
+
+auto dis8::Analyze(std::span<const Byte> rom, Address base) -> Analysis {
+  if (base >= Memory8::memSize ||
+      rom.size() > std::size_t{Memory8::memSize} - base) {
+    throw std::invalid_argument("ROM of " + std::to_string(rom.size()) +
+                                " bytes does not fit in memory at " +
+                                Hex(base, 3));
+  }
+
+  Analysis analysis;
+  analysis.base = base;
+  analysis.size = rom.size();
+
+  Explorer explorer(rom, analysis);
+  explorer.Run();
+  BuildCallGraph(rom, analysis);
+  FindSelfWrites(rom, explorer.Code(), analysis);
+  FindData(explorer.Code(), analysis);
+  return analysis;
+}
+
+auto dis8::Mnemonic(Instruction opcode) -> std::string {
+  constexpr int addrWidth = 3;
+  constexpr int byteWidth = 2;
+
+  if (!Decodes(opcode)) {
+    return "DW " + Hex(opcode, 4);
+  }
+
+  const auto regX = Reg(RegX(opcode));
+  const auto regY = Reg(bits8::highNibble(Low(opcode)));
+  const auto addr = Hex(bits8::maskAddress(opcode), addrWidth);
+  const auto byte = Hex(Low(opcode), byteWidth);
+  const auto nib = bits8::lowNibble(Low(opcode));
+
+  switch (Nibble(opcode)) {
+  case 0x0:
+    return (Low(opcode) == clearCode) ? "CLS" : "RET";
+  case 0x1:
+    return "JP " + addr;
+  case 0x2:
+    return "CALL " + addr;
+  case 0x3:
+    return "SE " + regX + ", " + byte;
+  case 0x4:
+    return "SNE " + regX + ", " + byte;
+  case 0x5:
+    return "SE " + regX + ", " + regY;
+  case 0x6:
+    return "LD " + regX + ", " + byte;
+  case 0x7:
+    return "ADD " + regX + ", " + byte;
+  case 0x8: {
+    constexpr std::array<const char *, 8> aluOps = {
+        "LD", "OR", "AND", "XOR", "ADD", "SUB", "SHR", "SUBN"};
+    const std::string aluOp =
+        (std::size_t{nib} < aluOps.size()) ? aluOps.at(nib) : "SHL";
+    return aluOp + " " + regX + ", " + regY;
+  }
+  case 0x9:
+    return "SNE " + regX + ", " + regY;
+  case 0xA:
+    return "LD I, " + addr;
+  case 0xB:
+    return "JP V0, " + addr;
+  case 0xC:
+    return "RND " + regX + ", " + byte;
+  case 0xD:
+    return "DRW " + regX + ", " + regY + ", " + std::to_string(nib);
+  case 0xE:
+    return ((Low(opcode) == 0x9E) ? "SKP " : "SKNP ") + regX;
+  default:
+    break;
+  }
+
+  switch (Low(opcode)) {
+  case 0x07:
+    return "LD " + regX + ", DT";
+  case 0x0A:
+    return "LD " + regX + ", K";
+  case 0x15:
+    return "LD DT, " + regX;
+  case 0x18:
+    return "LD ST, " + regX;
+  case 0x1E:
+    return "ADD I, " + regX;
+  case 0x29:
+    return "LD F, " + regX;
+  case bcdCode:
+    return "LD B, " + regX;
+  case storeCode:
+    return "LD [I], " + regX;
+  default:
+    return "LD " + regX + ", [I]";
+  }
+}
+
+void dis8::Print(std::ostream &out, std::span<const Byte> rom,
+                 const Analysis &analysis) {
+  constexpr int addrWidth = 3;
+  constexpr int opWidth = 4;
+  constexpr std::size_t bytesPerLine = 8;
+
+  const auto codeBytes = analysis.Instructions() * instructionSize;
+  out << "; " << analysis.size << " bytes at " << Hex(analysis.base, addrWidth)
+      << ": " << analysis.Instructions() << " instructions in "
+      << analysis.blocks.size() << " blocks, " << analysis.calls.size()
+      << " routines, " << analysis.size - std::min(codeBytes, analysis.size)
+      << " bytes of data\n";
+
+  const auto byteAt = [&](std::size_t addr) {
+    return rom[addr - analysis.base];
+  };
+
+  // blocks and data ranges, merged in address order
+  auto data = analysis.data.begin();
+  const auto printData = [&](Address end) {
+    for (; data != analysis.data.end() && data->first < end; data++) {
+      out << "\ndata_" << Hex(data->first, addrWidth).substr(2) << ":\n";
+      for (std::size_t line = data->first; line < data->second;
+           line += bytesPerLine) {
+        out << "  " << Hex(static_cast<unsigned>(line), addrWidth) << "  DB ";
+        const auto stop = std::min<std::size_t>(line + bytesPerLine,
+                                                data->second);
+        for (auto addr = line; addr < stop; addr++) {
+          out << Hex(byteAt(addr), 2) << ((addr + 1 < stop) ? ", " : "\n");
+        }
+      }
+    }
+  };
+
+  for (const auto &[start, block] : analysis.blocks) {
+    printData(start);
+
+    out << '\n';
+    if (analysis.calls.count(start) != 0) {
+      out << RoutineName(analysis, start) << ":\n";
+    }
+    out << "loc_" << Hex(start, addrWidth).substr(2) << ":\n";
+    for (auto addr = block.start; addr < block.end;
+         addr = static_cast<Address>(addr + instructionSize)) {
+      const auto opcode = bits8::fuseBytes(byteAt(addr), byteAt(addr + 1U));
+      out << "  " << Hex(addr, addrWidth) << "  "
+          << Hex(opcode, opWidth).substr(2) << "  " << Mnemonic(opcode)
+          << '\n';
+    }
+
+    out << "  ; ->";
+    for (const auto target : block.successors) {
+      out << ' ' << Hex(target, addrWidth);
+    }
+    if (block.successors.empty()) {
+      out << (block.invalid ? " fault" : " return");
+    }
+    if (block.indirect) {
+      out << " (unresolved table)";
+    }
+    out << '\n';
+  }
+  printData(Memory8::memSize);
+
+  out << "\n; call graph\n";
+  for (const auto &[entry, callees] : analysis.calls) {
+    out << RoutineName(analysis, entry) << " ->";
+    for (const auto callee : callees) {
+      out << ' ' << RoutineName(analysis, callee);
+    }
+    out << '\n';
+  }
+
+  out << "\n; self-modifying writes\n";
+  if (analysis.selfWrites.empty()) {
+    out << "none\n";
+  }
+  for (const auto &write : analysis.selfWrites) {
+    const auto opcode = bits8::fuseBytes(byteAt(write.pc),
+                                         byteAt(write.pc + 1U));
+    out << Hex(write.pc, addrWidth) << "  " << Mnemonic(opcode) << "  ";
+    if (write.resolved) {
+      out << "writes code at " << Hex(write.target, addrWidth) << '-'
+          << Hex(static_cast<unsigned>(write.target + write.size - 1),
+                 addrWidth)
+          << '\n';
+    } else {
+      out << "I unknown, may write code\n";
+    }
+  }
+
+  if (!analysis.external.empty()) {
+    out << "\n; targets outside the image\n";
+    for (const auto target : analysis.external) {
+      out << Hex(target, addrWidth) << '\n';
+    }
+  }
+}
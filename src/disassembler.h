@@ -0,0 +1,107 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_DISASSEMBLER_H
+#define EMU8_DISASSEMBLER_H
+
+#include <map>
+#include <ostream>
+#include <set>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+#include "memory.h"
+
+/*
+ * static analysis of a ROM image as it is loaded: recursive descent from the
+ * load address follows jumps, calls and skips to find the code that can run,
+ * splits it into basic blocks, and treats every byte it never reaches as
+ * data; the result is what predecoding or block caching would work from
+ */
+namespace dis8 {
+
+// Bnnn jump tables longer than this are cut off
+constexpr std::size_t maxTableEntries = 128;
+
+// straight-line code that ends in a control transfer or where other code
+// jumps in; successors are the addresses control can go to next, in the
+// image or not, leaving out returns
+struct Block {
+  Address start{0};
+  Address end{0}; // one past the last instruction
+  std::vector<Address> successors{};
+
+  // the last instruction is a Bnnn whose targets could not all be found
+  bool indirect{false};
+
+  // the last instruction does not decode, so the machine faults there
+  bool invalid{false};
+};
+
+// an Fx33 or Fx55 that can write over code; target and size are only
+// meaningful when I could be worked out
+struct SelfWrite {
+  Address pc{0};
+  bool resolved{false};
+  Address target{0};
+  std::size_t size{0};
+};
+
+struct Analysis {
+  Address base{0};
+  std::size_t size{0};
+
+  // by start address
+  std::map<Address, Block> blocks{};
+
+  // each routine's entry and the entries of the routines it calls; the
+  // load address stands for the top level
+  std::map<Address, std::set<Address>> calls{};
+
+  std::vector<SelfWrite> selfWrites{};
+
+  // address ranges of the image never reached as code, as [start, end)
+  std::vector<std::pair<Address, Address>> data{};
+
+  // jump and call targets outside the image, which are not followed
+  std::set<Address> external{};
+
+  [[nodiscard]] auto Instructions() const -> std::size_t;
+};
+
+// throws if the image does not fit in memory at base
+auto Analyze(std::span<const Byte> rom,
+             Address base = Memory8::loadAddrDefault) -> Analysis;
+
+// assembly text for one instruction, e.g. "DRW V1, V2, 5"
+auto Mnemonic(Instruction opcode) -> std::string;
+
+// listing of blocks and data in address order, then the call graph and
+// the self-modifying writes
+void Print(std::ostream &out, std::span<const Byte> rom,
+           const Analysis &analysis);
+
+} // namespace dis8
+
+#endif /* EMU8_DISASSEMBLER_H */
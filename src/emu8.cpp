@@ -0,0 +1,352 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <exception>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "emu8.h"
+#include "environment.h"
+#include "machine.h"
+#include "save_state.h"
+
+static_assert(EMU8_FRAMEBUFFER_SIZE == FrameBuffer8::bufferSize);
+static_assert(EMU8_DISPLAY_WIDTH == FrameBuffer8::fieldWidth);
+static_assert(EMU8_DISPLAY_HEIGHT == FrameBuffer8::fieldHeight);
+static_assert(EMU8_LOAD_ADDRESS_DEFAULT == Memory8::loadAddrDefault);
+static_assert(EMU8_INSTRUCTIONS_PER_TICK_DEFAULT == Machine8::iptDefault);
+
+// the opaque handle behind the C interface; the Machine8 is never replaced,
+// so the framebuffer pointer handed out stays valid for the handle's lifetime,
+// and the error message and scratch image may change even on const handles
+struct emu8_machine {
+  emu8_machine(std::size_t memBase, std::size_t ipt, uint64_t seed)
+      : machine(memBase, ipt, seed) {
+    machine.SaveState(initial);
+  }
+
+  Machine8 machine;
+  MachineState8 initial = {};
+  mutable std::vector<Byte> image = {};
+  mutable std::string error = {};
+  RamWindow8 window = {};
+  bool faulted = {false};
+};
+
+// the C observations mirror the batch's own, pointing at the same buffers
+struct emu8_batch {
+  emu8_batch(std::size_t count, std::span<const Byte> rom, RamWindow8 window,
+             std::size_t memBase, std::size_t ipt, uint64_t seed)
+      : environments(count, rom, window, memBase, ipt, seed),
+        observations(environments.Size()) {
+    Mirror();
+  }
+
+  EnvironmentBatch8 environments;
+  std::vector<emu8_observation> observations;
+
+  void Mirror() {
+    const auto source = environments.Observations();
+    for (std::size_t env = 0; env < source.size(); env++) {
+      observations[env].framebuffer = source[env].display.data();
+      observations[env].ram = source[env].ram.data();
+      observations[env].ram_size = source[env].ram.size();
+      observations[env].frame = source[env].frame;
+      observations[env].sound_active = source[env].sound ? 1 : 0;
+      observations[env].running = source[env].running ? 1 : 0;
+    }
+  }
+};
+
+namespace {
+
+// a failure to store the message must not escape to a C caller
+void SetError(const emu8_machine *handle, const char *what) noexcept {
+  try {
+    handle->error = what;
+  } catch (...) {
+    handle->error.clear();
+  }
+}
+
+// run an operation on the machine, turning any exception into the given
+// status code plus a stored message
+template <typename Handle, typename Operation>
+auto Guard(Handle *handle, int failure, Operation &&operation) noexcept
+    -> int {
+  if (handle == nullptr) {
+    return EMU8_ERROR_ARGUMENT;
+  }
+
+  handle->error.clear();
+  try {
+    operation(handle->machine);
+  } catch (const std::exception &err) {
+    SetError(handle, err.what());
+    return failure;
+  } catch (...) {
+    SetError(handle, "Unknown error");
+    return failure;
+  }
+
+  return EMU8_OK;
+}
+
+// stepping a faulted machine would run on from a half-executed instruction,
+// so it stays stopped until a ROM or a state is loaded
+template <typename Operation>
+auto GuardStep(emu8_machine *handle, Operation &&operation) noexcept -> int {
+  if (handle != nullptr && handle->faulted) {
+    return EMU8_ERROR_FAULT;
+  }
+
+  const int status = Guard(handle, EMU8_ERROR_FAULT, operation);
+  if (status == EMU8_ERROR_FAULT) {
+    handle->faulted = true;
+  }
+
+  return status;
+}
+
+void Describe(const emu8_machine &handle, emu8_observation &observation) {
+  const Machine8 &core = handle.machine;
+  const auto ram =
+      core.Memory().viewSequence(handle.window.start, handle.window.size);
+
+  observation.framebuffer = core.Display().Data().data();
+  observation.ram = ram.data();
+  observation.ram_size = ram.size();
+  observation.frame = core.FrameCount();
+  observation.sound_active = (core.Registers().regST > 0) ? 1 : 0;
+  observation.running = handle.faulted ? 0 : 1;
+}
+
+} // namespace
+
+auto emu8_api_version() -> int { return EMU8_API_VERSION; }
+
+auto emu8_create(uint16_t load_address, uint32_t instructions_per_tick,
+                 uint64_t seed) -> emu8_machine * {
+  if (load_address >= Memory8::memSize || instructions_per_tick == 0) {
+    return nullptr;
+  }
+
+  try {
+    return new emu8_machine(load_address, instructions_per_tick, seed);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void emu8_destroy(emu8_machine *machine) { delete machine; }
+
+auto emu8_load_rom(emu8_machine *machine, const uint8_t *rom, size_t size)
+    -> int {
+  return Guard(machine, EMU8_ERROR_ARGUMENT, [&](Machine8 &core) {
+    if (rom == nullptr || size == 0) {
+      throw std::invalid_argument("No program image given");
+    }
+
+    if (size > Memory8::memSize - core.GetMemBase()) {
+      throw std::invalid_argument("Program image of " + std::to_string(size) +
+                                  " bytes does not fit in memory");
+    }
+
+    // start over from power-on, keeping the original seed
+    core.LoadState(machine->initial);
+    core.LoadProgram(std::span<const Byte>{rom, size});
+    machine->faulted = false;
+  });
+}
+
+auto emu8_set_keys(emu8_machine *machine, uint16_t key_mask) -> int {
+  return Guard(machine, EMU8_ERROR_ARGUMENT,
+               [&](Machine8 &core) { core.Keys().SetState(key_mask); });
+}
+
+auto emu8_step_instructions(emu8_machine *machine, uint64_t count) -> int {
+  return GuardStep(machine, [&](Machine8 &core) {
+    for (uint64_t step = 0; step < count; step++) {
+      core.Step();
+    }
+  });
+}
+
+auto emu8_step_frames(emu8_machine *machine, uint64_t count) -> int {
+  return GuardStep(machine, [&](Machine8 &core) {
+    for (uint64_t frame = 0; frame < count; frame++) {
+      core.RunFrame();
+    }
+  });
+}
+
+auto emu8_set_ram_window(emu8_machine *machine, uint16_t start,
+                         uint16_t size) -> int {
+  return Guard(machine, EMU8_ERROR_ARGUMENT, [&](const Machine8 &core) {
+    std::ignore = core.Memory().viewSequence(start, size);
+    machine->window = RamWindow8{start, size};
+  });
+}
+
+auto emu8_step(emu8_machine *machine, uint16_t key_mask, uint64_t frames,
+               emu8_observation *observation) -> int {
+  if (observation == nullptr) {
+    return EMU8_ERROR_ARGUMENT;
+  }
+
+  const int status = GuardStep(machine, [&](Machine8 &core) {
+    for (uint64_t frame = 0; frame < frames; frame++) {
+      core.RunFrame(key_mask);
+    }
+  });
+
+  if (machine != nullptr) {
+    Describe(*machine, *observation);
+  }
+  return status;
+}
+
+auto emu8_framebuffer(const emu8_machine *machine) -> const uint8_t * {
+  if (machine == nullptr) {
+    return nullptr;
+  }
+
+  return machine->machine.Display().Data().data();
+}
+
+auto emu8_sound_active(const emu8_machine *machine) -> int {
+  if (machine == nullptr) {
+    return 0;
+  }
+
+  return (machine->machine.Registers().regST > 0) ? 1 : 0;
+}
+
+auto emu8_instruction_count(const emu8_machine *machine) -> uint64_t {
+  return (machine != nullptr) ? machine->machine.InstructionCount() : 0;
+}
+
+auto emu8_frame_count(const emu8_machine *machine) -> uint64_t {
+  return (machine != nullptr) ? machine->machine.FrameCount() : 0;
+}
+
+auto emu8_state_size() -> size_t { return state8::fileSize; }
+
+auto emu8_save_state(const emu8_machine *machine, uint8_t *buffer,
+                     size_t size) -> int {
+  if (buffer == nullptr || size < state8::fileSize) {
+    return EMU8_ERROR_ARGUMENT;
+  }
+
+  return Guard(machine, EMU8_ERROR_ARGUMENT, [&](const Machine8 &core) {
+    MachineState8 state;
+    core.SaveState(state);
+    state8::Serialize(state, machine->image);
+    std::copy(machine->image.begin(), machine->image.end(), buffer);
+  });
+}
+
+auto emu8_load_state(emu8_machine *machine, const uint8_t *buffer,
+                     size_t size) -> int {
+  if (buffer == nullptr) {
+    return EMU8_ERROR_ARGUMENT;
+  }
+
+  return Guard(machine, EMU8_ERROR_STATE, [&](Machine8 &core) {
+    MachineState8 state;
+    state8::Deserialize(std::span<const Byte>{buffer, size}, state);
+    core.LoadState(state);
+    machine->faulted = false;
+  });
+}
+
+auto emu8_last_error(const emu8_machine *machine) -> const char * {
+  return (machine != nullptr) ? machine->error.c_str() : "";
+}
+
+auto emu8_batch_create(size_t count, const uint8_t *rom, size_t size,
+                       uint16_t load_address, uint32_t instructions_per_tick,
+                       uint64_t seed, uint16_t ram_start, uint16_t ram_size)
+    -> emu8_batch * {
+  if (count == 0 || rom == nullptr || load_address >= Memory8::memSize ||
+      instructions_per_tick == 0) {
+    return nullptr;
+  }
+
+  try {
+    return new emu8_batch(count, std::span<const Byte>{rom, size},
+                          RamWindow8{ram_start, ram_size}, load_address,
+                          instructions_per_tick, seed);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void emu8_batch_destroy(emu8_batch *batch) { delete batch; }
+
+auto emu8_batch_size(const emu8_batch *batch) -> size_t {
+  return (batch != nullptr) ? batch->environments.Size() : 0;
+}
+
+auto emu8_batch_step(emu8_batch *batch, const uint16_t *key_masks,
+                     uint64_t frames) -> int {
+  if (batch == nullptr || key_masks == nullptr) {
+    return EMU8_ERROR_ARGUMENT;
+  }
+
+  // lanes catch their own faults, so only bad arguments can throw here
+  try {
+    batch->environments.Step(
+        std::span<const Word>{key_masks, batch->environments.Size()}, frames);
+  } catch (...) {
+    return EMU8_ERROR_ARGUMENT;
+  }
+
+  batch->Mirror();
+  return EMU8_OK;
+}
+
+auto emu8_batch_observations(const emu8_batch *batch)
+    -> const emu8_observation * {
+  return (batch != nullptr) ? batch->observations.data() : nullptr;
+}
+
+auto emu8_batch_reset(emu8_batch *batch, size_t index) -> int {
+  if (batch == nullptr || index >= batch->environments.Size()) {
+    return EMU8_ERROR_ARGUMENT;
+  }
+
+  batch->environments.Reset(index);
+  batch->Mirror();
+  return EMU8_OK;
+}
+
+auto emu8_batch_fault(const emu8_batch *batch, size_t index) -> const char * {
+  if (batch == nullptr || index >= batch->environments.Size()) {
+    return "";
+  }
+
+  return batch->environments.Fault(index).c_str();
+}
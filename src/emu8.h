@@ -0,0 +1,165 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_EMU8_H
+#define EMU8_EMU8_H
+
+/*
+ * C interface to the emu8 core (libemu8), for driving the emulator from other
+ * programs and languages without SDL; the machine is opaque, all functions
+ * are safe to call with any arguments, and none of them throws or aborts
+ *
+ * functions returning int give EMU8_OK on success or one of the EMU8_ERROR_*
+ * codes, with a description available from emu8_last_error(); one machine
+ * must not be used from several threads at once, but separate machines are
+ * independent
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define EMU8_API __attribute__((visibility("default")))
+#else
+#define EMU8_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* bumped on any incompatible change to this interface */
+#define EMU8_API_VERSION 1
+
+#define EMU8_OK 0
+#define EMU8_ERROR_ARGUMENT 1 /* bad pointer, size or value */
+#define EMU8_ERROR_FAULT 2    /* the program faulted; the machine is stopped */
+#define EMU8_ERROR_STATE 3    /* a state image could not be decoded */
+
+#define EMU8_LOAD_ADDRESS_DEFAULT 0x200
+#define EMU8_LOAD_ADDRESS_ETI660 0x600
+#define EMU8_INSTRUCTIONS_PER_TICK_DEFAULT 7
+
+/* the display: 64x32 pixels, one bit each, most significant bit leftmost,
+ * 8 bytes per row */
+#define EMU8_DISPLAY_WIDTH 64
+#define EMU8_DISPLAY_HEIGHT 32
+#define EMU8_FRAMEBUFFER_SIZE 256
+
+typedef struct emu8_machine emu8_machine;
+typedef struct emu8_batch emu8_batch;
+
+/* what a step returns: views into the machine, not copies; the pointers stay
+ * valid, and the data behind them is updated in place, until the machine or
+ * batch is destroyed */
+typedef struct emu8_observation {
+  const uint8_t *framebuffer; /* EMU8_FRAMEBUFFER_SIZE bytes */
+  const uint8_t *ram;         /* the selected RAM window */
+  size_t ram_size;
+  uint64_t frame;
+  int sound_active;
+  int running; /* 0 once the program has faulted */
+} emu8_observation;
+
+EMU8_API int emu8_api_version(void);
+
+/* returns NULL if out of memory or the load address is out of range */
+EMU8_API emu8_machine *emu8_create(uint16_t load_address,
+                                   uint32_t instructions_per_tick,
+                                   uint64_t seed);
+EMU8_API void emu8_destroy(emu8_machine *machine);
+
+/* copy a program image into memory at the load address and jump to it */
+EMU8_API int emu8_load_rom(emu8_machine *machine, const uint8_t *rom,
+                           size_t size);
+
+/* set the held keys (bit n for key n); keys not held before count as new
+ * presses for the next key wait */
+EMU8_API int emu8_set_keys(emu8_machine *machine, uint16_t key_mask);
+
+/* execute single instructions, without running the 60 Hz timers */
+EMU8_API int emu8_step_instructions(emu8_machine *machine, uint64_t count);
+
+/* run whole 60 Hz ticks: the configured instructions, then the timers */
+EMU8_API int emu8_step_frames(emu8_machine *machine, uint64_t count);
+
+/* the live display, EMU8_FRAMEBUFFER_SIZE bytes; the pointer stays valid,
+ * and is updated in place, until the machine is destroyed */
+EMU8_API const uint8_t *emu8_framebuffer(const emu8_machine *machine);
+
+/* choose the RAM included in observations (none by default) */
+EMU8_API int emu8_set_ram_window(emu8_machine *machine, uint16_t start,
+                                 uint16_t size);
+
+/* hold key_mask for the given number of frames, then describe the machine in
+ * *observation; on a fault the observation is still filled in */
+EMU8_API int emu8_step(emu8_machine *machine, uint16_t key_mask,
+                       uint64_t frames, emu8_observation *observation);
+
+/* nonzero while the sound timer is running */
+EMU8_API int emu8_sound_active(const emu8_machine *machine);
+
+EMU8_API uint64_t emu8_instruction_count(const emu8_machine *machine);
+EMU8_API uint64_t emu8_frame_count(const emu8_machine *machine);
+
+/* save states in the same versioned format as the emu8 save state files;
+ * emu8_save_state needs a buffer of at least emu8_state_size() bytes */
+EMU8_API size_t emu8_state_size(void);
+EMU8_API int emu8_save_state(const emu8_machine *machine, uint8_t *buffer,
+                             size_t size);
+EMU8_API int emu8_load_state(emu8_machine *machine, const uint8_t *buffer,
+                             size_t size);
+
+/* a batch of machines running the same ROM in lockstep, for stepping many
+ * environments at once; machine n is seeded with seed + n and observes the
+ * same RAM window; returns NULL on bad arguments or if out of memory */
+EMU8_API emu8_batch *emu8_batch_create(size_t count, const uint8_t *rom,
+                                       size_t size, uint16_t load_address,
+                                       uint32_t instructions_per_tick,
+                                       uint64_t seed, uint16_t ram_start,
+                                       uint16_t ram_size);
+EMU8_API void emu8_batch_destroy(emu8_batch *batch);
+EMU8_API size_t emu8_batch_size(const emu8_batch *batch);
+
+/* run frames ticks on every running machine, key_masks holding one mask per
+ * machine; faulted machines stay stopped until reset */
+EMU8_API int emu8_batch_step(emu8_batch *batch, const uint16_t *key_masks,
+                             uint64_t frames);
+
+/* one observation per machine, kept current by every step and reset */
+EMU8_API const emu8_observation *
+emu8_batch_observations(const emu8_batch *batch);
+
+/* return one machine to the state right after loading the ROM */
+EMU8_API int emu8_batch_reset(emu8_batch *batch, size_t index);
+
+/* why a machine stopped, or "" if it is running or the index is invalid */
+EMU8_API const char *emu8_batch_fault(const emu8_batch *batch, size_t index);
+
+/* description of the last error on this machine, or "" if none; valid until
+ * the next call on the machine */
+EMU8_API const char *emu8_last_error(const emu8_machine *machine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EMU8_EMU8_H */
@@ -0,0 +1,141 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+#include "environment.h"
+
+namespace {
+
+// checked before anything is built, since the program area is sized from it
+auto CheckedBase(std::size_t memBase) -> std::size_t {
+  if (memBase >= Memory8::memSize) {
+    throw std::invalid_argument("Load address " + std::to_string(memBase) +
+                                " is outside memory");
+  }
+  return memBase;
+}
+
+void CheckRomSize(std::span<const Byte> rom, std::size_t memBase) {
+  if (rom.empty() || rom.size() > Memory8::memSize - memBase) {
+    throw std::invalid_argument("Program image of " +
+                                std::to_string(rom.size()) +
+                                " bytes does not fit in memory");
+  }
+}
+
+} // namespace
+
+Environment8::Environment8(std::span<const Byte> rom, RamWindow8 window,
+                           std::size_t memBase, std::size_t ipt, uint64_t seed)
+    : machine_(CheckedBase(memBase), ipt, seed) {
+  CheckRomSize(rom, memBase);
+  machine_.LoadProgram(rom);
+  machine_.SaveState(initial_);
+
+  // the views are taken once; the machine's buffers never move
+  observation_.display = machine_.Display().Data();
+  observation_.ram = machine_.Memory().viewSequence(window.start, window.size);
+}
+
+auto Environment8::Reset() -> const Observation8 & {
+  machine_.LoadState(initial_);
+  fault_.clear();
+  observation_.frame = machine_.FrameCount();
+  observation_.sound = false;
+  observation_.running = true;
+  return observation_;
+}
+
+auto Environment8::Step(Word keyMask, std::size_t frames)
+    -> const Observation8 & {
+  if (!observation_.running) {
+    return observation_;
+  }
+
+  try {
+    for (std::size_t frame = 0; frame < frames; frame++) {
+      machine_.RunFrame(keyMask);
+    }
+  } catch (const std::exception &err) {
+    fault_ = err.what();
+    observation_.running = false;
+  }
+
+  observation_.frame = machine_.FrameCount();
+  observation_.sound = machine_.Registers().regST > 0;
+  return observation_;
+}
+
+EnvironmentBatch8::EnvironmentBatch8(std::size_t count,
+                                     std::span<const Byte> rom,
+                                     RamWindow8 window, std::size_t memBase,
+                                     std::size_t ipt, uint64_t seed)
+    : lanes_(count, CheckedBase(memBase), ipt), initial_(lanes_.Lanes()),
+      observations_(lanes_.Lanes()) {
+  CheckRomSize(rom, memBase);
+  lanes_.LoadProgram(rom);
+
+  for (std::size_t env = 0; env < Size(); env++) {
+    lanes_.Seed(env, seed + env);
+    lanes_.SaveLane(env, initial_[env]);
+
+    auto &observation = observations_[env];
+    observation.display = lanes_.Display(env).Data();
+    observation.ram =
+        lanes_.Memory(env).viewSequence(window.start, window.size);
+    Refresh(env);
+  }
+}
+
+void EnvironmentBatch8::Refresh(std::size_t env) {
+  auto &observation = observations_[env];
+  observation.frame = lanes_.FrameCount(env);
+  observation.sound = lanes_.SoundActive(env);
+  observation.running = lanes_.Running(env);
+}
+
+auto EnvironmentBatch8::Reset() -> std::span<const Observation8> {
+  for (std::size_t env = 0; env < Size(); env++) {
+    Reset(env);
+  }
+  return observations_;
+}
+
+void EnvironmentBatch8::Reset(std::size_t env) {
+  lanes_.LoadLane(env, initial_.at(env));
+  Refresh(env);
+}
+
+auto EnvironmentBatch8::Step(std::span<const Word> keyMasks,
+                             std::size_t frames)
+    -> std::span<const Observation8> {
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    lanes_.RunFrame(keyMasks);
+  }
+
+  for (std::size_t env = 0; env < Size(); env++) {
+    Refresh(env);
+  }
+  return observations_;
+}
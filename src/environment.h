@@ -0,0 +1,127 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_ENVIRONMENT_H
+#define EMU8_ENVIRONMENT_H
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "lockstep.h"
+#include "machine.h"
+#include "machine_state.h"
+#include "memory.h"
+
+/*
+ * step-and-observe wrappers for agent training loops: an environment loads
+ * one ROM, advances by whole frames with a key mask held, and answers with
+ * an observation made of views straight into the machine (the bit-packed
+ * display and a chosen window of RAM), so nothing is copied or unpacked;
+ * rewards and episode ends are left to the caller, who reads them out of the
+ * RAM window
+ */
+
+// the part of RAM included in each observation
+struct RamWindow8 {
+  Address start = {0};
+  Word size = {0};
+};
+
+struct Observation8 {
+  // FrameBuffer8::bufferSize bytes, rows of 8 bytes, leftmost pixel in the
+  // most significant bit
+  std::span<const Byte> display = {};
+  std::span<const Byte> ram = {};
+  uint64_t frame = {0};
+  bool sound = {false};
+
+  // false once the program has faulted; the views then stay frozen
+  bool running = {true};
+};
+
+// one machine; the views in the returned observation stay valid for the
+// lifetime of the environment
+class Environment8 {
+public:
+  explicit Environment8(std::span<const Byte> rom, RamWindow8 window = {},
+                        std::size_t memBase = Memory8::loadAddrDefault,
+                        std::size_t ipt = Machine8::iptDefault,
+                        uint64_t seed = Random8::defaultSeed);
+
+  // back to the state right after loading the ROM
+  auto Reset() -> const Observation8 &;
+
+  // run frames whole 60 Hz ticks with the given keys held
+  auto Step(Word keyMask, std::size_t frames = 1) -> const Observation8 &;
+
+  [[nodiscard]] auto Observation() const -> const Observation8 & {
+    return observation_;
+  }
+  [[nodiscard]] auto Fault() const -> const std::string & { return fault_; }
+  auto Machine() -> Machine8 & { return machine_; }
+
+private:
+  Machine8 machine_;
+  MachineState8 initial_ = {};
+  std::string fault_ = {};
+  Observation8 observation_ = {};
+};
+
+// a batch of environments on the same ROM, stepped together by a Lockstep8
+// so that environments in the same phase share their instruction dispatch;
+// environment n is seeded with seed + n, and otherwise behaves exactly like
+// an Environment8 with that seed
+class EnvironmentBatch8 {
+public:
+  EnvironmentBatch8(std::size_t count, std::span<const Byte> rom,
+                    RamWindow8 window = {},
+                    std::size_t memBase = Memory8::loadAddrDefault,
+                    std::size_t ipt = Machine8::iptDefault,
+                    uint64_t seed = Random8::defaultSeed);
+
+  [[nodiscard]] auto Size() const -> std::size_t { return lanes_.Lanes(); }
+
+  // reset every environment, or only one (e.g. at the end of its episode)
+  auto Reset() -> std::span<const Observation8>;
+  void Reset(std::size_t env);
+
+  // run frames ticks on every running environment, with one key mask each
+  auto Step(std::span<const Word> keyMasks, std::size_t frames = 1)
+      -> std::span<const Observation8>;
+
+  [[nodiscard]] auto Observations() const -> std::span<const Observation8> {
+    return observations_;
+  }
+  [[nodiscard]] auto Fault(std::size_t env) const -> const std::string & {
+    return lanes_.Fault(env);
+  }
+
+private:
+  Lockstep8 lanes_;
+  std::vector<MachineState8> initial_;
+  std::vector<Observation8> observations_;
+
+  void Refresh(std::size_t env);
+};
+
+#endif /* EMU8_ENVIRONMENT_H */
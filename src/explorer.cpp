@@ -0,0 +1,178 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "explorer.h"
+
+auto Explorer8::DefaultActions() -> std::vector<Word> {
+  std::vector<Word> actions = {0x0};
+  for (std::size_t key = 0; key < Keypad8::keyCount; key++) {
+    actions.push_back(static_cast<Word>(1U << key));
+  }
+  return actions;
+}
+
+Explorer8::Explorer8(Config config) : config_(std::move(config)) {
+  if (config_.actions.empty() || config_.framesPerAction == 0) {
+    throw std::invalid_argument("Exploration needs actions and frames");
+  }
+}
+
+auto Explorer8::Acquire() -> std::size_t {
+  if (freeSlots_.empty()) {
+    slots_.push_back(std::make_unique<Machine8>(config_.memBase, config_.ipt,
+                                                config_.seed));
+    return slots_.size() - 1;
+  }
+
+  const auto slot = freeSlots_.back();
+  freeSlots_.pop_back();
+  return slot;
+}
+
+// Machine8::RunFrame(), one instruction at a time to record coverage
+void Explorer8::RunAction(Machine8 &machine, Word keyMask) {
+  for (std::size_t frame = 0; frame < config_.framesPerAction; frame++) {
+    machine.Keys().SetState(keyMask);
+    for (std::size_t count = 0; count < config_.ipt; count++) {
+      executed_[machine.Registers().pc % Memory8::memSize] = true;
+      machine.Step();
+    }
+    machine.EndFrame();
+  }
+}
+
+// check for RAM values never seen at their address, recording them as seen
+auto Explorer8::Novel(const Machine8 &machine) -> bool {
+  const auto ram = machine.Memory().viewSequence(0, Memory8::memSize);
+
+  bool novel = false;
+  for (std::size_t addr = 0; addr < ram.size(); addr++) {
+    const auto bit = (addr << CHAR_BIT) | ram[addr];
+    if (!ramValues_[bit]) {
+      ramValues_[bit] = true;
+      novel = true;
+    }
+  }
+  return novel;
+}
+
+auto Explorer8::Solved(const Machine8 &machine) const -> bool {
+  return config_.goal.has_value() &&
+         machine.Memory().fetchByte(config_.goal->addr) == config_.goal->value;
+}
+
+auto Explorer8::Path(uint32_t node) const -> std::vector<Word> {
+  std::vector<Word> path;
+  for (; node != 0; node = nodes_[node].parent) {
+    path.push_back(nodes_[node].keyMask);
+  }
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+auto Explorer8::Run(std::span<const Byte> rom) -> Result {
+  freeSlots_.clear();
+  for (std::size_t slot = 0; slot < slots_.size(); slot++) {
+    freeSlots_.push_back(slot);
+  }
+  nodes_.assign(1, Node{});
+  seen_.clear();
+  executed_.assign(Memory8::memSize, false);
+  ramValues_.assign(std::size_t{Memory8::memSize} << CHAR_BIT, false);
+
+  // the pool keeps machines from earlier runs, so start from a clean one
+  Result result;
+  const auto root = Acquire();
+  const Machine8 fresh(config_.memBase, config_.ipt, config_.seed);
+  fresh.CloneInto(*slots_[root]);
+  slots_[root]->LoadProgram(rom);
+
+  seen_.insert(slots_[root]->StateHash());
+  std::ignore = Novel(*slots_[root]);
+  result.states = 1;
+  result.solved = Solved(*slots_[root]);
+
+  std::vector<Entry> frontier = {{root, 0}};
+  std::vector<Entry> next;
+  while (!result.solved && !frontier.empty() &&
+         result.depth < config_.maxDepth &&
+         result.states < config_.maxStates) {
+    result.depth++;
+    next.clear();
+
+    for (const auto &entry : frontier) {
+      for (const auto keyMask : config_.actions) {
+        if (result.solved || result.states >= config_.maxStates) {
+          break;
+        }
+
+        const auto slot = Acquire();
+        auto &machine = *slots_[slot];
+        slots_[entry.slot]->CloneInto(machine);
+        result.branches++;
+
+        try {
+          RunAction(machine, keyMask);
+        } catch (const std::exception & /*err*/) {
+          result.faults++;
+          Release(slot);
+          continue;
+        }
+
+        if (!seen_.insert(machine.StateHash()).second) {
+          result.duplicates++;
+          Release(slot);
+          continue;
+        }
+
+        if (config_.mode == Mode::novelty && !Novel(machine)) {
+          result.pruned++;
+          Release(slot);
+          continue;
+        }
+
+        nodes_.push_back({entry.node, keyMask});
+        next.push_back({slot, static_cast<uint32_t>(nodes_.size() - 1)});
+        result.states++;
+
+        if (Solved(machine)) {
+          result.solved = true;
+          result.solution = Path(next.back().node);
+        }
+      }
+    }
+
+    for (const auto &entry : frontier) {
+      Release(entry.slot);
+    }
+    std::swap(frontier, next);
+  }
+
+  result.covered = static_cast<std::size_t>(
+      std::count(executed_.begin(), executed_.end(), true));
+  return result;
+}
@@ -0,0 +1,118 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_EXPLORER_H
+#define EMU8_EXPLORER_H
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <unordered_set>
+#include <vector>
+
+#include "common.h"
+#include "keypad.h"
+#include "machine.h"
+#include "memory.h"
+
+/*
+ * state-space search over input sequences, for ROM coverage and for solving
+ * puzzle ROMs: starting from the loaded ROM, every state is branched once
+ * per action (a key mask held for a few frames), level by level, and states
+ * are deduplicated by Machine8::StateHash()
+ *
+ * breadth-first mode keeps every new state; novelty mode keeps only states
+ * that give some RAM byte a value it has never had at that address (width-1
+ * novelty pruning), which reaches much deeper on large state spaces
+ *
+ * states live in a pool of machines that is only ever grown, and branching
+ * is Machine8::CloneInto() into a free slot, so a step of the search costs a
+ * few KB of copying plus the emulated frames
+ */
+class Explorer8 {
+public:
+  enum class Mode { breadth, novelty };
+
+  // stop once this RAM byte holds this value
+  struct Goal {
+    Address addr{0};
+    Byte value{0};
+  };
+
+  struct Config {
+    std::size_t memBase{Memory8::loadAddrDefault};
+    std::size_t ipt{Machine8::iptDefault};
+    uint64_t seed{Random8::defaultSeed};
+    Mode mode{Mode::breadth};
+    std::vector<Word> actions{DefaultActions()};
+    std::size_t framesPerAction{4};
+    std::size_t maxDepth{64};
+    std::size_t maxStates{50000};
+    std::optional<Goal> goal{};
+  };
+
+  struct Result {
+    std::size_t depth{0};      // levels fully or partly explored
+    uint64_t branches{0};      // states produced by running an action
+    uint64_t states{0};        // distinct states kept, the root included
+    uint64_t duplicates{0};    // branches that reached a known state
+    uint64_t pruned{0};        // new states dropped as not novel
+    uint64_t faults{0};        // branches on which the program faulted
+    std::size_t covered{0};    // distinct addresses executed
+    bool solved{false};
+    std::vector<Word> solution{}; // one key mask per action, from the root
+  };
+
+  // no keys, then each single key
+  static auto DefaultActions() -> std::vector<Word>;
+
+  explicit Explorer8(Config config);
+
+  auto Run(std::span<const Byte> rom) -> Result;
+
+private:
+  struct Node {
+    uint32_t parent{0};
+    Word keyMask{0};
+  };
+
+  struct Entry {
+    std::size_t slot{0};
+    uint32_t node{0};
+  };
+
+  Config config_;
+  std::vector<std::unique_ptr<Machine8>> slots_{};
+  std::vector<std::size_t> freeSlots_{};
+  std::vector<Node> nodes_{};
+  std::unordered_set<uint64_t> seen_{};
+  std::vector<bool> executed_{};
+  std::vector<bool> ramValues_{};
+
+  auto Acquire() -> std::size_t;
+  void Release(std::size_t slot) { freeSlots_.push_back(slot); }
+  void RunAction(Machine8 &machine, Word keyMask);
+  auto Novel(const Machine8 &machine) -> bool;
+  auto Solved(const Machine8 &machine) const -> bool;
+  auto Path(uint32_t node) const -> std::vector<Word>;
+};
+
+#endif /* EMU8_EXPLORER_H */
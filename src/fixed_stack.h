@@ -0,0 +1,75 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_FIXED_STACK_H
+#define EMU8_FIXED_STACK_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+
+/*
+ * stack with fixed capacity and inline storage, used in place of std::stack
+ * so that call and return never touch the heap; exposes the same push, pop,
+ * and top interface as std::stack, plus direct access to the live entries
+ */
+template <typename T, std::size_t N> class FixedStack {
+public:
+  void push(const T &val) {
+    if (depth_ >= N) {
+      throw std::overflow_error("stack overflow");
+    }
+    entries_[depth_++] = val;
+  }
+
+  void pop() {
+    if (depth_ == 0) {
+      throw std::underflow_error("stack underflow");
+    }
+    depth_--;
+  }
+
+  [[nodiscard]] auto top() const -> const T & { return entries_[depth_ - 1]; }
+  [[nodiscard]] auto empty() const -> bool { return depth_ == 0; }
+  [[nodiscard]] auto size() const -> std::size_t { return depth_; }
+
+  void clear() { depth_ = 0; }
+
+  // replace the contents, bottom entry first
+  void assign(std::span<const T> entries) {
+    if (entries.size() > N) {
+      throw std::overflow_error("stack overflow");
+    }
+    std::copy(entries.begin(), entries.end(), entries_.begin());
+    depth_ = entries.size();
+  }
+
+  // entries from the bottom of the stack up to (but not including) size()
+  [[nodiscard]] auto data() const -> const T * { return entries_.data(); }
+
+private:
+  std::array<T, N> entries_ = {};
+  std::size_t depth_ = {0};
+};
+
+#endif /* EMU8_FIXED_STACK_H */
@@ -0,0 +1,66 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include "frame_buffer.h"
+
+void FrameBuffer8::Clear() {
+  pixels_.fill(0x0);
+  dirty_ = true;
+}
+
+auto FrameBuffer8::DrawSprite(std::span<const Byte> sprite, Byte posX,
+                              Byte posY) -> bool {
+  const std::size_t bitPosX = posX % fieldWidth;
+
+  // at most, a bit sequence not aligned with a byte boundary can overlap two
+  // neighboring bytes, so we build low and high bytes by shifting sprite input
+  const std::size_t rightShift = bitPosX % CHAR_BIT;
+  const std::size_t leftShift = CHAR_BIT - rightShift;
+
+  // colLowX is guaranteed not to wrap, but the high byte (colLowX + 1) could
+  const std::size_t colLowX = bitPosX / CHAR_BIT;
+  const std::size_t colHighX = (colLowX + 1) % rowBytes;
+
+  bool flipped = false;
+  std::size_t row = posY % fieldHeight;
+  for (const auto &curr : sprite) {
+    const auto lowByte = static_cast<Byte>(curr >> rightShift);
+    const auto highByte = static_cast<Byte>(curr << leftShift);
+
+    auto &lowPix = pixels_[(rowBytes * row) + colLowX];
+    auto &highPix = pixels_[(rowBytes * row) + colHighX];
+
+    // any bit set in both the sprite and the screen is switched off by XOR
+    if (((lowPix & lowByte) != 0) || ((highPix & highByte) != 0)) {
+      flipped = true;
+    }
+
+    lowPix ^= lowByte;
+    highPix ^= highByte;
+
+    row = (row + 1) % fieldHeight;
+  }
+
+  dirty_ = dirty_ || !sprite.empty();
+  return flipped;
+}
@@ -0,0 +1,68 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_FRAME_BUFFER_H
+#define EMU8_FRAME_BUFFER_H
+
+#include <array>
+#include <span>
+
+#include "common.h"
+
+/*
+ * the Chip-8 display, held as a bit-packed 64x32 monochrome image (one bit
+ * per pixel, most significant bit leftmost, 8 bytes per row); owned by the
+ * machine core so that drawing never depends on a window being present
+ */
+class FrameBuffer8 {
+public:
+  static constexpr int fieldWidth = 64;
+  static constexpr int fieldHeight = 32;
+  static constexpr std::size_t rowBytes = fieldWidth / CHAR_BIT;
+  static constexpr std::size_t bufferSize = rowBytes * fieldHeight;
+
+  using Buffer = std::array<Byte, bufferSize>;
+
+  // blank the display
+  void Clear();
+
+  // XOR an 8-pixel-wide sprite onto the display at (posX, posY), wrapping at
+  // the screen edges; returns true if any lit pixel was turned off
+  auto DrawSprite(std::span<const Byte> sprite, Byte posX, Byte posY) -> bool;
+
+  [[nodiscard]] auto Data() const -> std::span<const Byte> { return pixels_; }
+
+  // overwrite the whole display, e.g. when restoring a saved state
+  void Load(const Buffer &pixels) {
+    pixels_ = pixels;
+    dirty_ = true;
+  }
+
+  // set whenever the contents change, so frontends can skip redundant redraws
+  [[nodiscard]] auto Dirty() const -> bool { return dirty_; }
+  void ClearDirty() { dirty_ = false; }
+
+private:
+  Buffer pixels_ = {};
+  bool dirty_ = {true};
+};
+
+#endif /* EMU8_FRAME_BUFFER_H */
@@ -0,0 +1,63 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <bit>
+#include <cstring>
+
+#include "hash.h"
+
+namespace {
+
+constexpr uint64_t mixMult = 0x9E3779B97F4A7C15;
+constexpr uint64_t wordMult = 0xBF58476D1CE4E5B9;
+constexpr uint64_t finalMult = 0x94D049BB133111EB;
+constexpr int wordRotate = 29;
+constexpr unsigned finalShiftA = 30;
+constexpr unsigned finalShiftB = 27;
+constexpr unsigned finalShiftC = 31;
+
+auto MixWord(uint64_t hash, uint64_t word) -> uint64_t {
+  return std::rotl(hash ^ (word * wordMult), wordRotate) * mixMult;
+}
+
+} // namespace
+
+auto hash8::Fast64(std::span<const Byte> bytes, uint64_t seed) -> uint64_t {
+  uint64_t hash = seed ^ (bytes.size() * mixMult);
+
+  std::size_t pos = 0;
+  for (; pos + sizeof(uint64_t) <= bytes.size(); pos += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    std::memcpy(&word, bytes.data() + pos, sizeof(word));
+    hash = MixWord(hash, word);
+  }
+
+  if (pos < bytes.size()) {
+    uint64_t word = 0;
+    std::memcpy(&word, bytes.data() + pos, bytes.size() - pos);
+    hash = MixWord(hash, word);
+  }
+
+  // splitmix64 finalizer, so every input bit reaches every output bit
+  hash = (hash ^ (hash >> finalShiftA)) * wordMult;
+  hash = (hash ^ (hash >> finalShiftB)) * finalMult;
+  return hash ^ (hash >> finalShiftC);
+}
@@ -0,0 +1,53 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_HASH_H
+#define EMU8_HASH_H
+
+#include <span>
+
+#include "common.h"
+
+namespace hash8 {
+
+// 64-bit FNV-1a; fast and stable across platforms, which is all that is
+// needed to fingerprint ROM images and machine states (not cryptographic)
+constexpr auto Fnv1a(std::span<const Byte> bytes) -> uint64_t {
+  constexpr uint64_t offsetBasis = 0xCBF29CE484222325;
+  constexpr uint64_t prime = 0x100000001B3;
+
+  uint64_t hash = offsetBasis;
+  for (const auto byte : bytes) {
+    hash ^= byte;
+    hash *= prime;
+  }
+  return hash;
+}
+
+// word-at-a-time hash for hot paths such as deduplicating machine states,
+// several times faster than Fnv1a; pass a previous result as the seed to
+// hash several buffers as one; words are read in host byte order, so values
+// are only comparable within one platform
+auto Fast64(std::span<const Byte> bytes, uint64_t seed = 0) -> uint64_t;
+
+} // namespace hash8
+
+#endif /* EMU8_HASH_H */
@@ -45,14 +45,59 @@ static auto GetSingleRegNibble(Instruction opcode) -> Byte {
   return bits8::lowNibble(high);
 }
 
-InstructionSet8::InstructionSet8(RegisterSet8 &reg, Memory8 &mem,
-                                 Interface8 &interface)
-    : eng(rdev()), byteDist(BYTE_MIN, BYTE_MAX), regSet_{reg}, memory_{mem},
-      interface_{interface} {}
+const std::set<Byte> InstructionSet8::msnSet = {
+    0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x9, 0xA, 0xB, 0xC, 0xD};
+
+const std::set<Byte> InstructionSet8::lowByteSet = {0x0, 0xE, 0xF};
+
+const CodeMap InstructionSet8::codeMapping = {
+    {0x1, &InstructionSet8::Execute1nnn},
+    {0x2, &InstructionSet8::Execute2nnn},
+    {0x3, &InstructionSet8::Execute3xkk},
+    {0x4, &InstructionSet8::Execute4xkk},
+    {0x5, &InstructionSet8::Execute5xy0},
+    {0x6, &InstructionSet8::Execute6xkk},
+    {0x7, &InstructionSet8::Execute7xkk},
+    {0x9, &InstructionSet8::Execute9xy0},
+    {0xA, &InstructionSet8::ExecuteAnnn},
+    {0xB, &InstructionSet8::ExecuteBnnn},
+    {0xC, &InstructionSet8::ExecuteCxkk},
+    {0xD, &InstructionSet8::ExecuteDxyn},
+
+    {0x00E0, &InstructionSet8::Execute00E0},
+    {0x00EE, &InstructionSet8::Execute00EE},
+
+    {0x8000, &InstructionSet8::Execute8xy0},
+    {0x8001, &InstructionSet8::Execute8xy1},
+    {0x8002, &InstructionSet8::Execute8xy2},
+    {0x8003, &InstructionSet8::Execute8xy3},
+    {0x8004, &InstructionSet8::Execute8xy4},
+    {0x8005, &InstructionSet8::Execute8xy5},
+    {0x8006, &InstructionSet8::Execute8xy6},
+    {0x8007, &InstructionSet8::Execute8xy7},
+    {0x800E, &InstructionSet8::Execute8xyE},
+
+    {0xE09E, &InstructionSet8::ExecuteEx9E},
+    {0xE0A1, &InstructionSet8::ExecuteExA1},
+
+    {0xF007, &InstructionSet8::ExecuteFx07},
+    {0xF00A, &InstructionSet8::ExecuteFx0A},
+    {0xF015, &InstructionSet8::ExecuteFx15},
+    {0xF018, &InstructionSet8::ExecuteFx18},
+    {0xF01E, &InstructionSet8::ExecuteFx1E},
+    {0xF029, &InstructionSet8::ExecuteFx29},
+    {0xF033, &InstructionSet8::ExecuteFx33},
+    {0xF055, &InstructionSet8::ExecuteFx55},
+    {0xF065, &InstructionSet8::ExecuteFx65},
+};
 
-void InstructionSet8::DecodeExecuteInstruction(Instruction opcode) {
-  opcode_ = opcode;
+InstructionSet8::InstructionSet8(RegisterSet8 &reg, Memory8 &mem,
+                                 FrameBuffer8 &display, Keypad8 &keypad,
+                                 uint64_t seed)
+    : rng_(seed), regSet_{reg}, memory_{mem}, display_{display},
+      keypad_{keypad} {}
 
+auto InstructionSet8::Decode(Instruction opcode) -> InstructionFn {
   auto [high, low] = bits8::splitWord(opcode);
   const auto highNib = bits8::highNibble(high);
 
@@ -73,7 +118,6 @@ void InstructionSet8::DecodeExecuteInstruction(Instruction opcode) {
     }
   }
 
-  // decode
   InstructionFn currInstruction{nullptr};
   try {
     currInstruction = codeMapping.at(codeKey);
@@ -87,13 +131,17 @@ void InstructionSet8::DecodeExecuteInstruction(Instruction opcode) {
                                 std::to_string(opcode));
   }
 
-  // execute
-  std::invoke(currInstruction, this);
+  return currInstruction;
+}
+
+void InstructionSet8::DecodeExecuteInstruction(Instruction opcode) {
+  opcode_ = opcode;
+  std::invoke(Decode(opcode), this);
 }
 
 void InstructionSet8::Execute00E0() {
   // CLS - clear the display
-  interface_.ClearScreen();
+  display_.Clear();
 }
 
 void InstructionSet8::Execute00EE() {
@@ -292,43 +340,7 @@ void InstructionSet8::ExecuteCxkk() {
   auto [high, bytekk] = bits8::splitWord(opcode_);
   const auto regX = bits8::lowNibble(high);
 
-  regSet_.registers[regX] = byteDist(eng) & bytekk;
-}
-
-auto InstructionSet8::WrapSpriteToDisplay(const std::vector<Byte> &spriteVec,
-                                          Byte posX, Byte posY)
-    -> std::vector<Byte> {
-  std::vector<Byte> fullScreen(Interface8::textureSize, 0x0);
-
-  const std::size_t bitPosX = posX % Interface8::fieldWidth;
-
-  // at most, a bit sequence not aligned with a byte boundary can overlap two
-  // neighboring bytes, so we build low and high bytes by shifting sprite input
-  const std::size_t rightShift = bitPosX % CHAR_BIT;
-  const std::size_t leftShift = CHAR_BIT - rightShift;
-
-  const std::size_t stride = Interface8::fieldWidth / CHAR_BIT;
-
-  // bytePosX is guaranteed not to wrap, but the high byte (bytePosX + 1) could
-  const std::size_t colLowX = bitPosX / CHAR_BIT;
-  const std::size_t colHighX = (colLowX + 1) % stride;
-
-  for (const auto &curr : spriteVec) {
-    Byte lowByte = static_cast<Byte>(curr >> rightShift);
-    Byte highByte = static_cast<Byte>(curr << leftShift);
-
-    const std::size_t row = posY % Interface8::fieldHeight;
-
-    const std::size_t lowIndex = (stride * row) + colLowX;
-    const std::size_t highIndex = (stride * row) + colHighX;
-
-    fullScreen[lowIndex] = lowByte;
-    fullScreen[highIndex] = highByte;
-
-    posY++;
-  }
-
-  return fullScreen;
+  regSet_.registers[regX] = rng_.NextByte() & bytekk;
 }
 
 void InstructionSet8::ExecuteDxyn() {
@@ -336,9 +348,8 @@ void InstructionSet8::ExecuteDxyn() {
   // (Vx, Vy) on screen, set VF = collision
   auto [highByte, lowByte] = bits8::splitWord(opcode_);
 
-  std::vector<Byte> spriteVec;
   const Byte spriteLen = bits8::lowNibble(lowByte);
-  memory_.fetchSequence(regSet_.regI, spriteLen, spriteVec);
+  const auto sprite = memory_.viewSequence(regSet_.regI, spriteLen);
 
   const Byte regX = bits8::lowNibble(highByte);
   const Byte regY = bits8::highNibble(lowByte);
@@ -346,10 +357,8 @@ void InstructionSet8::ExecuteDxyn() {
   const Byte posX = regSet_.registers[regX];
   const Byte posY = regSet_.registers[regY];
 
-  auto screenContents = WrapSpriteToDisplay(spriteVec, posX, posY);
-
   regSet_.registers[RegisterSet8::flagReg] =
-      (interface_.UpdateScreen(screenContents)) ? 1 : 0;
+      (display_.DrawSprite(sprite, posX, posY)) ? 1 : 0;
 }
 
 void InstructionSet8::ExecuteEx9E() {
@@ -357,12 +366,12 @@ void InstructionSet8::ExecuteEx9E() {
   const auto reg = GetSingleRegNibble(opcode_);
   const auto val = regSet_.registers[reg];
 
-  if (val > Interface8::keyMax) {
+  if (val > Keypad8::keyMax) {
     const std::string msg = "Invalid key requested in instruction Ex9E: ";
     throw std::out_of_range(msg + std::to_string(val));
   }
 
-  if (interface_.KeyPressed(val)) {
+  if (keypad_.KeyPressed(val)) {
     regSet_.pc += 2;
   }
 }
@@ -372,12 +381,12 @@ void InstructionSet8::ExecuteExA1() {
   const auto reg = GetSingleRegNibble(opcode_);
   const auto val = regSet_.registers[reg];
 
-  if (val > Interface8::keyMax) {
+  if (val > Keypad8::keyMax) {
     const std::string msg = "Invalid key requested in instruction ExA1: ";
     throw std::out_of_range(msg + std::to_string(val));
   }
 
-  if (!interface_.KeyPressed(val)) {
+  if (!keypad_.KeyPressed(val)) {
     regSet_.pc += 2;
   }
 }
@@ -392,7 +401,15 @@ void InstructionSet8::ExecuteFx07() {
 void InstructionSet8::ExecuteFx0A() {
   // LD Vx, K - wait for a key press and store the value of the key in Vx
   const auto reg = GetSingleRegNibble(opcode_);
-  const auto val = interface_.GetKeyPress();
+
+  // rather than blocking, re-execute this instruction until a key comes in,
+  // so the timers keep running while we wait
+  Byte val = 0;
+  if (!keypad_.TakeKeyPress(val)) {
+    regSet_.pc -= 2;
+    return;
+  }
+
   regSet_.registers[reg] = val;
 }
 
@@ -406,7 +423,6 @@ void InstructionSet8::ExecuteFx18() {
   // LD ST, Vx - set sound timer = Vx
   const auto regX = GetSingleRegNibble(opcode_);
   regSet_.regST = regSet_.registers[regX];
-  regSet_.audioOn = (regSet_.regST > 0);
 }
 
 void InstructionSet8::ExecuteFx1E() {
@@ -437,16 +453,13 @@ void InstructionSet8::ExecuteFx33() {
   const auto valX = regSet_.registers[regX];
 
   const Word base = 10;
-  const Word bound = 1000;
-  Word divisor = 1;
-
-  Address addr = regSet_.regI + 2;
-  while (divisor < bound) {
-    Byte digit = static_cast<Byte>((valX / divisor) % base);
-    memory_.setByte(addr, digit);
+  const Word places = 3;
+  const auto digits = memory_.mutableSequence(regSet_.regI, places);
 
-    divisor *= base;
-    addr--;
+  auto remainder = valX;
+  for (auto iter = digits.rbegin(); iter != digits.rend(); iter++) {
+    *iter = static_cast<Byte>(remainder % base);
+    remainder = static_cast<Byte>(remainder / base);
   }
 }
 
@@ -455,18 +468,17 @@ void InstructionSet8::ExecuteFx55() {
   const auto regX = GetSingleRegNibble(opcode_);
 
   // add one to register value since transfer is inclusive, [0,X] vs. [0,X)
-  std::vector<Byte> regVals(regSet_.registers.begin(),
-                            regSet_.registers.begin() + regX + 1);
-
-  memory_.setSequence(regSet_.regI, static_cast<Word>(regVals.size()), regVals);
+  const Word count = regX + 1;
+  const auto dest = memory_.mutableSequence(regSet_.regI, count);
+  std::copy_n(regSet_.registers.begin(), count, dest.begin());
 }
 
 void InstructionSet8::ExecuteFx65() {
   // LD Vx, [I] - read registers V0 through Vx from memory starting at I
   const auto regX = GetSingleRegNibble(opcode_);
-  std::vector<Byte> regVals;
 
   // add one to register value since transfer is inclusive, [0,X] vs. [0,X)
-  memory_.fetchSequence(regSet_.regI, regX + 1, regVals);
-  std::copy(regVals.begin(), regVals.end(), regSet_.registers.begin());
+  const Word count = regX + 1;
+  const auto src = memory_.viewSequence(regSet_.regI, count);
+  std::copy(src.begin(), src.end(), regSet_.registers.begin());
 }
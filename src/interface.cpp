@@ -21,22 +21,36 @@
 
 #include <algorithm>
 #include <cassert>
-#include <cmath>
 #include <stdexcept>
 
 #include "interface.h"
+#include "tone.h"
 
 static void AudioCB(void *userdata, Uint8 *stream, int len) {
-  const auto twoPi = static_cast<float>(2 * std::acos(-1.0F));
-  const float amplitude = 0.1F;
-  const auto sampleFreq = static_cast<float>(Interface8::audioSampleFreq);
-  const auto toneFreq = static_cast<float>(Interface8::toneFreq);
-
-  static float phase = 0.0;
+  static Tone8 tone(static_cast<float>(Interface8::toneFreq),
+                    static_cast<float>(Interface8::audioSampleFreq));
 
   // we have to reinterpret here since SDL is stuck on C conventions
-  auto *regPtr = reinterpret_cast<RegisterSet8 *>(userdata); // NOLINT
-  if (!regPtr->audioOn) {
+  auto *audio = reinterpret_cast<Interface8::AudioShared *>(userdata); // NOLINT
+  const Timeline8::Scope scope(audio->timeline.load(),
+                               Timeline8::Track::audio, "audio callback");
+
+  // SDL asks for the next buffer as the last one starts playing, so a
+  // callback arriving more than a buffer late means the device ran dry
+  auto *metrics = audio->metrics.load();
+  if (metrics != nullptr) {
+    const auto now = std::chrono::steady_clock::now();
+    const auto samples = static_cast<std::size_t>(len) / sizeof(float);
+    const auto period = std::chrono::duration<double>(
+        static_cast<double>(samples) / Interface8::audioSampleFreq);
+    if (audio->lastCallback.time_since_epoch().count() != 0 &&
+        now - audio->lastCallback > 2 * period) {
+      MetricsSlot8::Add(metrics->audioUnderruns);
+    }
+    audio->lastCallback = now;
+  }
+
+  if (!audio->on.load()) {
     // can use len directly since it measures size of stream in bytes
     SDL_memset(stream, 0, static_cast<std::size_t>(len));
     return;
@@ -46,22 +60,14 @@ static void AudioCB(void *userdata, Uint8 *stream, int len) {
   auto *buf = reinterpret_cast<float *>(stream); // NOLINT
 
   // we assume only a single mono channel in the stream
-  const int max = len / static_cast<int>(sizeof(float) / sizeof(Uint8));
-
-  int idx = 0;
-  for (; idx < max; idx++) {
-    auto sinVal = std::sin(
-        twoPi * (toneFreq / sampleFreq) * static_cast<float>(idx) + phase);
-    buf[idx] = amplitude * static_cast<float>(sinVal); // NOLINT
-  }
-  phase = twoPi * (toneFreq / sampleFreq) * static_cast<float>(idx);
+  const auto max = static_cast<std::size_t>(len) / sizeof(float);
+  tone.Fill(std::span<float>(buf, max));
 }
 
-Interface8::Interface8(const std::string &title, RegisterSet8 &regSet,
-                       Address audioSize, int scaling)
+Interface8::Interface8(const std::string &title, Address audioSize,
+                       int scaling)
     : scaling_(scaling), screenWidth_(scaling_ * fieldWidth),
-      screenHeight_(scaling_ * fieldHeight), audioBufSize_(audioSize),
-      regSet_(regSet) {
+      screenHeight_(scaling_ * fieldHeight), audioBufSize_(audioSize) {
 
   if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
     errStream_ << "SDL initialization failed: ";
@@ -72,8 +78,7 @@ Interface8::Interface8(const std::string &title, RegisterSet8 &regSet,
   const std::string header = machineName + " - " + title;
   CreateWindow(header);
   CreateRenderer();
-  CreateSurface();
-  FillScancodeMap();
+  CreateTexture();
   InitAudio();
 }
 
@@ -120,31 +125,20 @@ void Interface8::CreateRenderer() {
   }
 }
 
-void Interface8::CreateSurface() {
-  surface_ = SDL_CreateRGBSurfaceWithFormat(0, fieldWidth, fieldHeight, 1,
-                                            SDL_PIXELFORMAT_INDEX1MSB);
+void Interface8::CreateTexture() {
+  // one streaming texture for the life of the window, so presenting a frame
+  // only uploads texels instead of creating and destroying a texture
+  screenTexture_ =
+      SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888,
+                        SDL_TEXTUREACCESS_STREAMING, fieldWidth, fieldHeight);
 
-  if (surface_ == nullptr) {
-    errStream_ << "SDL surface initialization error: ";
-    errStream_ << SDL_GetError();
-    throw std::runtime_error(errStream_.str());
-  }
-
-  if (SDL_SetPaletteColors(surface_->format->palette, colors_.data(), 0,
-                           static_cast<int>(colors_.size())) < 0) {
-    errStream_ << "SDL surface palette error: ";
+  if (screenTexture_ == nullptr) {
+    errStream_ << "SDL texture initialization error: ";
     errStream_ << SDL_GetError();
     throw std::runtime_error(errStream_.str());
   }
 }
 
-void Interface8::FillScancodeMap() {
-  scancodeMapping_.clear();
-  for (const auto &[keyVal, scanCode] : keyboardMapping_) {
-    scancodeMapping_.insert(std::pair{scanCode, keyVal});
-  }
-}
-
 void Interface8::InitAudio() {
   SDL_AudioSpec requested;
   SDL_memset(&requested, 0, sizeof(requested));
@@ -154,7 +148,7 @@ void Interface8::InitAudio() {
   requested.channels = 1;
   requested.samples = audioBufSize_;
   requested.callback = AudioCB;
-  requested.userdata = &regSet_;
+  requested.userdata = &audio_;
 
   audioID_ = SDL_OpenAudioDevice(nullptr, 0, &requested, &audioSpec_, 0);
   if (audioID_ == 0) {
@@ -172,8 +166,6 @@ Interface8::~Interface8() {
     SDL_DestroyTexture(screenTexture_);
   }
 
-  SDL_FreeSurface(surface_);
-
   if (renderer_ != nullptr) {
     SDL_DestroyRenderer(renderer_);
   }
@@ -186,16 +178,26 @@ Interface8::~Interface8() {
   SDL_Quit();
 }
 
-void Interface8::RenderSurface() {
-  if (SDL_RenderClear(renderer_) < 0) {
-    errStream_ << "Error clearing renderer: ";
-    errStream_ << SDL_GetError();
-    throw std::runtime_error(errStream_.str());
+void Interface8::Present(std::span<const Byte> screen) {
+  {
+    const Timeline8::Scope scope(timeline_, Timeline8::Track::emulation,
+                                 "update texture");
+    ExpandTexels(screen, texels_);
+
+    const int pitch = fieldWidth * static_cast<int>(sizeof(Uint32));
+    if (SDL_UpdateTexture(screenTexture_, nullptr, texels_.data(), pitch) <
+        0) {
+      errStream_ << "Error updating screen texture: ";
+      errStream_ << SDL_GetError();
+      throw std::runtime_error(errStream_.str());
+    }
   }
 
-  screenTexture_ = SDL_CreateTextureFromSurface(renderer_, surface_);
-  if (screenTexture_ == nullptr) {
-    errStream_ << "Could not create screen texture: ";
+  const Timeline8::Scope scope(timeline_, Timeline8::Track::emulation,
+                               "present");
+
+  if (SDL_RenderClear(renderer_) < 0) {
+    errStream_ << "Error clearing renderer: ";
     errStream_ << SDL_GetError();
     throw std::runtime_error(errStream_.str());
   }
@@ -207,73 +209,45 @@ void Interface8::RenderSurface() {
   }
 
   SDL_RenderPresent(renderer_);
-  SDL_DestroyTexture(screenTexture_);
-}
 
-void Interface8::ClearScreen() {
-  std::vector<Byte> bitVec(textureSize, 0);
-  Byte *pix = static_cast<Byte *>(surface_->pixels);
-  std::copy(bitVec.begin(), bitVec.end(), pix);
-
-  RenderSurface();
+  if (metrics_ != nullptr) {
+    MetricsSlot8::Add(metrics_->framesPresented);
+  }
 }
 
-auto Interface8::UpdateScreen(const std::vector<Byte> &newScreen) -> bool {
-  assert(newScreen.size() == textureSize);
-
-  std::vector<Byte> currScreen;
-  Byte *pix = static_cast<Byte *>(surface_->pixels);
-  std::copy_n(pix, textureSize, std::back_inserter(currScreen));
+void Interface8::ExpandTexels(std::span<const Byte> screen,
+                              std::span<Uint32, pixelCount> texels) {
+  assert(screen.size() == FrameBuffer8::bufferSize);
 
-  bool flipped = false;
-  std::vector<Byte> finalScreen(textureSize, 0);
-  for (std::size_t index = 0; index < newScreen.size(); index++) {
-    finalScreen[index] = currScreen[index] ^ newScreen[index];
-
-    // bitwise check that we haven't flipped off pixels, look at truth table
-    // for XOR plus AND to confirm this is correct
-    if ((currScreen[index] & finalScreen[index]) != currScreen[index]) {
-      flipped = true;
+  // expand one bit per pixel (msb leftmost) into one texel per pixel
+  auto texel = texels.begin();
+  for (const auto &bits : screen) {
+    for (int bit = CHAR_BIT - 1; bit >= 0; bit--) {
+      *texel = (((bits >> bit) & 0x1) != 0) ? colorOn : colorOff;
+      texel++;
     }
   }
-
-  std::copy(finalScreen.begin(), finalScreen.end(), pix);
-  RenderSurface();
-
-  return flipped;
 }
 
-auto Interface8::KeyPressed(Byte keyVal) -> bool {
-  auto scanCode = keyboardMapping_.at(keyVal);
-
+auto Interface8::ScancodeHeld(SDL_Scancode scanCode) -> bool {
   int size = 0;
   const auto *keyArray = SDL_GetKeyboardState(&size);
-  assert(scanCode < size);
 
+  assert(scanCode < size);
   return (keyArray[scanCode] == 1); // NOLINT
 }
 
-// helper function to clarify keypress logic
-auto Interface8::ValidKeyPress(const SDL_Event &event) -> bool {
-  // must be key press event
-  if (event.type != SDL_KEYDOWN) {
-    return false;
-  }
-
-  // key scan code must represent a known Chip-8 key
-  return (scancodeMapping_.count(event.key.keysym.scancode) == 1);
-}
+auto Interface8::PollKeys() const -> Word {
+  int size = 0;
+  const auto *keyArray = SDL_GetKeyboardState(&size);
 
-auto Interface8::GetKeyPress() -> Byte {
-  SDL_Event event;
-  do {
-    if (SDL_WaitEvent(&event) == 0) {
-      const std::string msg = "Error waiting for SDL key press event: ";
-      throw std::runtime_error(msg + SDL_GetError());
+  Word mask = 0x0;
+  for (const auto &[keyVal, scanCode] : keyboardMapping_) {
+    assert(scanCode < size);
+    if (keyArray[scanCode] == 1) { // NOLINT
+      mask |= static_cast<Word>(1U << keyVal);
     }
   }
-  while (!ValidKeyPress(event))
-    ;
 
-  return scancodeMapping_.at(event.key.keysym.scancode);
+  return mask;
 }
@@ -25,30 +25,30 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_scancode.h>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <map>
+#include <span>
 #include <sstream>
 #include <string>
-#include <vector>
 
 #include "common.h"
-#include "register_set.h"
+#include "frame_buffer.h"
+#include "metrics.h"
+#include "timeline.h"
 
 class Interface8 {
 public:
   // video settings
-  static constexpr int fieldWidth = 64;
-  static constexpr int fieldHeight = 32;
+  static constexpr int fieldWidth = FrameBuffer8::fieldWidth;
+  static constexpr int fieldHeight = FrameBuffer8::fieldHeight;
   static constexpr int defaultScaling = 10;
-  static constexpr std::size_t textureSize =
-      fieldWidth * fieldHeight / CHAR_BIT;
+  static constexpr std::size_t pixelCount = fieldWidth * fieldHeight;
 
   static constexpr int audioSampleFreq = 44100;
   static constexpr int defaultAudioBufSize = 4096;
   static constexpr int toneFreq = 440;
 
-  // keyboard settings
-  static constexpr Byte keyMax = 0xF;
-
   enum LogicalKeys : Byte {
     CHIP8_KEY_0 = 0x0,
     CHIP8_KEY_1,
@@ -68,7 +68,7 @@ public:
     CHIP8_KEY_F
   };
 
-  explicit Interface8(const std::string &title, RegisterSet8 &regSet,
+  explicit Interface8(const std::string &title,
                       Address audioSize = defaultAudioBufSize,
                       int scaling = defaultScaling);
   ~Interface8();
@@ -79,19 +79,54 @@ public:
   auto operator=(const Interface8 &other) -> Interface8 & = delete;
   auto operator=(Interface8 &&other) -> Interface8 & = delete;
 
-  void ClearScreen();
-  auto UpdateScreen(const std::vector<Byte> &newScreen) -> bool;
-  auto KeyPressed(Byte keyVal) -> bool;
-  auto GetKeyPress() -> Byte;
+  // draw a bit-packed display image (see FrameBuffer8) to the window
+  void Present(std::span<const Byte> screen);
+
+  // expand a bit-packed display image into ARGB8888 texels, one per pixel
+  static void ExpandTexels(std::span<const Byte> screen,
+                           std::span<Uint32, pixelCount> texels);
+
+  // sample the keyboard, returning the held Chip-8 keys as a bit mask
+  [[nodiscard]] auto PollKeys() const -> Word;
+
+  // whether a host key is currently held, for hotkeys acting while held
+  [[nodiscard]] static auto ScancodeHeld(SDL_Scancode scanCode) -> bool;
+
+  // switch the tone on or off; read by the audio callback thread
+  void SetAudio(bool audioOn) { audio_.on = audioOn; }
+
+  // record presenting and audio callbacks into timeline, or stop with
+  // nullptr; the timeline must outlive the interface's use of it
+  void SetTimeline(Timeline8 *timeline) {
+    timeline_ = timeline;
+    audio_.timeline = timeline;
+  }
+
+  // count presented frames and late audio callbacks into metrics, or stop
+  // with nullptr; the slot must outlive the interface's use of it
+  void SetMetrics(MetricsSlot8 *metrics) {
+    metrics_ = metrics;
+    audio_.metrics = metrics;
+  }
+
+  // state shared with the audio callback thread
+  struct AudioShared {
+    std::atomic<bool> on{false};
+    std::atomic<Timeline8 *> timeline{nullptr};
+    std::atomic<MetricsSlot8 *> metrics{nullptr};
+
+    // only touched by the callback
+    std::chrono::steady_clock::time_point lastCallback{};
+  };
+
   auto SetKeyMapping(std::map<Byte, SDL_Scancode> &&mapping) {
     keyboardMapping_ = mapping;
   }
 
 private:
-  // set black and white color palette
-  const std::array<SDL_Color, 2> colors_ = {
-      SDL_Color{0, 0, 0, BYTE_MAX},
-      SDL_Color{BYTE_MAX, BYTE_MAX, BYTE_MAX, BYTE_MAX}};
+  // set black and white color palette, as ARGB8888 texels
+  static constexpr Uint32 colorOff = 0xFF000000;
+  static constexpr Uint32 colorOn = 0xFFFFFFFF;
 
   // default keyboard mapping, editable via config file
   std::map<Byte, SDL_Scancode> keyboardMapping_ = {
@@ -121,33 +156,30 @@ private:
 
   const std::string machineName = "emu8";
 
-  // holds inverse of keyboardMapping
-  std::map<SDL_Scancode, Byte> scancodeMapping_ = {};
-
   SDL_Window *window_ = {nullptr};
-  SDL_Surface *surface_ = {nullptr};
   SDL_Renderer *renderer_ = {nullptr};
   SDL_Texture *screenTexture_ = {nullptr};
 
+  // expanded texels for the streaming texture, reused on every present
+  std::array<Uint32, pixelCount> texels_ = {};
+
   std::stringstream errStream_ = {};
 
   SDL_AudioSpec audioSpec_ = {};
   SDL_AudioDeviceID audioID_ = {};
+  AudioShared audio_ = {};
+  Timeline8 *timeline_ = {nullptr};
+  MetricsSlot8 *metrics_ = {nullptr};
 
   int scaling_;
   int screenWidth_;
   int screenHeight_;
   Address audioBufSize_;
 
-  RegisterSet8 &regSet_;
-
   void CreateWindow(const std::string &title);
   void CreateRenderer();
-  void CreateSurface();
-  void FillScancodeMap();
+  void CreateTexture();
   void InitAudio();
-  auto ValidKeyPress(const SDL_Event &event) -> bool;
-  void RenderSurface();
 };
 
 #endif /* EMU8_INTERFACE_H */
@@ -0,0 +1,78 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_KEYPAD_H
+#define EMU8_KEYPAD_H
+
+#include "common.h"
+
+/*
+ * state of the 16-key hexadecimal keypad, sampled once per tick as a bit
+ * mask (bit n set means key n is held); newly pressed keys are latched so
+ * that Fx0A can wait for a press without blocking the emulation thread
+ */
+class Keypad8 {
+public:
+  static constexpr Byte keyCount = 16;
+  static constexpr Byte keyMax = 0xF;
+
+  // replace the held-key mask, latching any keys that were not held before
+  void SetState(Word mask) {
+    pressed_ = mask & static_cast<Word>(~held_);
+    held_ = mask;
+  }
+
+  [[nodiscard]] auto GetState() const -> Word { return held_; }
+
+  // keys latched by SetState() but not yet consumed by TakeKeyPress()
+  [[nodiscard]] auto GetLatched() const -> Word { return pressed_; }
+
+  // restore both masks exactly, e.g. when loading a saved state
+  void Restore(Word held, Word pressed) {
+    held_ = held;
+    pressed_ = pressed;
+  }
+
+  [[nodiscard]] auto KeyPressed(Byte keyVal) const -> bool {
+    return ((held_ >> keyVal) & 0x1) != 0;
+  }
+
+  // consume the lowest newly pressed key, returning false if there is none
+  auto TakeKeyPress(Byte &keyVal) -> bool {
+    if (pressed_ == 0) {
+      return false;
+    }
+
+    keyVal = 0;
+    while (((pressed_ >> keyVal) & 0x1) == 0) {
+      keyVal++;
+    }
+
+    pressed_ &= static_cast<Word>(~(1U << keyVal));
+    return true;
+  }
+
+private:
+  Word held_ = {0x0};
+  Word pressed_ = {0x0};
+};
+
+#endif /* EMU8_KEYPAD_H */
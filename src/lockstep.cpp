@@ -0,0 +1,625 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+#include "bits.h"
+#include "keypad.h"
+#include "lockstep.h"
+#include "random.h"
+
+// compile the array kernels for several instruction sets and pick the best
+// one the CPU supports at load time
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define EMU8_SIMD_CLONES                                                       \
+  __attribute__((target_clones("avx2", "sse4.2", "default")))
+#define EMU8_INLINE __attribute__((always_inline))
+#else
+#define EMU8_SIMD_CLONES
+#define EMU8_INLINE
+#endif
+
+namespace {
+
+// lanes [first, last) are scanned; stride is the length of each register row
+struct KernelArgs {
+  std::size_t first;
+  std::size_t last;
+  std::size_t stride;
+  Byte *registers;
+  Address *regI;
+  Address *pc;
+  Byte *regDT;
+  Byte *regST;
+  uint64_t *rngState;
+  uint64_t *instrTotal;
+  const Byte *mask;
+};
+
+// register-only instructions over every lane selected by mask, written as
+// branch-free loops so they vectorize; returns false for any other opcode
+EMU8_SIMD_CLONES auto RunKernel(const KernelArgs &args, Instruction opcode)
+    -> bool {
+  const auto first = args.first;
+  const auto last = args.last;
+  const auto stride = args.stride;
+  const auto *mask = args.mask;
+  auto *pc = args.pc;
+  auto *regI = args.regI;
+
+  auto [high, kk] = bits8::splitWord(opcode);
+  const auto nibX = bits8::lowNibble(high);
+  const auto nibY = bits8::highNibble(kk);
+  const auto nnn = bits8::maskAddress(opcode);
+
+  auto *valX = args.registers + (nibX * stride);
+  auto *valY = args.registers + (nibY * stride);
+  auto *val0 = args.registers;
+  auto *flag = args.registers + (RegisterSet8::flagReg * stride);
+
+  // the helpers must be inlined to be compiled for each target clone
+  auto skipIf = [&](auto cond) EMU8_INLINE {
+    for (std::size_t lane = first; lane < last; lane++) {
+      const auto skip = (mask[lane] != 0) && cond(lane);
+      pc[lane] = static_cast<Address>(pc[lane] + (skip ? 2 : 0));
+    }
+  };
+
+  // each lane reads both operands before writing Vx, then VF, as the scalar
+  // instructions do, so x or y being F behaves identically
+  auto arith = [&](auto result, auto carry) EMU8_INLINE {
+    for (std::size_t lane = first; lane < last; lane++) {
+      const auto regX = valX[lane];
+      const auto regY = valY[lane];
+      const auto sel = mask[lane] != 0;
+      valX[lane] = sel ? result(regX, regY) : regX;
+      flag[lane] = sel ? carry(regX, regY) : flag[lane];
+    }
+  };
+
+  auto apply = [&](Byte *reg, auto result) EMU8_INLINE {
+    for (std::size_t lane = first; lane < last; lane++) {
+      reg[lane] = (mask[lane] != 0) ? result(lane) : reg[lane];
+    }
+  };
+
+  switch (bits8::highNibble(high)) {
+  case 0x1:
+    for (std::size_t lane = first; lane < last; lane++) {
+      pc[lane] = (mask[lane] != 0) ? nnn : pc[lane];
+    }
+    break;
+  case 0x3:
+    skipIf([&](std::size_t lane) { return valX[lane] == kk; });
+    break;
+  case 0x4:
+    skipIf([&](std::size_t lane) { return valX[lane] != kk; });
+    break;
+  case 0x5:
+    skipIf([&](std::size_t lane) { return valX[lane] == valY[lane]; });
+    break;
+  case 0x6:
+    apply(valX, [&](std::size_t /*lane*/) { return kk; });
+    break;
+  case 0x7:
+    apply(valX, [&](std::size_t lane) {
+      return static_cast<Byte>(valX[lane] + kk);
+    });
+    break;
+  case 0x8:
+    switch (bits8::lowNibble(kk)) {
+    case 0x0:
+      apply(valX, [&](std::size_t lane) { return valY[lane]; });
+      break;
+    case 0x1:
+      apply(valX, [&](std::size_t lane) {
+        return static_cast<Byte>(valX[lane] | valY[lane]);
+      });
+      break;
+    case 0x2:
+      apply(valX, [&](std::size_t lane) {
+        return static_cast<Byte>(valX[lane] & valY[lane]);
+      });
+      break;
+    case 0x3:
+      apply(valX, [&](std::size_t lane) {
+        return static_cast<Byte>(valX[lane] ^ valY[lane]);
+      });
+      break;
+    case 0x4:
+      arith([](Byte regX, Byte regY) { return static_cast<Byte>(regX + regY); },
+            [](Byte regX, Byte regY) {
+              return static_cast<Byte>((regX + regY) >> CHAR_BIT);
+            });
+      break;
+    case 0x5:
+      arith([](Byte regX, Byte regY) { return static_cast<Byte>(regX - regY); },
+            [](Byte regX, Byte regY) { return Byte{regX > regY}; });
+      break;
+    case 0x6:
+      arith([](Byte regX, Byte /*regY*/) { return Byte(regX >> 1); },
+            [](Byte regX, Byte /*regY*/) { return bits8::getLsb(regX); });
+      break;
+    case 0x7:
+      arith([](Byte regX, Byte regY) { return static_cast<Byte>(regY - regX); },
+            [](Byte regX, Byte regY) { return Byte{regY > regX}; });
+      break;
+    case 0xE:
+      arith([](Byte regX, Byte /*regY*/) { return Byte(regX << 1); },
+            [](Byte regX, Byte /*regY*/) { return bits8::getMsb(regX); });
+      break;
+    default:
+      return false;
+    }
+    break;
+  case 0x9:
+    skipIf([&](std::size_t lane) { return valX[lane] != valY[lane]; });
+    break;
+  case 0xA:
+    for (std::size_t lane = first; lane < last; lane++) {
+      regI[lane] = (mask[lane] != 0) ? nnn : regI[lane];
+    }
+    break;
+  case 0xB:
+    for (std::size_t lane = first; lane < last; lane++) {
+      const auto dest = static_cast<Address>(nnn + val0[lane]);
+      pc[lane] = (mask[lane] != 0) ? dest : pc[lane];
+    }
+    break;
+  case 0xC:
+    for (std::size_t lane = first; lane < last; lane++) {
+      auto state = args.rngState[lane];
+      const auto rand = Random8::Advance(state);
+      const auto sel = mask[lane] != 0;
+      args.rngState[lane] = sel ? state : args.rngState[lane];
+      valX[lane] = sel ? static_cast<Byte>(rand & kk) : valX[lane];
+    }
+    break;
+  case 0xF:
+    switch (kk) {
+    case 0x07:
+      apply(valX, [&](std::size_t lane) { return args.regDT[lane]; });
+      break;
+    case 0x15:
+      apply(args.regDT, [&](std::size_t lane) { return valX[lane]; });
+      break;
+    case 0x18:
+      apply(args.regST, [&](std::size_t lane) { return valX[lane]; });
+      break;
+    case 0x1E:
+      for (std::size_t lane = first; lane < last; lane++) {
+        const auto sum = static_cast<Address>(regI[lane] + valX[lane]);
+        regI[lane] = (mask[lane] != 0) ? sum : regI[lane];
+      }
+      break;
+    default:
+      return false;
+    }
+    break;
+  default:
+    return false;
+  }
+
+  for (std::size_t lane = first; lane < last; lane++) {
+    args.instrTotal[lane] += mask[lane];
+  }
+  return true;
+}
+
+[[noreturn]] void ReportBadOpcode(Instruction opcode) {
+  throw std::invalid_argument("unrecognized opcode: " +
+                              std::to_string(opcode));
+}
+
+} // namespace
+
+Lockstep8::Lockstep8(std::size_t lanes, std::size_t memBase, std::size_t ipt)
+    : lanes_(std::max<std::size_t>(lanes, 1)), instrPerTick_(ipt),
+      registers_(RegisterSet8::regCount * lanes_), regI_(lanes_),
+      pc_(lanes_, static_cast<Address>(memBase)), regDT_(lanes_),
+      regST_(lanes_), keysHeld_(lanes_), keysPressed_(lanes_),
+      rngState_(lanes_, Random8().GetState()), instrTotal_(lanes_),
+      frameTotal_(lanes_), running_(lanes_, 1),
+      memories_(lanes_, Memory8(memBase)), displays_(lanes_),
+      stacks_(lanes_), faults_(lanes_), opcodes_(lanes_), order_(lanes_),
+      grouped_(lanes_), bucket_(lanes_), mask_(lanes_) {}
+
+void Lockstep8::LoadProgram(std::span<const Byte> image) {
+  for (std::size_t lane = 0; lane < lanes_; lane++) {
+    memories_[lane].loadProgram(image);
+  }
+  std::fill(pc_.begin(), pc_.end(), pc_.front());
+}
+
+void Lockstep8::Seed(std::size_t lane, uint64_t seed) {
+  rngState_.at(lane) = Random8(seed).GetState();
+}
+
+void Lockstep8::StopLane(std::size_t lane, const std::string &fault) {
+  running_[lane] = 0;
+  faults_[lane] = fault;
+}
+
+void Lockstep8::Step() {
+  stats_.steps++;
+
+  std::size_t running = 0;
+  for (std::size_t lane = 0; lane < lanes_; lane++) {
+    if (running_[lane] == 0) {
+      continue;
+    }
+
+    if (pc_[lane] >= Memory8::memSize - 1) {
+      StopLane(lane, "Invalid memory access: " + std::to_string(pc_[lane]));
+      continue;
+    }
+
+    opcodes_[lane] = memories_[lane].fetchInstructionUnchecked(pc_[lane]);
+    order_[running] = static_cast<uint32_t>(lane);
+    running++;
+  }
+
+  const auto members = std::span<uint32_t>{order_}.first(running);
+  if (members.empty()) {
+    return;
+  }
+
+  auto sameGroup = [&](uint32_t lhs, uint32_t rhs) {
+    return pc_[lhs] == pc_[rhs] && opcodes_[lhs] == opcodes_[rhs];
+  };
+
+  // the common case: every lane is on the same instruction
+  const auto lead = members.front();
+  if (std::all_of(members.begin(), members.end(),
+                  [&](uint32_t lane) { return sameGroup(lane, lead); })) {
+    stats_.convergedSteps++;
+    RunGroup(members);
+    return;
+  }
+
+  // a handful of groups (a branch splitting the lanes, say) are bucketed in
+  // one pass; lanes scattered over more instructions than that are out of
+  // phase, and gain nothing from grouping, so they run one by one
+  if (!BucketGroups(members)) {
+    for (const auto &lane : members) {
+      RunGroup({&lane, 1});
+    }
+  }
+}
+
+auto Lockstep8::BucketGroups(std::span<const uint32_t> members) -> bool {
+  std::array<uint32_t, maxBuckets> keys = {};
+  std::array<std::size_t, maxBuckets + 1> starts = {};
+  std::size_t buckets = 0;
+
+  for (const auto lane : members) {
+    const auto key = (uint32_t{pc_[lane]} << 16U) | opcodes_[lane];
+    std::size_t bucket = 0;
+    while (bucket < buckets && keys[bucket] != key) {
+      bucket++;
+    }
+
+    if (bucket == buckets) {
+      if (buckets == maxBuckets) {
+        return false;
+      }
+      keys[buckets] = key;
+      buckets++;
+    }
+
+    bucket_[lane] = static_cast<Byte>(bucket);
+    starts[bucket + 1]++;
+  }
+
+  for (std::size_t bucket = 0; bucket < buckets; bucket++) {
+    starts[bucket + 1] += starts[bucket];
+  }
+
+  // scatter into grouped_, which keeps lane order within each bucket
+  auto fill = starts;
+  for (const auto lane : members) {
+    grouped_[fill[bucket_[lane]]++] = lane;
+  }
+
+  const auto grouped = std::span<const uint32_t>{grouped_};
+  for (std::size_t bucket = 0; bucket < buckets; bucket++) {
+    RunGroup(grouped.subspan(starts[bucket],
+                             starts[bucket + 1] - starts[bucket]));
+  }
+  return true;
+}
+
+void Lockstep8::RunGroup(std::span<const uint32_t> group) {
+  // group lists lanes in increasing order, all on the same instruction
+  const auto opcode = opcodes_[group.front()];
+  const std::size_t first = group.front();
+  const std::size_t last = group.back() + 1U;
+
+  for (const auto lane : group) {
+    mask_[lane] = 1;
+    pc_[lane] = static_cast<Address>(pc_[lane] + 2);
+  }
+
+  KernelArgs args = {first,
+                     last,
+                     lanes_,
+                     registers_.data(),
+                     regI_.data(),
+                     pc_.data(),
+                     regDT_.data(),
+                     regST_.data(),
+                     rngState_.data(),
+                     instrTotal_.data(),
+                     mask_.data()};
+
+  // small or scattered groups are cheaper lane by lane than masked loops
+  // over the lanes in between
+  const bool dense = group.size() * densityRatio >= last - first;
+  if (group.size() >= minVectorLanes && dense && RunKernel(args, opcode)) {
+    stats_.vectorGroups++;
+  } else {
+    stats_.scalarGroups++;
+    for (const auto lane : group) {
+      args.first = lane;
+      args.last = lane + 1U;
+      if (RunKernel(args, opcode)) {
+        continue;
+      }
+
+      try {
+        ExecuteLane(lane, opcode);
+        instrTotal_[lane]++;
+      } catch (const std::exception &err) {
+        StopLane(lane, err.what());
+      }
+    }
+  }
+
+  for (const auto lane : group) {
+    mask_[lane] = 0;
+  }
+}
+
+void Lockstep8::ExecuteLane(std::size_t lane, Instruction opcode) {
+  // only what the kernel leaves over: system, stack, memory, display and
+  // keypad instructions, plus undefined opcodes
+  auto [high, kk] = bits8::splitWord(opcode);
+  switch (bits8::highNibble(high)) {
+  case 0x0:
+    ExecuteLaneSystem(lane, opcode);
+    break;
+  case 0x2:
+    stacks_[lane].push(pc_[lane]);
+    pc_[lane] = bits8::maskAddress(opcode);
+    break;
+  case 0xD: {
+    auto &memory = memories_[lane];
+    const auto sprite =
+        memory.viewSequence(regI_[lane], bits8::lowNibble(kk));
+    const auto posX = Reg(bits8::lowNibble(high))[lane];
+    const auto posY = Reg(bits8::highNibble(kk))[lane];
+    Reg(RegisterSet8::flagReg)[lane] =
+        displays_[lane].DrawSprite(sprite, posX, posY) ? 1 : 0;
+    break;
+  }
+  case 0xE: {
+    const auto key = Reg(bits8::lowNibble(high))[lane];
+    if (kk != 0x9E && kk != 0xA1) {
+      ReportBadOpcode(opcode);
+    }
+    if (key > Keypad8::keyMax) {
+      throw std::out_of_range("Invalid key requested: " + std::to_string(key));
+    }
+
+    const bool pressed = ((keysHeld_[lane] >> key) & 0x1) != 0;
+    if (pressed == (kk == 0x9E)) {
+      pc_[lane] = static_cast<Address>(pc_[lane] + 2);
+    }
+    break;
+  }
+  case 0xF:
+    ExecuteLaneMisc(lane, opcode);
+    break;
+  default:
+    ReportBadOpcode(opcode);
+  }
+}
+
+void Lockstep8::ExecuteLaneSystem(std::size_t lane, Instruction opcode) {
+  // like InstructionSet8, only the low byte selects among the 0nnn forms
+  switch (bits8::splitWord(opcode).second) {
+  case 0xE0:
+    displays_[lane].Clear();
+    break;
+  case 0xEE: {
+    auto &stack = stacks_[lane];
+    if (stack.empty()) {
+      throw std::underflow_error("stack underflow");
+    }
+    pc_[lane] = stack.top();
+    stack.pop();
+    break;
+  }
+  default:
+    ReportBadOpcode(opcode);
+  }
+}
+
+void Lockstep8::ExecuteLaneMisc(std::size_t lane, Instruction opcode) {
+  auto [high, kk] = bits8::splitWord(opcode);
+  const auto regX = bits8::lowNibble(high);
+  auto &valX = Reg(regX)[lane];
+  auto &memory = memories_[lane];
+  constexpr Byte maxNibble = 0xF;
+
+  switch (kk) {
+  case 0x0A: {
+    // as Keypad8::TakeKeyPress(): consume the lowest latched key, or stay
+    // on this instruction
+    auto &pressed = keysPressed_[lane];
+    if (pressed == 0) {
+      pc_[lane] = static_cast<Address>(pc_[lane] - 2);
+      break;
+    }
+
+    Byte key = 0;
+    while (((pressed >> key) & 0x1) == 0) {
+      key++;
+    }
+    pressed = static_cast<Word>(pressed & ~(1U << key));
+    valX = key;
+    break;
+  }
+  case 0x29:
+    if (valX > maxNibble) {
+      throw std::out_of_range("Invalid sprite address request for value = " +
+                              std::to_string(valX));
+    }
+    regI_[lane] = static_cast<Address>(Memory8::spriteBegin +
+                                       (Memory8::spriteLen * valX));
+    break;
+  case 0x33: {
+    constexpr Byte base = 10;
+    const auto digits = memory.mutableSequence(regI_[lane], 3);
+    auto remainder = valX;
+    for (auto iter = digits.rbegin(); iter != digits.rend(); iter++) {
+      *iter = static_cast<Byte>(remainder % base);
+      remainder = static_cast<Byte>(remainder / base);
+    }
+    break;
+  }
+  case 0x55: {
+    const auto dest = memory.mutableSequence(regI_[lane], regX + 1);
+    for (std::size_t reg = 0; reg <= regX; reg++) {
+      dest[reg] = Reg(reg)[lane];
+    }
+    break;
+  }
+  case 0x65: {
+    const auto src = memory.viewSequence(regI_[lane], regX + 1);
+    for (std::size_t reg = 0; reg <= regX; reg++) {
+      Reg(reg)[lane] = src[reg];
+    }
+    break;
+  }
+  default:
+    ReportBadOpcode(opcode);
+  }
+}
+
+void Lockstep8::TickTimers() {
+  for (std::size_t lane = 0; lane < lanes_; lane++) {
+    // lanes stopped by a fault keep their timers as they were
+    const auto tick = running_[lane];
+    const auto stepST = (regST_[lane] > 0) ? tick : 0;
+    const auto stepDT = (regDT_[lane] > 0) ? tick : 0;
+    regST_[lane] = static_cast<Byte>(regST_[lane] - stepST);
+    regDT_[lane] = static_cast<Byte>(regDT_[lane] - stepDT);
+    frameTotal_[lane] += tick;
+  }
+}
+
+void Lockstep8::SetKeys(std::size_t lane, Word keyMask) {
+  // as Keypad8::SetState()
+  keysPressed_[lane] = static_cast<Word>(keyMask & ~keysHeld_[lane]);
+  keysHeld_[lane] = keyMask;
+}
+
+void Lockstep8::RunTick() {
+  for (std::size_t count = 0; count < instrPerTick_; count++) {
+    Step();
+  }
+  TickTimers();
+}
+
+void Lockstep8::RunFrame(Word keyMask) {
+  for (std::size_t lane = 0; lane < lanes_; lane++) {
+    SetKeys(lane, keyMask);
+  }
+  RunTick();
+}
+
+void Lockstep8::RunFrame(std::span<const Word> keyMasks) {
+  if (keyMasks.size() != lanes_) {
+    throw std::invalid_argument("Expected one key mask per lane");
+  }
+
+  for (std::size_t lane = 0; lane < lanes_; lane++) {
+    SetKeys(lane, keyMasks[lane]);
+  }
+  RunTick();
+}
+
+void Lockstep8::SaveLane(std::size_t lane, MachineState8 &state) const {
+  const auto ram = memories_.at(lane).viewSequence(0, Memory8::memSize);
+  std::copy(ram.begin(), ram.end(), state.memory.begin());
+
+  for (std::size_t reg = 0; reg < RegisterSet8::regCount; reg++) {
+    state.registers[reg] = Reg(reg)[lane];
+  }
+
+  const auto &stack = stacks_[lane];
+  std::copy_n(stack.data(), stack.size(), state.callStack.begin());
+  state.stackDepth = static_cast<Byte>(stack.size());
+  state.regDT = regDT_[lane];
+  state.regST = regST_[lane];
+  state.regI = regI_[lane];
+  state.pc = pc_[lane];
+  state.rngState = rngState_[lane];
+
+  const auto pixels = displays_[lane].Data();
+  std::copy(pixels.begin(), pixels.end(), state.display.begin());
+  state.keysHeld = keysHeld_[lane];
+  state.keysPressed = keysPressed_[lane];
+  state.instrTotal = instrTotal_[lane];
+  state.frameTotal = frameTotal_[lane];
+}
+
+void Lockstep8::LoadLane(std::size_t lane, const MachineState8 &state) {
+  if (state.stackDepth > RegisterSet8::stackSize || state.rngState == 0) {
+    throw std::invalid_argument("Invalid machine state");
+  }
+
+  memories_.at(lane).setSequence(0, Memory8::memSize, state.memory);
+  for (std::size_t reg = 0; reg < RegisterSet8::regCount; reg++) {
+    Reg(reg)[lane] = state.registers[reg];
+  }
+
+  stacks_[lane].assign(
+      std::span<const Address>{state.callStack}.first(state.stackDepth));
+  regDT_[lane] = state.regDT;
+  regST_[lane] = state.regST;
+  regI_[lane] = state.regI;
+  pc_[lane] = state.pc;
+  rngState_[lane] = state.rngState;
+
+  displays_[lane].Load(state.display);
+  keysHeld_[lane] = state.keysHeld;
+  keysPressed_[lane] = state.keysPressed;
+  instrTotal_[lane] = state.instrTotal;
+  frameTotal_[lane] = state.frameTotal;
+
+  running_[lane] = 1;
+  faults_[lane].clear();
+}
@@ -0,0 +1,165 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_LOCKSTEP_H
+#define EMU8_LOCKSTEP_H
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "fixed_stack.h"
+#include "frame_buffer.h"
+#include "machine.h"
+#include "machine_state.h"
+#include "memory.h"
+#include "register_set.h"
+
+/*
+ * many instances ("lanes") of the same program run in lockstep, for search
+ * and training workloads; registers, I, PC, timers, keys and generator
+ * states are kept in structure-of-arrays form, one contiguous array per
+ * field indexed by lane, while RAM, display and call stack stay per lane
+ *
+ * every step each running lane executes one instruction; lanes sharing a PC
+ * and opcode form a group, and register-only instructions run across the
+ * whole group in one masked loop over the arrays, which the compiler turns
+ * into SIMD code (with AVX2 and SSE4.2 versions chosen at run time on x86-64
+ * builds with GCC or Clang); anything touching memory, the display, the
+ * stack or the keypad runs lane by lane, as do small groups and lanes that
+ * have drifted out of phase across many different instructions
+ *
+ * each lane behaves exactly like a Machine8 with the same settings; a lane
+ * that faults stops, with the error kept, while the others carry on
+ */
+class Lockstep8 {
+public:
+  // groups smaller than this, or spread over more than densityRatio times
+  // their size in lanes, run lane by lane
+  static constexpr std::size_t minVectorLanes = 8;
+  static constexpr std::size_t densityRatio = 4;
+
+  // distinct instructions per step handled without sorting the lanes
+  static constexpr std::size_t maxBuckets = 8;
+
+  struct Stats {
+    uint64_t steps{0};          // calls to Step()
+    uint64_t convergedSteps{0}; // steps where all running lanes were one group
+    uint64_t vectorGroups{0};   // groups run by the masked array loops
+    uint64_t scalarGroups{0};   // groups run lane by lane
+  };
+
+  explicit Lockstep8(std::size_t lanes,
+                     std::size_t memBase = Memory8::loadAddrDefault,
+                     std::size_t ipt = Machine8::iptDefault);
+
+  // load the same program into every lane and reset it to the start
+  void LoadProgram(std::span<const Byte> image);
+
+  // seed a lane's random generator, as Machine8's seed argument does
+  void Seed(std::size_t lane, uint64_t seed);
+
+  // execute one instruction on every running lane
+  void Step();
+
+  // one 60 Hz tick on every running lane, with the same keys or per-lane keys
+  void RunFrame(Word keyMask);
+  void RunFrame(std::span<const Word> keyMasks);
+
+  [[nodiscard]] auto Lanes() const -> std::size_t { return lanes_; }
+  [[nodiscard]] auto Running(std::size_t lane) const -> bool {
+    return running_.at(lane) != 0;
+  }
+  [[nodiscard]] auto Fault(std::size_t lane) const -> const std::string & {
+    return faults_.at(lane);
+  }
+  [[nodiscard]] auto Display(std::size_t lane) const -> const FrameBuffer8 & {
+    return displays_.at(lane);
+  }
+  [[nodiscard]] auto Memory(std::size_t lane) const -> const Memory8 & {
+    return memories_.at(lane);
+  }
+  [[nodiscard]] auto FrameCount(std::size_t lane) const -> uint64_t {
+    return frameTotal_.at(lane);
+  }
+  [[nodiscard]] auto SoundActive(std::size_t lane) const -> bool {
+    return regST_.at(lane) > 0;
+  }
+  [[nodiscard]] auto GetStats() const -> const Stats & { return stats_; }
+
+  // copy one lane's complete state out, or replace it, in Machine8's format
+  void SaveLane(std::size_t lane, MachineState8 &state) const;
+  void LoadLane(std::size_t lane, const MachineState8 &state);
+
+private:
+  using CallStack = FixedStack<Address, RegisterSet8::stackSize>;
+
+  std::size_t lanes_;
+  std::size_t instrPerTick_;
+  Stats stats_ = {};
+
+  // structure-of-arrays state; registers_ holds V0 for every lane, then V1
+  // for every lane, and so on
+  std::vector<Byte> registers_;
+  std::vector<Address> regI_;
+  std::vector<Address> pc_;
+  std::vector<Byte> regDT_;
+  std::vector<Byte> regST_;
+  std::vector<Word> keysHeld_;
+  std::vector<Word> keysPressed_;
+  std::vector<uint64_t> rngState_;
+  std::vector<uint64_t> instrTotal_;
+  std::vector<uint64_t> frameTotal_;
+  std::vector<Byte> running_;
+
+  // per-lane state
+  std::vector<Memory8> memories_;
+  std::vector<FrameBuffer8> displays_;
+  std::vector<CallStack> stacks_;
+  std::vector<std::string> faults_;
+
+  // scratch for Step(), sized once
+  std::vector<Instruction> opcodes_;
+  std::vector<uint32_t> order_;
+  std::vector<uint32_t> grouped_;
+  std::vector<Byte> bucket_;
+  std::vector<Byte> mask_;
+
+  auto Reg(std::size_t reg) -> Byte * {
+    return registers_.data() + (reg * lanes_);
+  }
+  [[nodiscard]] auto Reg(std::size_t reg) const -> const Byte * {
+    return registers_.data() + (reg * lanes_);
+  }
+
+  auto BucketGroups(std::span<const uint32_t> members) -> bool;
+  void RunGroup(std::span<const uint32_t> group);
+  void ExecuteLane(std::size_t lane, Instruction opcode);
+  void ExecuteLaneSystem(std::size_t lane, Instruction opcode);
+  void ExecuteLaneMisc(std::size_t lane, Instruction opcode);
+  void StopLane(std::size_t lane, const std::string &fault);
+  void SetKeys(std::size_t lane, Word keyMask);
+  void RunTick();
+  void TickTimers();
+};
+
+#endif /* EMU8_LOCKSTEP_H */
@@ -0,0 +1,200 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+#include "hash.h"
+#include "machine.h"
+
+Machine8::Machine8(std::size_t memBase, std::size_t ipt, uint64_t seed)
+    : memBase_(memBase), instrPerTick_(ipt), memory_(memBase),
+      instructionSet_(regSet_, memory_, display_, keypad_, seed) {}
+
+void Machine8::LoadProgram(std::istream &progStream) {
+  memory_.loadProgram(progStream);
+  regSet_.pc = static_cast<Address>(memBase_);
+}
+
+void Machine8::LoadProgram(std::span<const Byte> image) {
+  memory_.loadProgram(image);
+  regSet_.pc = static_cast<Address>(memBase_);
+}
+
+void Machine8::Step() {
+  const auto opcode = memory_.fetchInstruction(regSet_.pc);
+  if (trace_ != nullptr) {
+    trace_->Record(regSet_.pc, opcode, regSet_);
+  }
+  if (profiler_ != nullptr) {
+    profiler_->Enter(regSet_.pc, opcode, regSet_);
+  }
+  regSet_.pc += 2;
+
+  instructionSet_.DecodeExecuteInstruction(opcode);
+  if (profiler_ != nullptr) {
+    profiler_->Leave();
+  }
+  instrTotal_++;
+}
+
+void Machine8::EndFrame() {
+  if (regSet_.regST > 0) {
+    regSet_.regST--;
+  }
+
+  if (regSet_.regDT > 0) {
+    regSet_.regDT--;
+  }
+
+  frameTotal_++;
+}
+
+void Machine8::RunFrame(Word keyMask) {
+  keypad_.SetState(keyMask);
+  RunFrame();
+}
+
+void Machine8::RunFrame() {
+  for (std::size_t count = 0; count < instrPerTick_; count++) {
+    Step();
+  }
+
+  EndFrame();
+}
+
+auto Machine8::WaitingForKey() const -> bool {
+  constexpr Instruction keyWaitMask = 0xF0FF;
+  constexpr Instruction keyWaitCode = 0xF00A;
+
+  if (regSet_.pc + 1U >= Memory8::memSize) {
+    return false;
+  }
+
+  const auto opcode = memory_.fetchInstructionUnchecked(regSet_.pc);
+  return (opcode & keyWaitMask) == keyWaitCode;
+}
+
+void Machine8::SaveState(MachineState8 &state) const {
+  const auto ram = memory_.viewSequence(0, Memory8::memSize);
+  std::copy(ram.begin(), ram.end(), state.memory.begin());
+
+  state.registers = regSet_.registers;
+  const auto depth = regSet_.callStack.size();
+  std::copy_n(regSet_.callStack.data(), depth, state.callStack.begin());
+  state.stackDepth = static_cast<Byte>(depth);
+  state.regDT = regSet_.regDT;
+  state.regST = regSet_.regST;
+  state.regI = regSet_.regI;
+  state.pc = regSet_.pc;
+
+  state.rngState = instructionSet_.Rng().GetState();
+
+  const auto pixels = display_.Data();
+  std::copy(pixels.begin(), pixels.end(), state.display.begin());
+  state.keysHeld = keypad_.GetState();
+  state.keysPressed = keypad_.GetLatched();
+
+  state.instrTotal = instrTotal_;
+  state.frameTotal = frameTotal_;
+}
+
+void Machine8::LoadState(const MachineState8 &state) {
+  if (state.stackDepth > RegisterSet8::stackSize) {
+    throw std::invalid_argument("Invalid machine state: call stack depth " +
+                                std::to_string(state.stackDepth));
+  }
+
+  // the generator rejects a zero state, so restore it before anything else
+  instructionSet_.Rng().SetState(state.rngState);
+
+  memory_.setSequence(0, Memory8::memSize, state.memory);
+
+  regSet_.registers = state.registers;
+  regSet_.callStack.assign(
+      std::span<const Address>{state.callStack}.first(state.stackDepth));
+  regSet_.regDT = state.regDT;
+  regSet_.regST = state.regST;
+  regSet_.regI = state.regI;
+  regSet_.pc = state.pc;
+
+  display_.Load(state.display);
+  keypad_.Restore(state.keysHeld, state.keysPressed);
+
+  instrTotal_ = state.instrTotal;
+  frameTotal_ = state.frameTotal;
+}
+
+void Machine8::CloneInto(Machine8 &slot) const {
+  if (&slot == this) {
+    return;
+  }
+
+  if (slot.memBase_ != memBase_ || slot.instrPerTick_ != instrPerTick_) {
+    throw std::invalid_argument("Clone target has different settings");
+  }
+
+  slot.memory_.setSequence(0, Memory8::memSize,
+                           memory_.viewSequence(0, Memory8::memSize));
+  slot.regSet_ = regSet_;
+  slot.display_ = display_;
+  slot.keypad_ = keypad_;
+  slot.instructionSet_.Rng().SetState(instructionSet_.Rng().GetState());
+  slot.instrTotal_ = instrTotal_;
+  slot.frameTotal_ = frameTotal_;
+}
+
+auto Machine8::StateHash() const -> uint64_t {
+  // the scalar state packed into one small buffer, little-endian; unused
+  // stack entries are left zero so that stale values above the top of the
+  // stack never change the hash
+  constexpr std::size_t scalarBytes = 19;
+  std::array<Byte, RegisterSet8::regCount + (RegisterSet8::stackSize * 2) +
+                       scalarBytes>
+      packed = {};
+
+  auto out = std::copy(regSet_.registers.begin(), regSet_.registers.end(),
+                       packed.begin());
+  const auto put = [&out](uint64_t value, std::size_t bytes) {
+    for (std::size_t byte = 0; byte < bytes; byte++) {
+      *out++ = static_cast<Byte>(value >> (byte * CHAR_BIT));
+    }
+  };
+
+  const auto &stack = regSet_.callStack;
+  for (std::size_t entry = 0; entry < RegisterSet8::stackSize; entry++) {
+    put((entry < stack.size()) ? stack.data()[entry] : 0, sizeof(Address));
+  }
+  put(instructionSet_.Rng().GetState(), sizeof(uint64_t));
+  put(stack.size(), 1);
+  put(regSet_.regDT, 1);
+  put(regSet_.regST, 1);
+  put(regSet_.regI, sizeof(Address));
+  put(regSet_.pc, sizeof(Address));
+  put(keypad_.GetState(), sizeof(Word));
+  put(keypad_.GetLatched(), sizeof(Word));
+
+  uint64_t hash = hash8::Fast64(memory_.viewSequence(0, Memory8::memSize));
+  hash = hash8::Fast64(display_.Data(), hash);
+  return hash8::Fast64(packed, hash);
+}
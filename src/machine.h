@@ -0,0 +1,150 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_MACHINE_H
+#define EMU8_MACHINE_H
+
+#include <istream>
+#include <span>
+
+#include "common.h"
+#include "frame_buffer.h"
+#include "instruction_set.h"
+#include "keypad.h"
+#include "machine_state.h"
+#include "memory.h"
+#include "profiler.h"
+#include "random.h"
+#include "register_set.h"
+#include "trace.h"
+
+/*
+ * the complete Chip-8 machine (memory, registers, display, keypad and
+ * instruction set) with no dependency on SDL; frontends feed it one key mask
+ * per tick and read back the display, so it can run windowed or headless
+ */
+class Machine8 {
+public:
+  // set instruction rate around 400 Hz
+  static constexpr std::size_t iptDefault = 7;
+  // far faster than any program needs, and still a short frame
+  static constexpr std::size_t iptMax = 100000;
+
+  explicit Machine8(std::size_t memBase = Memory8::loadAddrDefault,
+                    std::size_t ipt = iptDefault,
+                    uint64_t seed = Random8::defaultSeed);
+
+  // the instruction set holds references into this object
+  Machine8(const Machine8 &other) = delete;
+  Machine8(Machine8 &&other) = delete;
+  auto operator=(const Machine8 &other) -> Machine8 & = delete;
+  auto operator=(Machine8 &&other) -> Machine8 & = delete;
+  ~Machine8() = default;
+
+  // load a program image and point the program counter at its start
+  void LoadProgram(std::istream &progStream);
+  void LoadProgram(std::span<const Byte> image);
+
+  // fetch, decode and execute a single instruction
+  void Step();
+
+  // run one 60 Hz tick: latch the key mask, execute the configured number of
+  // instructions, then decrement the delay and sound timers
+  void RunFrame(Word keyMask);
+
+  // the same tick with the keypad left as it is, for callers that set the
+  // keys themselves through Keys()
+  void RunFrame();
+
+  // the end of a tick, for callers that execute its instructions themselves
+  // with Step(): decrement the timers and count the frame
+  void EndFrame();
+
+  // whether the next instruction is an Fx0A key wait; the machine stays on it
+  // until a key is pressed, so it then has only 16 distinct next frames
+  [[nodiscard]] auto WaitingForKey() const -> bool;
+
+  // copy the full machine state out, or replace it wholesale
+  void SaveState(MachineState8 &state) const;
+  void LoadState(const MachineState8 &state);
+
+  // duplicate this machine's full state into an existing machine with the
+  // same load address and instruction rate, copying a few KB and never
+  // allocating; used to branch a search from one state
+  void CloneInto(Machine8 &slot) const;
+
+  // 64-bit fingerprint of everything that decides how the machine runs on
+  // (RAM, registers, call stack, timers, generator, display and keys), but
+  // not the instruction and frame totals, so the same state reached along
+  // different paths hashes the same
+  [[nodiscard]] auto StateHash() const -> uint64_t;
+
+  [[nodiscard]] auto GetMemBase() const -> std::size_t { return memBase_; }
+  [[nodiscard]] auto GetInstructionsPerTick() const -> std::size_t {
+    return instrPerTick_;
+  }
+
+  // running totals since construction
+  [[nodiscard]] auto InstructionCount() const -> uint64_t {
+    return instrTotal_;
+  }
+  [[nodiscard]] auto FrameCount() const -> uint64_t { return frameTotal_; }
+
+  auto Memory() -> Memory8 & { return memory_; }
+  [[nodiscard]] auto Memory() const -> const Memory8 & { return memory_; }
+  auto Registers() -> RegisterSet8 & { return regSet_; }
+  [[nodiscard]] auto Registers() const -> const RegisterSet8 & {
+    return regSet_;
+  }
+  auto Display() -> FrameBuffer8 & { return display_; }
+  [[nodiscard]] auto Display() const -> const FrameBuffer8 & {
+    return display_;
+  }
+  auto Keys() -> Keypad8 & { return keypad_; }
+  [[nodiscard]] auto Keys() const -> const Keypad8 & { return keypad_; }
+  auto Instructions() -> InstructionSet8 & { return instructionSet_; }
+
+  // count and time every instruction from now on into profiler, or stop
+  // with nullptr; the profiler must outlive its use here
+  void SetProfiler(Profiler8 *profiler) { profiler_ = profiler; }
+  [[nodiscard]] auto Profiler() const -> Profiler8 * { return profiler_; }
+
+  // record every instruction from now on into trace, or stop with nullptr;
+  // the trace must outlive its use here
+  void SetTrace(Trace8 *trace) { trace_ = trace; }
+  [[nodiscard]] auto Trace() const -> Trace8 * { return trace_; }
+
+private:
+  std::size_t memBase_;
+  std::size_t instrPerTick_;
+  uint64_t instrTotal_{0};
+  uint64_t frameTotal_{0};
+
+  Memory8 memory_;
+  RegisterSet8 regSet_ = {};
+  FrameBuffer8 display_ = {};
+  Keypad8 keypad_ = {};
+  InstructionSet8 instructionSet_;
+  Profiler8 *profiler_{nullptr};
+  Trace8 *trace_{nullptr};
+};
+
+#endif /* EMU8_MACHINE_H */
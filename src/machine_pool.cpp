@@ -0,0 +1,52 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "machine_pool.h"
+
+static_assert(alignof(Machine8) <= Arena8::cacheLine);
+
+MachinePool8::MachinePool8(std::size_t count, std::size_t memBase,
+                           std::size_t ipt, uint64_t seed, bool hugePages)
+    : arena_(sizeof(Machine8), count, hugePages) {
+  // if a constructor throws, the destructor never runs, so undo by hand
+  try {
+    for (; built_ < Size(); built_++) {
+      new (arena_.Slot(built_)) Machine8(memBase, ipt, seed + built_);
+    }
+  } catch (...) {
+    while (built_ > 0) {
+      At(--built_).~Machine8();
+    }
+    throw;
+  }
+}
+
+MachinePool8::~MachinePool8() {
+  while (built_ > 0) {
+    At(--built_).~Machine8();
+  }
+}
+
+void MachinePool8::LoadProgram(std::span<const Byte> image) {
+  for (std::size_t index = 0; index < Size(); index++) {
+    At(index).LoadProgram(image);
+  }
+}
@@ -0,0 +1,69 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_MACHINE_POOL_H
+#define EMU8_MACHINE_POOL_H
+
+#include <new>
+#include <span>
+
+#include "arena.h"
+#include "common.h"
+#include "machine.h"
+#include "memory.h"
+
+/*
+ * a fixed number of machines built in place in one Arena8, for hosting many
+ * copies of a ROM densely; a machine needs no heap memory of its own, so
+ * each lives entirely in its cache-line aligned slot, and walking the pool
+ * touches memory in order
+ *
+ * machine n is seeded with seed + n, like the environments of an
+ * EnvironmentBatch8
+ */
+class MachinePool8 {
+public:
+  MachinePool8(std::size_t count,
+               std::size_t memBase = Memory8::loadAddrDefault,
+               std::size_t ipt = Machine8::iptDefault,
+               uint64_t seed = Random8::defaultSeed, bool hugePages = false);
+  ~MachinePool8();
+
+  MachinePool8(const MachinePool8 &other) = delete;
+  MachinePool8(MachinePool8 &&other) = delete;
+  auto operator=(const MachinePool8 &other) -> MachinePool8 & = delete;
+  auto operator=(MachinePool8 &&other) -> MachinePool8 & = delete;
+
+  [[nodiscard]] auto Size() const -> std::size_t { return arena_.Slots(); }
+  [[nodiscard]] auto At(std::size_t index) const -> Machine8 & {
+    return *std::launder(static_cast<Machine8 *>(arena_.Slot(index)));
+  }
+  [[nodiscard]] auto GetArena() const -> const Arena8 & { return arena_; }
+
+  // load the same program into every machine
+  void LoadProgram(std::span<const Byte> image);
+
+private:
+  Arena8 arena_;
+  std::size_t built_{0};
+};
+
+#endif /* EMU8_MACHINE_POOL_H */
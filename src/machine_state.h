@@ -0,0 +1,54 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_MACHINE_STATE_H
+#define EMU8_MACHINE_STATE_H
+
+#include <array>
+
+#include "common.h"
+#include "frame_buffer.h"
+#include "memory.h"
+#include "register_set.h"
+
+/*
+ * plain copy of everything that determines how a Machine8 runs from here on:
+ * RAM, registers, call stack, timers, random generator, display and keypad
+ * latches; cheap to copy (a few KB), so it backs save states and snapshots
+ */
+struct MachineState8 {
+  std::array<Byte, Memory8::memSize> memory = {};
+  std::array<Byte, RegisterSet8::regCount> registers = {};
+  std::array<Address, RegisterSet8::stackSize> callStack = {};
+  Byte stackDepth = {0};
+  Byte regDT = {0};
+  Byte regST = {0};
+  Address regI = {0};
+  Address pc = {0};
+  uint64_t rngState = {0};
+  FrameBuffer8::Buffer display = {};
+  Word keysHeld = {0};
+  Word keysPressed = {0};
+  uint64_t instrTotal = {0};
+  uint64_t frameTotal = {0};
+};
+
+#endif /* EMU8_MACHINE_STATE_H */
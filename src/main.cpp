@@ -19,17 +19,32 @@
  *
  */
 
+#include <array>
+#include <chrono>
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <random>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
 #include <boost/program_options.hpp>
 
+#include "byte_stream.h"
 #include "common.h"
+#include "hash.h"
+#include "machine.h"
 #include "memory.h"
+#include "movie.h"
+#include "perf_counters.h"
+#include "profiler.h"
+#include "rom_bench.h"
+#include "save_state.h"
 #include "virtual_machine.h"
 
 namespace bpo = boost::program_options;
@@ -37,28 +52,125 @@ namespace bpo = boost::program_options;
 void usage(const std::string &prog) {
   const std::filesystem::path progPath{prog};
   std::cerr << "usage: " << progPath.filename().string() << " "
-            << "[--audioBufSize size] [--config conf.ini] [--eti660] [--help] "
-            << "[--ipt count] [-s|--scaling scale_factor] romfile\n";
+            << "[--audioBufSize size] [--bench] [--benchFrames count] "
+            << "[--callGraph file] [--callGraphTime file] "
+            << "[--config conf.ini] [--countAllocs] [--counters] "
+            << "[--eti660] [--headless] [--heatMap file] [--help] "
+            << "[--ipt count] [--loadState file] [--metrics name] "
+            << "[--playMovie file] "
+            << "[--profile file] [--recordMovie file] "
+            << "[--rewind seconds] [--runAhead frames] "
+            << "[-s|--scaling scale_factor] [--seed value] [--speculate] "
+            << "[--stateFile file] [--symbols file] [--timeline file] "
+            << "[--traceLength count] "
+            << "romfile\n";
 }
 
+// only used when no seed is given, so that each run still differs by default
+auto entropy_seed() -> uint64_t {
+  std::random_device rdev;
+  constexpr unsigned halfWidth = 32;
+
+  const uint64_t high = rdev();
+  const uint64_t low = rdev();
+  return (high << halfWidth) | low;
+}
+
+// command line modes that run without a window, and profiler output
+struct HeadlessMode {
+  bool replay{false};
+  bool bench{false};
+  uint64_t benchFrames{0};
+  bool counters{false};
+  std::string profileFile{};
+  std::string heatMapFile{};
+  std::string callGraphFile{};
+  std::string callGraphTimeFile{};
+  std::string symbolFile{};
+
+  [[nodiscard]] auto Profiling() const -> bool {
+    return !(profileFile.empty() && heatMapFile.empty() &&
+             callGraphFile.empty() && callGraphTimeFile.empty());
+  }
+};
+
 auto parse_options(int argc, std::vector<char *> &argv,
-                   VirtualMachine8::Settings &settings) -> bool {
+                   VirtualMachine8::Settings &settings, HeadlessMode &mode)
+    -> bool {
+  constexpr uint64_t benchFramesDefault = 3600;
+
   bpo::options_description visible("Options");
   // clang-format off
   visible.add_options()
     ("audioBufSize", bpo::value<Address>(&settings.audioSize)
                     ->default_value(Interface8::defaultAudioBufSize), 
                     "SDL audio buffer size")
+    ("bench", bpo::bool_switch(&mode.bench),
+     "Run headless and unthrottled with scripted input (or --playMovie) "
+     "and report emulation speed")
+    ("benchFrames", bpo::value<uint64_t>(&mode.benchFrames)
+                    ->default_value(benchFramesDefault),
+     "Emulated frames run by --bench")
+    ("callGraph", bpo::value<std::string>(&mode.callGraphFile),
+     "Profile the run and write instructions per guest call stack, as "
+     "folded stacks for flame graphs")
+    ("callGraphTime", bpo::value<std::string>(&mode.callGraphTimeFile),
+     "As --callGraph, weighted by host nanoseconds")
     ("config", bpo::value<std::string>(&settings.config), 
      "Keybind config file")
+    ("countAllocs", bpo::bool_switch(&settings.countAllocs),
+     "Report heap allocations made per frame after warm-up")
+    ("counters", bpo::bool_switch(&mode.counters),
+     "With --bench, also count CPU cycles, instructions, branch misses and "
+     "L1 data cache misses per instruction and per opcode class (Linux)")
     ("eti660", "Load ROM using ETI 660 address conventions")
+    ("headless", "Replay the --playMovie file without a window and print "
+     "the final machine state hash")
+    ("heatMap", bpo::value<std::string>(&mode.heatMapFile),
+     "Profile the run and write a PPM heat map of memory writes (red), "
+     "reads (green) and executes (blue)")
     ("help", "Display help message")
     ("ipt", bpo::value<std::size_t>(&settings.ipt)
-                    ->default_value(VirtualMachine8::iptDefault), 
+                    ->default_value(Machine8::iptDefault), 
      "Instructions per tick, sets effective clock speed")
+    ("loadState", bpo::value<std::string>(&settings.loadState),
+     "Resume from a save state file after loading the ROM")
+    ("metrics", bpo::value<std::string>(&settings.metrics),
+     "Publish runtime counters in this shared memory page, shared by all "
+     "instances given the same name")
+    ("playMovie", bpo::value<std::string>(&settings.playMovie),
+     "Replay recorded input from a movie file")
+    ("profile", bpo::value<std::string>(&mode.profileFile),
+     "Profile the run and write executions and host time per opcode class "
+     "and the hottest addresses to a file")
+    ("recordMovie", bpo::value<std::string>(&settings.recordMovie),
+     "Record input to a movie file for exact replay")
+    ("rewind", bpo::value<std::size_t>(&settings.rewindSeconds),
+     "Seconds of history kept for rewinding with Backspace, default off")
+    ("runAhead", bpo::value<std::size_t>(&settings.runAhead),
+     "Frames to run ahead of the shown frame to hide input lag, default off")
     ("scaling,s", bpo::value<int>(&settings.scaling)
                     ->default_value(Interface8::defaultScaling),
-                    "Video resolution scaling");
+                    "Video resolution scaling")
+    ("seed", bpo::value<uint64_t>(&settings.seed),
+     "Random number generator seed, for reproducible runs")
+    ("sharedMemory", bpo::value<std::string>(&settings.sharedMemory),
+     "Publish live machine state each frame in this POSIX shared memory "
+     "segment")
+    ("speculate", bpo::bool_switch(&settings.speculate),
+     "Precompute the next frame for every key while waiting on Fx0A")
+    ("stateFile", bpo::value<std::string>(&settings.stateFile),
+     "Save state file used by the F5 (save) and F9 (load) hotkeys, "
+     "default romfile.state")
+    ("symbols", bpo::value<std::string>(&mode.symbolFile),
+     "Subroutine names for call graphs, as lines of \"address name\"")
+    ("timeline", bpo::value<std::string>(&settings.timeline),
+     "Write a Chrome trace-event timeline of each frame's phases and the "
+     "audio callbacks to this file on exit")
+    ("traceLength", bpo::value<std::size_t>(&settings.traceLength)
+                    ->default_value(settings.traceLength),
+     "Instructions kept in the trace dumped with the core file on a fault, "
+     "0 for none");
   // clang-format on
 
   bpo::options_description hidden("Hidden options");
@@ -91,9 +203,111 @@ auto parse_options(int argc, std::vector<char *> &argv,
     settings.memBase = Memory8::loadAddrEti660;
   }
 
+  // benchmarks must repeat exactly, so they never draw a seed at random
+  if (varMap.count("seed") == 0) {
+    settings.seed = mode.bench ? Random8::defaultSeed : entropy_seed();
+  }
+
+  if (settings.ipt == 0 || settings.ipt > Machine8::iptMax) {
+    throw std::invalid_argument("--ipt must be from 1 to " +
+                                std::to_string(Machine8::iptMax));
+  }
+
+  if (settings.runAhead > RunAhead8::maxFrames) {
+    throw std::invalid_argument("--runAhead is limited to " +
+                                std::to_string(RunAhead8::maxFrames) +
+                                " frames");
+  }
+
+  // movies always start from a freshly loaded ROM
+  if (!settings.loadState.empty() &&
+      !(settings.playMovie.empty() && settings.recordMovie.empty())) {
+    throw std::invalid_argument("--loadState cannot be used with movies");
+  }
+
+  if (!settings.playMovie.empty()) {
+    settings.playback = movie8::Movie::Load(settings.playMovie);
+    settings.seed = settings.playback->Seed();
+    settings.memBase = settings.playback->MemBase();
+    settings.ipt = settings.playback->Ipt();
+  }
+
+  if (mode.counters && !mode.bench) {
+    throw std::invalid_argument("--counters requires --bench");
+  }
+
+  if (varMap.count("headless") != 0) {
+    if (!settings.playback) {
+      throw std::invalid_argument("--headless requires --playMovie");
+    }
+    mode.replay = true;
+  }
+
   return (varMap.count("inputFile") != 0);
 }
 
+// replay a movie as fast as possible with no window, reporting the run length,
+// speed, and a hash of the final machine state for comparing runs exactly
+auto run_headless(const VirtualMachine8::Settings &settings) -> int {
+  try {
+    const auto rom = ReadFileBytes(settings.romFile);
+    const auto &movie = settings.playback.value();
+    Machine8 machine(movie.MemBase(), movie.Ipt(), movie.Seed());
+    machine.SetProfiler(settings.profiler);
+
+    const auto start = std::chrono::steady_clock::now();
+    movie8::Play(machine, movie, rom);
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    MachineState8 state;
+    machine.SaveState(state);
+    std::vector<Byte> image;
+    state8::Serialize(state, image);
+
+    std::cout << "frames: " << machine.FrameCount() << '\n'
+              << "instructions: " << machine.InstructionCount() << '\n'
+              << "seconds: " << elapsed.count() << '\n'
+              << "state hash: " << std::hex << std::setw(16)
+              << std::setfill('0') << hash8::Fnv1a(image) << std::dec << '\n';
+  } catch (const std::exception &err) {
+    std::cerr << "ERROR: " << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+// run the ROM for a fixed number of frames as fast as possible, reporting
+// emulation speed and where the time went
+auto run_bench(const VirtualMachine8::Settings &settings, uint64_t frames,
+               const PerfCounters8 *counters) -> int {
+  try {
+    const auto rom = ReadFileBytes(settings.romFile);
+
+    // with no window, presenting a frame is expanding it into texels
+    std::array<Uint32, Interface8::pixelCount> texels = {};
+    rombench8::Config config{settings.memBase, settings.ipt, settings.seed,
+                             frames, nullptr,
+                             [&texels](std::span<const Byte> screen) {
+                               Interface8::ExpandTexels(screen, texels);
+                             }};
+    if (settings.playback) {
+      config.movie = &settings.playback.value();
+    }
+    config.profiler = settings.profiler;
+    config.counters = counters;
+
+    const auto report = rombench8::Run(rom, config);
+    rombench8::Print(std::cout, report);
+  } catch (const std::exception &err) {
+    std::cerr << "ERROR: " << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
 void print_license() {
   std::cout << "------------------------------------\n"
             << "emu8 Copyright (C) 2023 Thomas Allen\n"
@@ -109,13 +323,75 @@ void print_license() {
   std::cout << '\n';
 }
 
+void write_file(const std::string &path,
+                const std::function<void(std::ostream &)> &write) {
+  std::ofstream out(path, std::ios::binary);
+  write(out);
+  if (!out) {
+    std::cerr << "WARNING: could not write " << path << '\n';
+  }
+}
+
+void write_profile(const Profiler8 &profiler, const HeadlessMode &mode) {
+  constexpr std::size_t hottest = 20;
+
+  if (!mode.profileFile.empty()) {
+    write_file(mode.profileFile,
+               [&](std::ostream &out) { profiler.Report(out, hottest); });
+  }
+
+  if (!mode.heatMapFile.empty()) {
+    write_file(mode.heatMapFile,
+               [&](std::ostream &out) { profiler.HeatMap(out); });
+  }
+
+  if (!mode.callGraphFile.empty()) {
+    write_file(mode.callGraphFile, [&](std::ostream &out) {
+      profiler.FoldedStacks(out, Profiler8::Weight::instructions);
+    });
+  }
+
+  if (!mode.callGraphTimeFile.empty()) {
+    write_file(mode.callGraphTimeFile, [&](std::ostream &out) {
+      profiler.FoldedStacks(out, Profiler8::Weight::nanoseconds);
+    });
+  }
+}
+
+// run in the mode chosen on the command line
+auto run_mode(const VirtualMachine8::Settings &settings,
+              const HeadlessMode &mode, const PerfCounters8 *counters)
+    -> int {
+  if (mode.bench) {
+    return run_bench(settings, mode.benchFrames, counters);
+  }
+
+  if (mode.replay) {
+    return run_headless(settings);
+  }
+
+  print_license();
+
+  // setup can fail outside the emulation loop, e.g. creating shared memory
+  try {
+    const std::filesystem::path title{settings.romFile};
+    VirtualMachine8 vm8(title.stem(), settings);
+
+    return vm8.Run(settings.romFile);
+  } catch (const std::exception &err) {
+    std::cerr << "ERROR: " << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+}
+
 auto main(int argc, char *argv[]) -> int {
   std::vector<char *> vecArgs(argv, argv + argc);
 
   VirtualMachine8::Settings progSettings;
   bool inputPresent{false};
+  HeadlessMode mode;
   try {
-    inputPresent = parse_options(argc, vecArgs, progSettings);
+    inputPresent = parse_options(argc, vecArgs, progSettings, mode);
   } catch (const std::exception &err) {
     std::cerr << err.what() << '\n';
     usage(vecArgs.front());
@@ -127,12 +403,41 @@ auto main(int argc, char *argv[]) -> int {
     return EXIT_FAILURE;
   }
 
-  print_license();
+  // counters are an optional extra, so a host without them still benchmarks
+  std::unique_ptr<PerfCounters8> counters;
+  if (mode.counters) {
+    try {
+      counters = std::make_unique<PerfCounters8>();
+    } catch (const std::runtime_error &err) {
+      std::cerr << "WARNING: " << err.what() << '\n';
+    }
+  }
+
+  // the profile is written even when the program faults, since where it
+  // was running until then is often the interesting part
+  std::unique_ptr<Profiler8> profiler;
+  if (mode.Profiling()) {
+    profiler = std::make_unique<Profiler8>();
+    progSettings.profiler = profiler.get();
 
-  const std::filesystem::path title{progSettings.romFile};
-  VirtualMachine8 vm8(title.stem(), progSettings);
+    if (!mode.symbolFile.empty()) {
+      std::ifstream symbols(mode.symbolFile);
+      try {
+        if (!symbols) {
+          throw std::runtime_error("Could not read " + mode.symbolFile);
+        }
+        profiler->LoadSymbols(symbols);
+      } catch (const std::exception &err) {
+        std::cerr << "ERROR: " << err.what() << '\n';
+        return EXIT_FAILURE;
+      }
+    }
+  }
 
-  auto retval = vm8.Run(progSettings.romFile);
+  const auto retval = run_mode(progSettings, mode, counters.get());
+  if (profiler) {
+    write_profile(*profiler, mode);
+  }
 
   return retval;
 }
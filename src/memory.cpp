@@ -20,6 +20,7 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <filesystem>
 #include <iterator>
 #include <sstream>
@@ -36,12 +37,21 @@
 }
 
 Memory8::Memory8(const std::size_t memBase) : memLow_(memBase), memory_() {
+  // everything from the load address up is the program area
+  if (memBase >= memSize) {
+    std::stringstream errStream;
+    errStream << "Invalid load address: " << std::hex << memBase;
+    throw std::out_of_range(errStream.str());
+  }
+
   memory_.fill(0x0);
   fillTextSprites();
 }
 
 void Memory8::fillTextSprites() {
-  const std::vector<Byte> sprites = {
+  // one sprite per hex digit, kept static so construction never allocates
+  constexpr std::size_t digitCount = 16;
+  static constexpr std::array<Byte, spriteLen * digitCount> sprites = {
       0xF0, // 1111
       0x90, // 1  1
       0x90, // 1  1 -> "0"
@@ -147,10 +157,7 @@ auto Memory8::fetchInstruction(const Address addr) const -> Instruction {
     reportInvalidAccess(addr);
   }
 
-  const auto msb = memory_.at(addr);
-  const auto lsb = memory_.at(addr + 1);
-
-  return bits8::fuseBytes(msb, lsb);
+  return fetchInstructionUnchecked(addr);
 }
 
 auto Memory8::fetchByte(const Address addr) const -> Byte {
@@ -158,17 +165,31 @@ auto Memory8::fetchByte(const Address addr) const -> Byte {
     reportInvalidAccess(addr);
   }
 
-  return memory_.at(addr);
+  return fetchByteUnchecked(addr);
 }
 
 void Memory8::fetchSequence(const Address addr, const Word size,
                             std::vector<Byte> &buf) const {
+  const auto view = viewSequence(addr, size);
+  std::copy(view.begin(), view.end(), std::back_inserter(buf));
+}
+
+auto Memory8::viewSequence(const Address addr, const Word size) const
+    -> std::span<const Byte> {
+  if (addr + size > memSize) {
+    reportInvalidAccess(addr);
+  }
+
+  return std::span<const Byte>{memory_}.subspan(addr, size);
+}
+
+auto Memory8::mutableSequence(const Address addr, const Word size)
+    -> std::span<Byte> {
   if (addr + size > memSize) {
     reportInvalidAccess(addr);
   }
 
-  std::copy(memory_.begin() + addr, memory_.begin() + addr + size,
-            std::back_inserter(buf));
+  return std::span<Byte>{memory_}.subspan(addr, size);
 }
 
 void Memory8::setByte(const Address addr, Byte val) {
@@ -176,26 +197,30 @@ void Memory8::setByte(const Address addr, Byte val) {
     reportInvalidAccess(addr);
   }
 
-  memory_[addr] = val;
+  setByteUnchecked(addr, val);
 }
 
 void Memory8::setSequence(const Address addr, const Word size,
-                          const std::vector<Byte> &buf) {
-  if (addr + size > memSize) {
-    reportInvalidAccess(addr);
-  }
+                          std::span<const Byte> buf) {
+  const auto dest = mutableSequence(addr, size);
 
-  std::copy(buf.begin(), buf.end(), memory_.begin() + addr);
+  // never write past the checked range, even if buf holds more than size bytes
+  const auto count = std::min<std::size_t>(size, buf.size());
+  std::copy_n(buf.begin(), count, dest.begin());
 }
 
 void Memory8::loadProgram(std::istream &progStream) {
-  progStream.unsetf(std::ios::skipws);
+  // read up to the end of the stream, not a fixed count, so that nothing
+  // past the end of the image is written into memory
+  const std::vector<Byte> image(std::istreambuf_iterator<char>(progStream),
+                                std::istreambuf_iterator<char>{});
+  loadProgram(image);
+}
 
+void Memory8::loadProgram(std::span<const Byte> image) {
   const std::size_t bufSize = memSize - memLow_;
-  std::copy_n(std::istream_iterator<Byte>(progStream), bufSize,
+  std::copy_n(image.begin(), std::min(bufSize, image.size()),
               memory_.begin() + memLow_);
-
-  progStream.setf(std::ios::skipws);
 }
 
 void Memory8::dumpCore(std::ostream &coreStream) const {
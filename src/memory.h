@@ -25,9 +25,11 @@
 #include <array>
 #include <istream>
 #include <ostream>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "bits.h"
 #include "common.h"
 
 class Memory8 {
@@ -54,16 +56,41 @@ public:
   // retrieve a sequence of bytes of length size from memory, starting at addr
   void fetchSequence(Address addr, Word size, std::vector<Byte> &buf) const;
 
+  // return a read-only view of size bytes of memory starting at addr, after a
+  // single range check; the view aliases memory and copies nothing
+  [[nodiscard]] auto viewSequence(Address addr, Word size) const
+      -> std::span<const Byte>;
+
+  // as viewSequence(), but the returned view can be written through
+  [[nodiscard]] auto mutableSequence(Address addr, Word size)
+      -> std::span<Byte>;
+
   // set the value of the byte in memory at address addr to val
   void setByte(Address addr, Byte val);
 
   // set the value of a sequence of bytes in memory to the values specified in
   // buf, starting at address addr and continuing for size bytes
-  void setSequence(Address addr, Word size, const std::vector<Byte> &buf);
+  void setSequence(Address addr, Word size, std::span<const Byte> buf);
+
+  // unchecked accessors, only for callers that have already validated addr
+  // (e.g. against a view or a known-good range)
+  [[nodiscard]] auto fetchByteUnchecked(Address addr) const -> Byte {
+    return memory_[addr];
+  }
+
+  [[nodiscard]] auto fetchInstructionUnchecked(Address addr) const
+      -> Instruction {
+    return bits8::fuseBytes(memory_[addr], memory_[addr + 1]);
+  }
+
+  void setByteUnchecked(Address addr, Byte val) { memory_[addr] = val; }
 
   // load a program image into memory from input stream, starting at memLow_
   void loadProgram(std::istream &progStream);
 
+  // as above, from an in-memory image; bytes past the end of RAM are dropped
+  void loadProgram(std::span<const Byte> image);
+
   // dump full memory image to specified output stream for debugging
   void dumpCore(std::ostream &coreStream) const;
 
@@ -0,0 +1,217 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "metrics.h"
+
+namespace {
+
+constexpr mode_t pageMode = 0644;
+
+// how long an instance waits for another one that is creating the page
+constexpr int setupTries = 100;
+constexpr auto setupWait = std::chrono::milliseconds(10);
+
+// shared memory names are a single path component after a leading slash
+auto PageName(const std::string &name) -> std::string {
+  return (!name.empty() && name.front() == '/') ? name : "/" + name;
+}
+
+[[noreturn]] void ReportError(const std::string &msg,
+                              const std::string &name) {
+  throw std::runtime_error(msg + name + ": " + std::strerror(errno));
+}
+
+auto Valid(const MetricsPage8 &page) -> bool {
+  return page.version == MetricsPage8::versionValue &&
+         page.size == sizeof(MetricsPage8) &&
+         page.slots == MetricsPage8::slotCount &&
+         page.slotSize == sizeof(MetricsSlot8);
+}
+
+// a slot whose owner died without releasing it, e.g. killed by a signal
+auto Abandoned(uint32_t pid) -> bool {
+  return pid != 0 && ::kill(static_cast<pid_t>(pid), 0) < 0 &&
+         errno == ESRCH;
+}
+
+} // namespace
+
+MetricsExport8::MetricsExport8(const std::string &name)
+    : name_(PageName(name)) {
+  int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC,
+                      pageMode);
+  const bool created = (fd >= 0);
+  if (!created && errno == EEXIST) {
+    fd = ::shm_open(name_.c_str(), O_RDWR | O_CLOEXEC, 0);
+  }
+  if (fd < 0) {
+    ReportError("Could not open metrics page ", name_);
+  }
+
+  if (created && ::ftruncate(fd, MetricsPage8::pageSize) < 0) {
+    ::close(fd);
+    ::shm_unlink(name_.c_str());
+    ReportError("Could not size metrics page ", name_);
+  }
+
+  // another instance may still be sizing a page it has just created
+  struct stat info = {};
+  for (int tries = 0; !created && tries < setupTries; tries++) {
+    if (::fstat(fd, &info) < 0 ||
+        static_cast<std::size_t>(info.st_size) >= MetricsPage8::pageSize) {
+      break;
+    }
+    std::this_thread::sleep_for(setupWait);
+  }
+
+  void *addr = ::mmap(nullptr, MetricsPage8::pageSize, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) { // NOLINT
+    ReportError("Could not map metrics page ", name_);
+  }
+
+  if (created) {
+    // the header goes in last, so nobody uses a half-built page
+    page_ = new (addr) MetricsPage8();
+    page_->version = MetricsPage8::versionValue;
+    page_->size = sizeof(MetricsPage8);
+    page_->slots = MetricsPage8::slotCount;
+    page_->slotSize = sizeof(MetricsSlot8);
+    std::atomic_thread_fence(std::memory_order_release);
+    page_->magic = MetricsPage8::magicValue;
+  } else {
+    page_ = static_cast<MetricsPage8 *>(addr);
+    for (int tries = 0; tries < setupTries; tries++) {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (page_->magic == MetricsPage8::magicValue) {
+        break;
+      }
+      std::this_thread::sleep_for(setupWait);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (page_->magic != MetricsPage8::magicValue || !Valid(*page_)) {
+      ::munmap(addr, MetricsPage8::pageSize);
+      throw std::runtime_error("Shared memory is not a version " +
+                               std::to_string(MetricsPage8::versionValue) +
+                               " emu8 metrics page: " + name_);
+    }
+  }
+
+  try {
+    Claim();
+  } catch (...) {
+    ::munmap(addr, MetricsPage8::pageSize);
+    throw;
+  }
+}
+
+MetricsExport8::~MetricsExport8() {
+  slot_->pid.store(0, std::memory_order_release);
+  page_->instances.fetch_sub(1, std::memory_order_relaxed);
+  ::munmap(page_, MetricsPage8::pageSize);
+}
+
+void MetricsExport8::Claim() {
+  const auto self = static_cast<uint32_t>(::getpid());
+
+  // prefer slots never used, then ones whose instance exited (losing its
+  // final counts), then ones whose instance died without releasing them
+  for (int pass = 0; pass < 3 && slot_ == nullptr; pass++) {
+    for (auto &slot : page_->slot) {
+      auto owner = slot.pid.load(std::memory_order_acquire);
+      const bool fresh = (slot.lastPid.load(std::memory_order_relaxed) == 0);
+      const bool wanted = (pass == 0)   ? (owner == 0 && fresh)
+                          : (pass == 1) ? (owner == 0)
+                                        : Abandoned(owner);
+      if (wanted && slot.pid.compare_exchange_strong(
+                        owner, self, std::memory_order_acq_rel)) {
+        if (pass == 2) {
+          page_->instances.fetch_sub(1, std::memory_order_relaxed);
+        }
+        slot_ = &slot;
+        break;
+      }
+    }
+  }
+
+  if (slot_ == nullptr) {
+    throw std::runtime_error("No free slot in metrics page " + name_);
+  }
+
+  for (auto *counter :
+       {&slot_->instructions, &slot_->framesPresented, &slot_->ticksMissed,
+        &slot_->sleepOvershootNs, &slot_->faults, &slot_->inputEvents,
+        &slot_->audioUnderruns}) {
+    counter->store(0, std::memory_order_relaxed);
+  }
+  slot_->lastPid.store(self, std::memory_order_relaxed);
+  page_->instances.fetch_add(1, std::memory_order_relaxed);
+}
+
+MetricsView8::MetricsView8(const std::string &name) {
+  const auto path = PageName(name);
+  const int fd = ::shm_open(path.c_str(), O_RDONLY | O_CLOEXEC, 0);
+  if (fd < 0) {
+    ReportError("Could not open metrics page ", path);
+  }
+
+  struct stat info = {};
+  if (::fstat(fd, &info) < 0 ||
+      static_cast<std::size_t>(info.st_size) < MetricsPage8::pageSize) {
+    ::close(fd);
+    throw std::runtime_error("Shared memory is not an emu8 metrics page: " +
+                             path);
+  }
+
+  void *addr =
+      ::mmap(nullptr, MetricsPage8::pageSize, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) { // NOLINT
+    ReportError("Could not map metrics page ", path);
+  }
+
+  page_ = static_cast<const MetricsPage8 *>(addr);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (page_->magic != MetricsPage8::magicValue || !Valid(*page_)) {
+    ::munmap(addr, MetricsPage8::pageSize);
+    throw std::runtime_error("Shared memory is not a version " +
+                             std::to_string(MetricsPage8::versionValue) +
+                             " emu8 metrics page: " + path);
+  }
+}
+
+MetricsView8::~MetricsView8() {
+  ::munmap(const_cast<MetricsPage8 *>(page_), // NOLINT
+           MetricsPage8::pageSize);
+}
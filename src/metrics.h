@@ -0,0 +1,133 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_METRICS_H
+#define EMU8_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/*
+ * runtime counters for monitoring agents, published in one 4 KB POSIX
+ * shared memory page that all emu8 instances given the same name share
+ *
+ * the page holds a header and a slot for each running instance; a slot is
+ * written only by its instance, one thread per cache line, so counting is a
+ * plain load and store with no locked instructions and no cache line bounced
+ * between writers; every field is a naturally aligned 64-bit (or 32-bit)
+ * integer in native byte order, so agents read them with ordinary loads and
+ * need no locking: each counter only grows while its slot is owned
+ *
+ * a slot with a nonzero pid belongs to that running process; once the
+ * process exits its pid goes back to 0 and its counters stay readable, with
+ * lastPid naming the process, until another instance claims the slot
+ */
+struct MetricsSlot8 {
+  static constexpr std::size_t cacheLine = 64;
+
+  // written by the emulation thread
+  alignas(cacheLine) std::atomic<uint32_t> pid{0};
+  std::atomic<uint32_t> lastPid{0};
+  std::atomic<uint64_t> instructions{0};
+  std::atomic<uint64_t> framesPresented{0};
+  std::atomic<uint64_t> ticksMissed{0};
+  std::atomic<uint64_t> sleepOvershootNs{0};
+  std::atomic<uint64_t> faults{0};
+  std::atomic<uint64_t> inputEvents{0};
+
+  // written by the audio callback thread
+  alignas(cacheLine) std::atomic<uint64_t> audioUnderruns{0};
+
+  // counters have a single writer, so this needs no read-modify-write
+  static void Add(std::atomic<uint64_t> &counter, uint64_t amount = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount,
+                  std::memory_order_relaxed);
+  }
+};
+
+struct MetricsPage8 {
+  static constexpr std::array<char, 8> magicValue = {'E', 'M', 'U', '8',
+                                                     'M', 'E', 'T', 'R'};
+  static constexpr uint32_t versionValue = 1;
+  static constexpr std::size_t pageSize = 4096;
+  static constexpr std::size_t slotCount = 31;
+
+  std::array<char, 8> magic{};
+  uint32_t version{0};
+  uint32_t size{0};
+  uint32_t slots{0};
+  uint32_t slotSize{0};
+
+  // slots owned by running processes
+  std::atomic<uint32_t> instances{0};
+
+  std::array<MetricsSlot8, slotCount> slot{};
+};
+
+static_assert(sizeof(MetricsPage8) <= MetricsPage8::pageSize,
+              "metrics must fit in one page");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "metrics must be readable across processes");
+
+// an instance's side: opens or creates the page and claims a slot, which is
+// released when this is destroyed; the page itself is left for the next
+// instance and for agents
+class MetricsExport8 {
+public:
+  explicit MetricsExport8(const std::string &name);
+  ~MetricsExport8();
+
+  MetricsExport8(const MetricsExport8 &other) = delete;
+  MetricsExport8(MetricsExport8 &&other) = delete;
+  auto operator=(const MetricsExport8 &other) -> MetricsExport8 & = delete;
+  auto operator=(MetricsExport8 &&other) -> MetricsExport8 & = delete;
+
+  [[nodiscard]] auto Slot() -> MetricsSlot8 & { return *slot_; }
+  [[nodiscard]] auto Name() const -> const std::string & { return name_; }
+
+private:
+  std::string name_;
+  MetricsPage8 *page_{nullptr};
+  MetricsSlot8 *slot_{nullptr};
+
+  void Claim();
+};
+
+// an agent's side: maps an existing page read-only
+class MetricsView8 {
+public:
+  explicit MetricsView8(const std::string &name);
+  ~MetricsView8();
+
+  MetricsView8(const MetricsView8 &other) = delete;
+  MetricsView8(MetricsView8 &&other) = delete;
+  auto operator=(const MetricsView8 &other) -> MetricsView8 & = delete;
+  auto operator=(MetricsView8 &&other) -> MetricsView8 & = delete;
+
+  [[nodiscard]] auto Page() const -> const MetricsPage8 & { return *page_; }
+
+private:
+  const MetricsPage8 *page_{nullptr};
+};
+
+#endif /* EMU8_METRICS_H */
@@ -0,0 +1,168 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "byte_stream.h"
+#include "hash.h"
+#include "movie.h"
+
+movie8::Movie::Movie(uint64_t romHash, uint64_t seed, std::size_t memBase,
+                     std::size_t ipt)
+    : romHash_(romHash), seed_(seed), memBase_(memBase), ipt_(ipt) {
+  frames_.reserve(reserveFrames);
+}
+
+void movie8::Movie::Serialize(std::vector<Byte> &buf) const {
+  constexpr std::size_t maxRun = std::numeric_limits<Word>::max();
+
+  // collect the runs first so the header can carry their count
+  std::vector<std::pair<Word, Word>> runs;
+  for (std::size_t frame = 0; frame < frames_.size();) {
+    const auto mask = frames_[frame];
+    std::size_t len = 1;
+    while (frame + len < frames_.size() && len < maxRun &&
+           frames_[frame + len] == mask) {
+      len++;
+    }
+    runs.emplace_back(mask, static_cast<Word>(len));
+    frame += len;
+  }
+
+  buf.clear();
+  buf.reserve(headerSize + (runs.size() * 2 * sizeof(Word)));
+
+  ByteWriter writer(buf);
+  std::copy(fileMagic.begin(), fileMagic.end(), std::back_inserter(buf));
+  writer.Put<uint16_t>(formatVersion);
+  writer.Put<Address>(static_cast<Address>(memBase_));
+  writer.Put<uint32_t>(static_cast<uint32_t>(ipt_));
+  writer.Put<uint64_t>(seed_);
+  writer.Put<uint64_t>(romHash_);
+  writer.Put<uint32_t>(static_cast<uint32_t>(frames_.size()));
+  writer.Put<uint32_t>(static_cast<uint32_t>(runs.size()));
+
+  for (const auto &[mask, len] : runs) {
+    writer.Put<Word>(mask);
+    writer.Put<Word>(len);
+  }
+}
+
+auto movie8::Movie::Deserialize(std::span<const Byte> image) -> Movie {
+  ByteReader reader(image, "Movie");
+
+  const auto magic = reader.Take(fileMagic.size());
+  if (!std::equal(magic.begin(), magic.end(), fileMagic.begin())) {
+    throw std::runtime_error("Not an emu8 movie");
+  }
+
+  const auto version = reader.Get<uint16_t>();
+  if (version != formatVersion) {
+    throw std::runtime_error("Unsupported movie version " +
+                             std::to_string(version));
+  }
+
+  Movie movie;
+  movie.memBase_ = reader.Get<Address>();
+  movie.ipt_ = reader.Get<uint32_t>();
+  if (movie.ipt_ == 0 || movie.ipt_ > Machine8::iptMax) {
+    throw std::runtime_error("Movie clock rate of " +
+                             std::to_string(movie.ipt_) +
+                             " instructions per tick is out of range");
+  }
+  movie.seed_ = reader.Get<uint64_t>();
+  movie.romHash_ = reader.Get<uint64_t>();
+  const auto frameCount = reader.Get<uint32_t>();
+  const auto runCount = reader.Get<uint32_t>();
+
+  // check the sizes before trusting them with an allocation: the runs must
+  // fill the rest of the file, and could not encode more frames than this
+  if (reader.Remaining() != std::size_t{runCount} * 2 * sizeof(Word)) {
+    throw std::runtime_error("Movie run count does not match its size");
+  }
+  constexpr std::size_t maxRun = std::numeric_limits<Word>::max();
+  if (frameCount > std::size_t{runCount} * maxRun) {
+    throw std::runtime_error("Movie frame count does not match its runs");
+  }
+
+  movie.frames_.reserve(frameCount);
+  for (uint32_t run = 0; run < runCount; run++) {
+    const auto mask = reader.Get<Word>();
+    const auto len = reader.Get<Word>();
+    if (len == 0 || movie.frames_.size() + len > frameCount) {
+      throw std::runtime_error("Movie has a malformed run");
+    }
+    movie.frames_.insert(movie.frames_.end(), len, mask);
+  }
+
+  if (movie.frames_.size() != frameCount) {
+    throw std::runtime_error("Movie frame count does not match its runs");
+  }
+
+  return movie;
+}
+
+void movie8::Movie::Save(const std::string &path) const {
+  std::vector<Byte> buf;
+  Serialize(buf);
+
+  std::ofstream movieFile(path, std::ios::binary | std::ios::trunc);
+  if (!movieFile.good()) {
+    throw std::runtime_error("Could not create movie: " + path);
+  }
+
+  movieFile.write(reinterpret_cast<const char *>(buf.data()), // NOLINT
+                  static_cast<std::streamsize>(buf.size()));
+  movieFile.close();
+  if (movieFile.fail()) {
+    throw std::runtime_error("Could not write movie: " + path);
+  }
+}
+
+auto movie8::Movie::Load(const std::string &path) -> Movie {
+  return Deserialize(ReadFileBytes(path));
+}
+
+void movie8::CheckRom(const Movie &movie, std::span<const Byte> rom) {
+  if (hash8::Fnv1a(rom) != movie.RomHash()) {
+    throw std::runtime_error("Movie was recorded with a different ROM");
+  }
+}
+
+void movie8::Play(Machine8 &machine, const Movie &movie,
+                  std::span<const Byte> rom) {
+  if (machine.GetMemBase() != movie.MemBase() ||
+      machine.GetInstructionsPerTick() != movie.Ipt()) {
+    throw std::invalid_argument("Machine settings do not match the movie");
+  }
+
+  CheckRom(movie, rom);
+  machine.LoadProgram(rom);
+
+  for (std::size_t frame = 0; frame < movie.FrameCount(); frame++) {
+    machine.RunFrame(movie.KeyMask(frame));
+  }
+}
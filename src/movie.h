@@ -0,0 +1,112 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_MOVIE_H
+#define EMU8_MOVIE_H
+
+#include <array>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "machine.h"
+
+/*
+ * input movies: the key mask fed to the machine on every tick, plus
+ * everything else a run depends on (ROM hash, random seed, load address and
+ * clock rate), so that replaying one reproduces the original run exactly
+ *
+ * file format, all multi-byte fields little-endian:
+ *
+ *   offset  size  field
+ *        0     8  magic "EMU8MOVI"
+ *        8     2  format version
+ *       10     2  program load address
+ *       12     4  instructions per tick
+ *       16     8  random generator seed
+ *       24     8  ROM hash (64-bit FNV-1a of the ROM file)
+ *       32     4  frame count
+ *       36     4  run count
+ *       40   4*n  runs: 2 byte key mask, then 2 byte repeat count (1-65535)
+ *
+ * keys are typically held for many ticks at a time, so the run-length
+ * coding keeps movies at a few bytes per second of play
+ */
+namespace movie8 {
+
+constexpr std::array<char, 8> fileMagic = {'E', 'M', 'U', '8',
+                                           'M', 'O', 'V', 'I'};
+constexpr uint16_t formatVersion = 1;
+constexpr std::size_t headerSize = 40;
+
+class Movie {
+public:
+  // recording reserves an hour of ticks up front, so that appending does not
+  // allocate during normal play
+  static constexpr std::size_t reserveFrames = 60 * 60 * 60;
+
+  Movie() = default;
+  Movie(uint64_t romHash, uint64_t seed, std::size_t memBase,
+        std::size_t ipt);
+
+  // record the key mask used for the next tick
+  void Append(Word keyMask) { frames_.push_back(keyMask); }
+
+  [[nodiscard]] auto FrameCount() const -> std::size_t {
+    return frames_.size();
+  }
+  [[nodiscard]] auto KeyMask(std::size_t frame) const -> Word {
+    return frames_.at(frame);
+  }
+
+  [[nodiscard]] auto RomHash() const -> uint64_t { return romHash_; }
+  [[nodiscard]] auto Seed() const -> uint64_t { return seed_; }
+  [[nodiscard]] auto MemBase() const -> std::size_t { return memBase_; }
+  [[nodiscard]] auto Ipt() const -> std::size_t { return ipt_; }
+
+  // encode into buf, replacing its contents
+  void Serialize(std::vector<Byte> &buf) const;
+
+  // decode a movie image, throwing std::runtime_error on a malformed one
+  static auto Deserialize(std::span<const Byte> image) -> Movie;
+
+  void Save(const std::string &path) const;
+  static auto Load(const std::string &path) -> Movie;
+
+private:
+  uint64_t romHash_ = {0};
+  uint64_t seed_ = {0};
+  std::size_t memBase_ = {0};
+  std::size_t ipt_ = {0};
+  std::vector<Word> frames_ = {};
+};
+
+// throw std::runtime_error unless rom is the image the movie was recorded on
+void CheckRom(const Movie &movie, std::span<const Byte> rom);
+
+// check and load rom, then run every recorded tick; the machine must have
+// been constructed with the movie's load address, clock rate and seed
+void Play(Machine8 &machine, const Movie &movie, std::span<const Byte> rom);
+
+} // namespace movie8
+
+#endif /* EMU8_MOVIE_H */
@@ -0,0 +1,188 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "perf_counters.h"
+
+namespace {
+
+constexpr std::array<std::string_view, PerfCounters8::eventCount> eventNames =
+    {"cycles", "instructions", "branch-misses", "L1d-misses"};
+
+} // namespace
+
+#ifdef __linux__
+
+namespace {
+
+auto EventAttr(PerfCounters8::Event event) -> perf_event_attr {
+  perf_event_attr attr{};
+  attr.size = sizeof(attr);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  switch (event) {
+  case PerfCounters8::cycles:
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    break;
+  case PerfCounters8::instructions:
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    break;
+  case PerfCounters8::branchMisses:
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+    break;
+  case PerfCounters8::l1Misses:
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_L1D |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8U) |        // NOLINT
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U);    // NOLINT
+    break;
+  default:
+    throw std::invalid_argument("Unknown performance counter");
+  }
+  return attr;
+}
+
+auto OpenEvent(perf_event_attr &attr, int group) -> int {
+  // this thread, on whichever CPU it runs
+  return static_cast<int>(
+      ::syscall(SYS_perf_event_open, &attr, 0, -1, group, 0)); // NOLINT
+}
+
+} // namespace
+
+PerfCounters8::PerfCounters8() {
+  // the other events join the cycle counter's group, so the kernel always
+  // schedules them together and their ratios stay meaningful
+  auto leader = EventAttr(cycles);
+  leader.disabled = 1;
+  fds_[cycles] = OpenEvent(leader, -1);
+  if (fds_[cycles] < 0) {
+    throw std::runtime_error(
+        std::string("Could not open hardware performance counters: ") +
+        std::strerror(errno));
+  }
+  opened_ = 1;
+
+  for (const auto event : {instructions, branchMisses, l1Misses}) {
+    auto attr = EventAttr(event);
+    fds_.at(event) = OpenEvent(attr, fds_[cycles]);
+    opened_ += (fds_.at(event) >= 0) ? 1 : 0;
+  }
+
+  if (fds_[instructions] < 0) {
+    const auto err = errno;
+    Close();
+    throw std::runtime_error(
+        std::string("Could not count retired instructions: ") +
+        std::strerror(err));
+  }
+
+  ::ioctl(fds_[cycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP); // NOLINT
+  ::ioctl(fds_[cycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP); // NOLINT
+}
+
+PerfCounters8::~PerfCounters8() { Close(); }
+
+void PerfCounters8::Close() {
+  for (auto &fd : fds_) {
+    if (fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
+  }
+}
+
+auto PerfCounters8::Read() const -> Counts {
+  // nr, time enabled, time running, then one value per open event in the
+  // order they joined the group
+  std::array<uint64_t, 3 + eventCount> buffer{};
+  const auto bytes = (3 + opened_) * sizeof(uint64_t);
+  if (::read(fds_[cycles], buffer.data(), bytes) !=
+      static_cast<ssize_t>(bytes)) {
+    throw std::runtime_error(
+        std::string("Could not read hardware performance counters: ") +
+        std::strerror(errno));
+  }
+
+  const auto enabled = buffer[1];
+  const auto running = buffer[2];
+  const double scale = (running > 0 && running < enabled)
+                           ? static_cast<double>(enabled) /
+                                 static_cast<double>(running)
+                           : 1.0;
+
+  Counts counts{};
+  std::size_t slot = 3;
+  for (std::size_t event = 0; event < eventCount; event++) {
+    if (fds_.at(event) >= 0) {
+      counts.at(event) = static_cast<uint64_t>(
+          static_cast<double>(buffer.at(slot++)) * scale);
+    }
+  }
+  return counts;
+}
+
+#else
+
+PerfCounters8::PerfCounters8() {
+  throw std::runtime_error(
+      "Hardware performance counters need Linux perf_event_open");
+}
+
+PerfCounters8::~PerfCounters8() = default;
+
+void PerfCounters8::Close() {}
+
+auto PerfCounters8::Read() const -> Counts { return {}; }
+
+#endif
+
+auto PerfCounters8::EventName(Event event) -> std::string_view {
+  return eventNames.at(event);
+}
+
+auto PerfCounters8::Difference(const Counts &later, const Counts &earlier)
+    -> Counts {
+  Counts diff{};
+  for (std::size_t event = 0; event < eventCount; event++) {
+    diff.at(event) = (later.at(event) > earlier.at(event))
+                         ? later.at(event) - earlier.at(event)
+                         : 0;
+  }
+  return diff;
+}
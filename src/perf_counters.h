@@ -0,0 +1,73 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_PERF_COUNTERS_H
+#define EMU8_PERF_COUNTERS_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+/*
+ * hardware performance counters for the calling thread, read through Linux
+ * perf_event_open(2): CPU cycles, retired instructions, branch mispredicts
+ * and L1 data cache read misses, counting user space only; the counters run
+ * from construction, and a caller takes the difference of two readings
+ */
+class PerfCounters8 {
+public:
+  enum Event : std::size_t { cycles, instructions, branchMisses, l1Misses };
+  static constexpr std::size_t eventCount = 4;
+
+  using Counts = std::array<uint64_t, eventCount>;
+
+  // throws if the counters cannot be opened, e.g. off Linux, without a PMU
+  // (as in many virtual machines), or when perf_event_paranoid forbids it;
+  // branch and cache events the CPU lacks are left out and read as zero
+  PerfCounters8();
+  ~PerfCounters8();
+
+  PerfCounters8(const PerfCounters8 &other) = delete;
+  PerfCounters8(PerfCounters8 &&other) = delete;
+  auto operator=(const PerfCounters8 &other) -> PerfCounters8 & = delete;
+  auto operator=(PerfCounters8 &&other) -> PerfCounters8 & = delete;
+
+  // totals since construction, scaled up if the kernel had to multiplex
+  // the counters with other users
+  [[nodiscard]] auto Read() const -> Counts;
+
+  [[nodiscard]] auto Available(Event event) const -> bool {
+    return fds_.at(event) >= 0;
+  }
+
+  static auto EventName(Event event) -> std::string_view;
+
+  static auto Difference(const Counts &later, const Counts &earlier)
+      -> Counts;
+
+private:
+  std::array<int, eventCount> fds_{-1, -1, -1, -1};
+  std::size_t opened_{0};
+
+  void Close();
+};
+
+#endif /* EMU8_PERF_COUNTERS_H */
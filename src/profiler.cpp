@@ -0,0 +1,445 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "bits.h"
+#include "profiler.h"
+
+namespace {
+
+constexpr std::array<std::string_view, Profiler8::classCount> classNames = {
+    "00E0", "00EE", "1nnn", "2nnn", "3xkk", "4xkk", "5xy0", "6xkk", "7xkk",
+    "8xy0", "8xy1", "8xy2", "8xy3", "8xy4", "8xy5", "8xy6", "8xy7", "8xyE",
+    "9xy0", "Annn", "Bnnn", "Cxkk", "Dxyn", "Ex9E", "ExA1", "Fx07", "Fx0A",
+    "Fx15", "Fx18", "Fx1E", "Fx29", "Fx33", "Fx55", "Fx65", "invalid"};
+
+// first class of each group in the table above
+constexpr std::size_t aluFirst = 9;
+constexpr std::size_t highFirst = 18;
+constexpr std::size_t keyFirst = 23;
+constexpr std::size_t miscFirst = 25;
+
+// classes that touch RAM beyond their own opcode
+constexpr std::size_t drawClass = highFirst + 4;
+constexpr std::size_t bcdClass = miscFirst + 6;
+constexpr std::size_t storeClass = miscFirst + 7;
+constexpr std::size_t loadClass = miscFirst + 8;
+constexpr std::size_t callClass = 3;
+constexpr std::size_t returnClass = 1;
+
+// entry point for frames already on the stack when profiling began, or after
+// a state load replaced the stack
+constexpr Address unknownEntry = 0xFFFF;
+
+// cost of a clock read, about what the timing itself adds to every timed
+// instruction
+auto ClockOverhead() -> Profiler8::Clock::duration {
+  constexpr int reads = 1000;
+  const auto start = Profiler8::Clock::now();
+  auto last = start;
+  for (int count = 0; count < reads; count++) {
+    last = Profiler8::Clock::now();
+  }
+  return (last - start) / reads;
+}
+
+} // namespace
+
+// mirrors the decoding in InstructionSet8, so a class is exactly the
+// instruction that runs
+auto Profiler8::Classify(Instruction opcode) -> std::size_t {
+  constexpr Byte aluShiftLeft = 0xE;
+  const auto [high, low] = bits8::splitWord(opcode);
+  const auto lowNib = bits8::lowNibble(low);
+
+  switch (bits8::highNibble(high)) {
+  case 0x0:
+    return (low == 0xE0) ? 0 : (low == 0xEE) ? 1 : invalidClass;
+  case 0x8:
+    if (lowNib <= 0x7) {
+      return aluFirst + lowNib;
+    }
+    return (lowNib == aluShiftLeft) ? aluFirst + 0x8 : invalidClass;
+  case 0x9:
+    return highFirst;
+  case 0xA:
+  case 0xB:
+  case 0xC:
+  case 0xD:
+    return highFirst + bits8::highNibble(high) - 0x9;
+  case 0xE:
+    return (low == 0x9E) ? keyFirst : (low == 0xA1) ? keyFirst + 1
+                                                    : invalidClass;
+  case 0xF: {
+    constexpr std::array<Byte, 9> miscCodes = {0x07, 0x0A, 0x15, 0x18, 0x1E,
+                                               0x29, 0x33, 0x55, 0x65};
+    const auto *found = std::find(miscCodes.begin(), miscCodes.end(), low);
+    return (found != miscCodes.end())
+               ? miscFirst + static_cast<std::size_t>(found -
+                                                      miscCodes.begin())
+               : invalidClass;
+  }
+  default:
+    // 1nnn through 7xkk, in table order
+    return 1 + bits8::highNibble(high);
+  }
+}
+
+auto Profiler8::ClassName(std::size_t opClass) -> std::string_view {
+  return classNames.at(opClass);
+}
+
+void Profiler8::Touch(Counts &counts, Address addr, std::size_t size) {
+  const auto end = std::min<std::size_t>(addr + size, Memory8::memSize);
+  for (std::size_t pos = addr; pos < end; pos++) {
+    counts[pos]++; // NOLINT
+  }
+}
+
+void Profiler8::Enter(Address pc, Instruction opcode,
+                      const RegisterSet8 &regs) {
+  current_ = Classify(opcode);
+  classCounts_[current_]++; // NOLINT
+  total_++;
+
+  if (pc < Memory8::memSize) {
+    executes_[pc]++;       // NOLINT
+    opcodes_[pc] = opcode; // NOLINT
+  }
+
+  // the RAM an instruction touches follows from the opcode and registers:
+  // Dxyn reads n sprite rows, Fx33 writes three digits, and Fx55 and Fx65
+  // move registers V0 through Vx
+  const auto [high, low] = bits8::splitWord(opcode);
+  const std::size_t regsMoved = bits8::lowNibble(high) + 1U;
+  switch (current_) {
+  case drawClass:
+    Touch(reads_, regs.regI, bits8::lowNibble(low));
+    break;
+  case bcdClass:
+    Touch(writes_, regs.regI, 3);
+    break;
+  case storeClass:
+    Touch(writes_, regs.regI, regsMoved);
+    break;
+  case loadClass:
+    Touch(reads_, regs.regI, regsMoved);
+    break;
+  default:
+    break;
+  }
+
+  FollowCalls(opcode, regs);
+  if (counters_ != nullptr) {
+    eventStart_ = counters_->Read();
+  }
+  start_ = Clock::now();
+}
+
+void Profiler8::Leave() {
+  const auto elapsed = Clock::now() - start_;
+  classTimes_[current_] += elapsed; // NOLINT
+  calls_[timedNode_].time += elapsed;
+
+  if (counters_ != nullptr) {
+    const auto events =
+        PerfCounters8::Difference(counters_->Read(), eventStart_);
+    auto &total = classEvents_[current_]; // NOLINT
+    for (std::size_t event = 0; event < PerfCounters8::eventCount; event++) {
+      total.at(event) += events.at(event);
+    }
+  }
+}
+
+void Profiler8::SetCounters(const PerfCounters8 *counters) {
+  counters_ = counters;
+  counterOverhead_ = {};
+  if (counters_ == nullptr) {
+    return;
+  }
+
+  // the least seen for an empty instruction, as most of the samples are
+  // inflated by interrupts and cold caches
+  constexpr int trials = 100;
+  counterOverhead_.fill(std::numeric_limits<uint64_t>::max());
+  for (int trial = 0; trial < trials; trial++) {
+    const auto before = counters_->Read();
+    std::ignore = Clock::now();
+    std::ignore = Clock::now();
+    const auto events = PerfCounters8::Difference(counters_->Read(), before);
+    for (std::size_t event = 0; event < PerfCounters8::eventCount; event++) {
+      counterOverhead_.at(event) =
+          std::min(counterOverhead_.at(event), events.at(event));
+    }
+  }
+}
+
+auto Profiler8::ClassEvents(std::size_t opClass) const
+    -> PerfCounters8::Counts {
+  const auto count = classCounts_.at(opClass);
+  auto events = classEvents_.at(opClass);
+  for (std::size_t event = 0; event < PerfCounters8::eventCount; event++) {
+    const auto overhead = counterOverhead_.at(event) * count;
+    events.at(event) =
+        (events.at(event) > overhead) ? events.at(event) - overhead : 0;
+  }
+  return events;
+}
+
+void Profiler8::EnterCall(Address entry) {
+  const auto key = std::make_pair(callNode_, entry);
+  auto found = callIndex_.find(key);
+  if (found == callIndex_.end()) {
+    found = callIndex_.emplace(key, calls_.size()).first;
+    calls_.push_back({entry, callNode_, 0, {}});
+  }
+
+  callNode_ = found->second;
+  callDepth_++;
+}
+
+void Profiler8::FollowCalls(Instruction opcode, const RegisterSet8 &regs) {
+  // the machine stack can change under us (a state load, or profiling from
+  // the middle of a run), so line up with its depth first
+  while (callDepth_ > regs.callStack.size()) {
+    callNode_ = calls_[callNode_].parent;
+    callDepth_--;
+  }
+  while (callDepth_ < regs.callStack.size()) {
+    EnterCall(unknownEntry);
+  }
+
+  // a call counts towards its caller and a return towards the routine
+  // returning, which is how a flame graph reads
+  timedNode_ = callNode_;
+  calls_[timedNode_].count++;
+
+  if (current_ == callClass && callDepth_ < RegisterSet8::stackSize) {
+    EnterCall(bits8::maskAddress(opcode));
+  } else if (current_ == returnClass && callDepth_ > 0) {
+    callNode_ = calls_[callNode_].parent;
+    callDepth_--;
+  }
+}
+
+void Profiler8::LoadSymbols(std::istream &in) {
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string addrText;
+    std::string name;
+    if (!(fields >> addrText) || addrText.front() == '#') {
+      continue;
+    }
+    if (!(fields >> name)) {
+      throw std::invalid_argument("Symbol without a name: " + line);
+    }
+
+    const auto addr = std::stoul(addrText, nullptr, 16); // NOLINT
+    if (addr >= Memory8::memSize) {
+      throw std::invalid_argument("Symbol address out of range: " + line);
+    }
+    symbols_[static_cast<Address>(addr)] = name;
+  }
+}
+
+auto Profiler8::FrameName(std::size_t node) const -> std::string {
+  if (node == 0) {
+    return "main";
+  }
+
+  const auto entry = calls_[node].entry;
+  if (entry == unknownEntry) {
+    return "[unknown]";
+  }
+
+  const auto symbol = symbols_.find(entry);
+  if (symbol != symbols_.end()) {
+    return symbol->second;
+  }
+
+  std::ostringstream name;
+  name << "sub_" << std::hex << std::uppercase << std::setw(3)
+       << std::setfill('0') << entry;
+  return name.str();
+}
+
+void Profiler8::FoldedStacks(std::ostream &out, Weight weight) const {
+  const auto overhead = ClockOverhead();
+
+  std::vector<std::string> frames;
+  for (std::size_t node = 0; node < calls_.size(); node++) {
+    const auto &call = calls_[node];
+    if (call.count == 0) {
+      continue;
+    }
+
+    uint64_t value = call.count;
+    if (weight == Weight::nanoseconds) {
+      const auto host =
+          std::max(Clock::duration::zero(),
+                   call.time - overhead * static_cast<int64_t>(call.count));
+      value = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(host).count());
+    }
+
+    frames.clear();
+    for (auto frame = node; frame != 0; frame = calls_[frame].parent) {
+      frames.push_back(FrameName(frame));
+    }
+    frames.push_back(FrameName(0));
+
+    for (auto name = frames.rbegin(); name != frames.rend(); name++) {
+      out << ((name == frames.rbegin()) ? "" : ";") << *name;
+    }
+    out << ' ' << value << '\n';
+  }
+}
+
+void Profiler8::Report(std::ostream &out, std::size_t hottest) const {
+  constexpr double percent = 100.0;
+  constexpr int nameWidth = 9;
+  constexpr int countWidth = 14;
+  constexpr int shareWidth = 8;
+  constexpr int eventWidth = 18;
+
+  const auto share = [this](uint64_t count) {
+    return (total_ > 0) ? percent * static_cast<double>(count) /
+                              static_cast<double>(total_)
+                        : 0.0;
+  };
+
+  const auto overhead = ClockOverhead();
+  std::vector<std::size_t> classes(classCount);
+  std::iota(classes.begin(), classes.end(), 0);
+  std::stable_sort(classes.begin(), classes.end(), [this](auto lhs, auto rhs) {
+    return classCounts_[lhs] > classCounts_[rhs]; // NOLINT
+  });
+
+  out << "instructions: " << total_ << "\n\n"
+      << std::left << std::setw(nameWidth) << "class" << std::right
+      << std::setw(countWidth) << "count" << std::setw(shareWidth) << "%"
+      << std::setw(countWidth) << "host ns/op";
+  if (Counted()) {
+    for (std::size_t event = 0; event < PerfCounters8::eventCount; event++) {
+      out << std::setw(eventWidth)
+          << std::string(PerfCounters8::EventName(
+                 static_cast<PerfCounters8::Event>(event))) +
+                 "/op";
+    }
+  }
+  out << '\n' << std::fixed << std::setprecision(2);
+  for (const auto opClass : classes) {
+    const auto count = classCounts_[opClass]; // NOLINT
+    if (count == 0) {
+      break;
+    }
+
+    const auto host = std::max(Clock::duration::zero(),
+                               classTimes_[opClass] - // NOLINT
+                                   overhead * static_cast<int64_t>(count));
+    const auto nsPerOp =
+        static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(host)
+                .count()) /
+        static_cast<double>(count);
+    out << std::left << std::setw(nameWidth) << ClassName(opClass)
+        << std::right << std::setw(countWidth) << count << std::setw(shareWidth)
+        << share(count) << std::setw(countWidth) << nsPerOp;
+    if (Counted()) {
+      const auto events = ClassEvents(opClass);
+      for (std::size_t event = 0; event < PerfCounters8::eventCount; event++) {
+        out << std::setw(eventWidth);
+        if (counters_->Available(static_cast<PerfCounters8::Event>(event))) {
+          out << static_cast<double>(events.at(event)) /
+                     static_cast<double>(count);
+        } else {
+          out << "n/a";
+        }
+      }
+    }
+    out << '\n';
+  }
+
+  std::vector<Address> addrs(Memory8::memSize);
+  std::iota(addrs.begin(), addrs.end(), 0);
+  std::stable_sort(addrs.begin(), addrs.end(), [this](auto lhs, auto rhs) {
+    return executes_[lhs] > executes_[rhs]; // NOLINT
+  });
+
+  out << '\n'
+      << std::left << std::setw(nameWidth) << "address" << std::setw(nameWidth)
+      << "opcode" << std::setw(nameWidth) << "class" << std::right
+      << std::setw(countWidth) << "count" << std::setw(shareWidth) << "%"
+      << '\n';
+  for (std::size_t rank = 0; rank < std::min(hottest, addrs.size()); rank++) {
+    const auto addr = addrs[rank];
+    const auto count = executes_[addr]; // NOLINT
+    if (count == 0) {
+      break;
+    }
+
+    const auto opcode = opcodes_[addr]; // NOLINT
+    out << std::hex << std::uppercase << std::setfill('0') << "0x"
+        << std::setw(3) << addr << "    " << std::setw(4) << opcode
+        << std::dec << std::nouppercase << std::setfill(' ') << "     "
+        << std::left << std::setw(nameWidth) << ClassName(Classify(opcode))
+        << std::right << std::setw(countWidth) << count
+        << std::setw(shareWidth) << share(count) << '\n';
+  }
+}
+
+void Profiler8::HeatMap(std::ostream &out) const {
+  constexpr double maxLevel = 255.0;
+
+  // log scale, so addresses run a handful of times still show up next to
+  // the inner loop
+  const auto scale = [](const Counts &counts) {
+    const auto peak = *std::max_element(counts.begin(), counts.end());
+    const double top = std::log1p(static_cast<double>(peak));
+    return [&counts, top](std::size_t addr) {
+      if (top <= 0.0) {
+        return Byte{0};
+      }
+      return static_cast<Byte>(std::lround(
+          maxLevel * std::log1p(static_cast<double>(counts[addr])) / top));
+    };
+  };
+  const auto red = scale(writes_);
+  const auto green = scale(reads_);
+  const auto blue = scale(executes_);
+
+  out << "P6\n" << mapSide << ' ' << mapSide << "\n255\n";
+  for (std::size_t addr = 0; addr < Memory8::memSize; addr++) {
+    const std::array<Byte, 3> pixel = {red(addr), green(addr), blue(addr)};
+    out.write(reinterpret_cast<const char *>(pixel.data()), // NOLINT
+              pixel.size());
+  }
+}
@@ -0,0 +1,150 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_PROFILER_H
+#define EMU8_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+#include "memory.h"
+#include "perf_counters.h"
+#include "register_set.h"
+
+/*
+ * guest-level profile of a running program: executions per opcode class and
+ * per address, host time per opcode class, the RAM each instruction reads
+ * and writes, and instructions and host time per guest call stack (followed
+ * through 2nnn and 00EE), and optionally hardware events per opcode class;
+ * a machine only pays for this while a profiler is attached (see
+ * Machine8::SetProfiler)
+ */
+class Profiler8 {
+public:
+  // one class per Chip-8 instruction, plus one for undecodable opcodes
+  static constexpr std::size_t classCount = 35;
+  static constexpr std::size_t invalidClass = classCount - 1;
+
+  // side of the square heat map, one pixel per address
+  static constexpr std::size_t mapSide = 64;
+
+  using Clock = std::chrono::steady_clock;
+  using Counts = std::array<uint64_t, Memory8::memSize>;
+
+  // what each folded stack line counts
+  enum class Weight { instructions, nanoseconds };
+
+  static auto Classify(Instruction opcode) -> std::size_t;
+  static auto ClassName(std::size_t opClass) -> std::string_view;
+
+  // called around each instruction, with the registers as they are before
+  // it executes
+  void Enter(Address pc, Instruction opcode, const RegisterSet8 &regs);
+  void Leave();
+
+  [[nodiscard]] auto Instructions() const -> uint64_t { return total_; }
+  [[nodiscard]] auto ClassCount(std::size_t opClass) const -> uint64_t {
+    return classCounts_.at(opClass);
+  }
+  [[nodiscard]] auto ClassTime(std::size_t opClass) const
+      -> Clock::duration {
+    return classTimes_.at(opClass);
+  }
+  // also count hardware events for each instruction; reading the counters
+  // costs two system calls per instruction, whose user-space share is
+  // measured here and taken out again by ClassEvents; the counters must
+  // outlive any report
+  void SetCounters(const PerfCounters8 *counters);
+
+  [[nodiscard]] auto Counted() const -> bool { return counters_ != nullptr; }
+  [[nodiscard]] auto ClassEvents(std::size_t opClass) const
+      -> PerfCounters8::Counts;
+
+  [[nodiscard]] auto Executes() const -> const Counts & { return executes_; }
+  [[nodiscard]] auto Reads() const -> const Counts & { return reads_; }
+  [[nodiscard]] auto Writes() const -> const Counts & { return writes_; }
+
+  // opcode classes by count, with hardware events per instruction when
+  // counted, then the hottest addresses
+  void Report(std::ostream &out, std::size_t hottest) const;
+
+  // binary PPM image of the address space, 64 addresses per row, with
+  // writes in red, reads in green and executes in blue on a log scale
+  void HeatMap(std::ostream &out) const;
+
+  // name subroutines in folded stacks from lines of "address name", with
+  // the address in hex; blank lines and lines starting with # are skipped
+  void LoadSymbols(std::istream &in);
+
+  // one line per guest call stack that ran instructions, as
+  // "main;outer;inner weight" for flame graph tools; the weight is that
+  // stack's own share, not including the routines it called
+  void FoldedStacks(std::ostream &out, Weight weight) const;
+
+private:
+  uint64_t total_{0};
+  std::array<uint64_t, classCount> classCounts_{};
+  std::array<Clock::duration, classCount> classTimes_{};
+  Counts executes_{};
+  Counts reads_{};
+  Counts writes_{};
+
+  // last opcode seen at each address, for the report
+  std::array<Instruction, Memory8::memSize> opcodes_{};
+
+  std::size_t current_{0};
+  Clock::time_point start_{};
+
+  const PerfCounters8 *counters_{nullptr};
+  PerfCounters8::Counts counterOverhead_{};
+  PerfCounters8::Counts eventStart_{};
+  std::array<PerfCounters8::Counts, classCount> classEvents_{};
+
+  // guest call tree; node 0 is the top level, and every other node is a
+  // subroutine entry point reached from its parent
+  struct CallNode {
+    Address entry{0};
+    std::size_t parent{0};
+    uint64_t count{0};
+    Clock::duration time{};
+  };
+  std::vector<CallNode> calls_{CallNode{}};
+  std::map<std::pair<std::size_t, Address>, std::size_t> callIndex_{};
+  std::size_t callNode_{0};
+  std::size_t callDepth_{0};
+  std::size_t timedNode_{0};
+  std::map<Address, std::string> symbols_{};
+
+  static void Touch(Counts &counts, Address addr, std::size_t size);
+  void EnterCall(Address entry);
+  void FollowCalls(Instruction opcode, const RegisterSet8 &regs);
+  [[nodiscard]] auto FrameName(std::size_t node) const -> std::string;
+};
+
+#endif /* EMU8_PROFILER_H */
@@ -0,0 +1,92 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_RANDOM_H
+#define EMU8_RANDOM_H
+
+#include <stdexcept>
+
+#include "common.h"
+
+/*
+ * small xorshift64* generator backing the Cxkk instruction; the entire
+ * generator state is a single 64-bit word, so it is cheap to construct,
+ * seed, and save or restore alongside the rest of the machine state
+ */
+class Random8 {
+public:
+  static constexpr uint64_t defaultSeed = 0x8E3779B97F4A7C15;
+
+  explicit Random8(uint64_t seed = defaultSeed) { Seed(seed); }
+
+  // scramble the user seed with one splitmix64 round so that nearby seeds
+  // give unrelated sequences, and so that no seed maps onto the zero state
+  void Seed(uint64_t seed) {
+    constexpr uint64_t increment = 0x9E3779B97F4A7C15;
+    constexpr uint64_t mixA = 0xBF58476D1CE4E5B9;
+    constexpr uint64_t mixB = 0x94D049BB133111EB;
+    constexpr unsigned shiftA = 30;
+    constexpr unsigned shiftB = 27;
+    constexpr unsigned shiftC = 31;
+
+    uint64_t val = seed + increment;
+    val = (val ^ (val >> shiftA)) * mixA;
+    val = (val ^ (val >> shiftB)) * mixB;
+    val ^= (val >> shiftC);
+
+    state_ = (val != 0) ? val : increment;
+  }
+
+  // advance the generator and return the top byte of the scrambled output,
+  // since the high bits of xorshift64* have the best statistical quality
+  auto NextByte() -> Byte { return Advance(state_); }
+
+  // the same step on a bare state word, for callers that keep many
+  // generator states side by side
+  static constexpr auto Advance(uint64_t &state) -> Byte {
+    constexpr unsigned shiftA = 12;
+    constexpr unsigned shiftB = 25;
+    constexpr unsigned shiftC = 27;
+    constexpr unsigned outShift = 56;
+    constexpr uint64_t mult = 0x2545F4914F6CDD1D;
+
+    state ^= state >> shiftA;
+    state ^= state << shiftB;
+    state ^= state >> shiftC;
+
+    return static_cast<Byte>((state * mult) >> outShift);
+  }
+
+  // raw generator state, for saving and restoring reproducible runs
+  [[nodiscard]] auto GetState() const -> uint64_t { return state_; }
+
+  void SetState(uint64_t state) {
+    if (state == 0) {
+      throw std::invalid_argument("Invalid random generator state: 0");
+    }
+    state_ = state;
+  }
+
+private:
+  uint64_t state_ = {defaultSeed};
+};
+
+#endif /* EMU8_RANDOM_H */
@@ -23,10 +23,9 @@
 #define EMU8_REGISTER_SET_H
 
 #include <array>
-#include <atomic>
-#include <stack>
 
 #include "common.h"
+#include "fixed_stack.h"
 
 struct RegisterSet8 {
   static constexpr std::size_t stackSize = 16;
@@ -36,9 +35,8 @@ struct RegisterSet8 {
   Byte regDT = {0x0};
   Address regI = {0x0};
   Address pc = {0x0};
-  std::atomic<bool> audioOn = {false};
   std::array<Byte, regCount> registers = {};
-  std::stack<Address> callStack = {};
+  FixedStack<Address, stackSize> callStack = {};
 };
 
 #endif /* EMU8_REGISTER_SET_H */
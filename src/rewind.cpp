@@ -0,0 +1,257 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+#include "rewind.h"
+
+namespace {
+
+// fixed part of every stored frame, followed by the masked pages and rows
+struct FrameHeader {
+  std::array<Address, RegisterSet8::stackSize> callStack;
+  uint64_t rngState;
+  uint64_t instrTotal;
+  uint64_t frameTotal;
+  uint32_t rowMask;
+  std::array<Byte, RegisterSet8::regCount> registers;
+  Address regI;
+  Address pc;
+  Word keysHeld;
+  Word keysPressed;
+  Word pageMask;
+  Byte stackDepth;
+  Byte regDT;
+  Byte regST;
+};
+
+constexpr std::size_t maxEntrySize =
+    sizeof(FrameHeader) + Memory8::memSize + FrameBuffer8::bufferSize;
+
+static_assert(Rewind8::pageCount <= sizeof(Word) * CHAR_BIT);
+static_assert(Rewind8::rowCount <= sizeof(uint32_t) * CHAR_BIT);
+
+} // namespace
+
+Rewind8::Rewind8(std::size_t maxFrames)
+    : entries_(std::max<std::size_t>(maxFrames, 2)),
+      data_((entries_.size() * frameBudget) + (2 * maxEntrySize)),
+      scratch_(maxEntrySize) {}
+
+void Rewind8::Reset() {
+  first_ = 0;
+  count_ = 0;
+  writePos_ = 0;
+  keyframes_ = 0;
+  sinceKeyframe_ = 0;
+  forceKeyframe_ = true;
+}
+
+auto Rewind8::BytesUsed() const -> std::size_t {
+  std::size_t total = 0;
+  for (std::size_t pos = 0; pos < count_; pos++) {
+    total += entries_[Slot(pos)].size;
+  }
+  return total;
+}
+
+auto Rewind8::Encode(const MachineState8 &state, bool keyframe)
+    -> std::size_t {
+  FrameHeader header = {};
+  header.callStack = state.callStack;
+  header.rngState = state.rngState;
+  header.instrTotal = state.instrTotal;
+  header.frameTotal = state.frameTotal;
+  header.registers = state.registers;
+  header.regI = state.regI;
+  header.pc = state.pc;
+  header.keysHeld = state.keysHeld;
+  header.keysPressed = state.keysPressed;
+  header.stackDepth = state.stackDepth;
+  header.regDT = state.regDT;
+  header.regST = state.regST;
+
+  std::size_t size = sizeof(header);
+  auto *out = scratch_.data();
+
+  for (std::size_t page = 0; page < pageCount; page++) {
+    const auto *curr = state.memory.data() + (page * pageSize);
+    const auto *base = keyState_.memory.data() + (page * pageSize);
+    if (keyframe || std::memcmp(curr, base, pageSize) != 0) {
+      header.pageMask = static_cast<Word>(header.pageMask | (1U << page));
+      std::memcpy(out + size, curr, pageSize);
+      size += pageSize;
+    }
+  }
+
+  for (std::size_t row = 0; row < rowCount; row++) {
+    const auto *curr = state.display.data() + (row * rowSize);
+    const auto *base = keyState_.display.data() + (row * rowSize);
+    if (keyframe || std::memcmp(curr, base, rowSize) != 0) {
+      header.rowMask |= (1U << row);
+      std::memcpy(out + size, curr, rowSize);
+      size += rowSize;
+    }
+  }
+
+  std::memcpy(out, &header, sizeof(header));
+  return size;
+}
+
+void Rewind8::ApplyEntry(const Entry &entry, MachineState8 &state) const {
+  const auto *in = data_.data() + entry.offset;
+
+  FrameHeader header = {};
+  std::memcpy(&header, in, sizeof(header));
+  std::size_t pos = sizeof(header);
+
+  state.callStack = header.callStack;
+  state.rngState = header.rngState;
+  state.instrTotal = header.instrTotal;
+  state.frameTotal = header.frameTotal;
+  state.registers = header.registers;
+  state.regI = header.regI;
+  state.pc = header.pc;
+  state.keysHeld = header.keysHeld;
+  state.keysPressed = header.keysPressed;
+  state.stackDepth = header.stackDepth;
+  state.regDT = header.regDT;
+  state.regST = header.regST;
+
+  for (std::size_t page = 0; page < pageCount; page++) {
+    if (((header.pageMask >> page) & 0x1) != 0) {
+      std::memcpy(state.memory.data() + (page * pageSize), in + pos, pageSize);
+      pos += pageSize;
+    }
+  }
+
+  for (std::size_t row = 0; row < rowCount; row++) {
+    if (((header.rowMask >> row) & 0x1) != 0) {
+      std::memcpy(state.display.data() + (row * rowSize), in + pos, rowSize);
+      pos += rowSize;
+    }
+  }
+}
+
+void Rewind8::DecodeAt(std::size_t pos, MachineState8 &state) const {
+  // the oldest stored frame is always a keyframe, so this walk terminates
+  std::size_t keyPos = pos;
+  while (!entries_[Slot(keyPos)].keyframe) {
+    keyPos--;
+  }
+
+  ApplyEntry(entries_[Slot(keyPos)], state);
+  if (keyPos != pos) {
+    ApplyEntry(entries_[Slot(pos)], state);
+  }
+}
+
+void Rewind8::EvictOldestGroup() {
+  // a keyframe and all the deltas that depend on it go together
+  do {
+    if (entries_[first_].keyframe) {
+      keyframes_--;
+    }
+    first_ = (first_ + 1) % entries_.size();
+    count_--;
+  } while (count_ > 0 && !entries_[first_].keyframe);
+}
+
+auto Rewind8::Reserve(std::size_t size, bool keyframe) -> bool {
+  while (true) {
+    if (count_ == 0) {
+      writePos_ = 0;
+      return true;
+    }
+
+    if (count_ < entries_.size()) {
+      // stored bytes are [oldest, writePos_) unless they wrap past the end
+      const auto oldest = entries_[first_].offset;
+      if (writePos_ > oldest) {
+        if (data_.size() - writePos_ >= size) {
+          return true;
+        }
+        if (oldest >= size) {
+          writePos_ = 0;
+          return true;
+        }
+      } else if (oldest - writePos_ >= size) {
+        return true;
+      }
+    }
+
+    // a delta cannot outlive its keyframe; have the caller store a keyframe
+    if (!keyframe && keyframes_ <= 1) {
+      return false;
+    }
+    EvictOldestGroup();
+  }
+}
+
+void Rewind8::Record(const Machine8 &machine) {
+  machine.SaveState(current_);
+
+  bool keyframe = forceKeyframe_ || (sinceKeyframe_ >= keyframeInterval);
+  auto size = Encode(current_, keyframe);
+  if (!Reserve(size, keyframe)) {
+    keyframe = true;
+    size = Encode(current_, keyframe);
+    Reserve(size, keyframe);
+  }
+
+  std::copy_n(scratch_.begin(), size, data_.begin() + writePos_);
+  entries_[Slot(count_)] = Entry{writePos_, size, keyframe};
+  count_++;
+  writePos_ += size;
+
+  if (keyframe) {
+    keyState_ = current_;
+    keyframes_++;
+    sinceKeyframe_ = 0;
+    forceKeyframe_ = false;
+  } else {
+    sinceKeyframe_++;
+  }
+}
+
+auto Rewind8::StepBack(Machine8 &machine) -> bool {
+  if (count_ < 2) {
+    return false;
+  }
+
+  // drop the newest frame and reclaim its bytes
+  const auto &newest = entries_[Slot(count_ - 1)];
+  if (newest.keyframe) {
+    keyframes_--;
+  }
+  writePos_ = newest.offset;
+  count_--;
+
+  DecodeAt(count_ - 1, current_);
+  machine.LoadState(current_);
+
+  // the next recorded frame starts a fresh group from the restored state
+  forceKeyframe_ = true;
+  return true;
+}
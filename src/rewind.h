@@ -0,0 +1,98 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_REWIND_H
+#define EMU8_REWIND_H
+
+#include <vector>
+
+#include "common.h"
+#include "machine.h"
+#include "machine_state.h"
+
+/*
+ * bounded history of per-frame machine states for stepping time backwards;
+ * every keyframeInterval frames a full state is stored, and in between each
+ * frame keeps only the registers plus the RAM pages and display rows that
+ * differ from the last keyframe; all storage is allocated up front and the
+ * oldest frames are dropped once either the frame or byte budget runs out
+ */
+class Rewind8 {
+public:
+  static constexpr std::size_t pageSize = 0x100;
+  static constexpr std::size_t pageCount = Memory8::memSize / pageSize;
+  static constexpr std::size_t rowSize = FrameBuffer8::rowBytes;
+  static constexpr std::size_t rowCount = FrameBuffer8::fieldHeight;
+  static constexpr std::size_t keyframeInterval = 60;
+
+  // average bytes budgeted per frame when sizing the storage ring
+  static constexpr std::size_t frameBudget = 1024;
+
+  explicit Rewind8(std::size_t maxFrames);
+
+  // append the machine's current state as the newest frame
+  void Record(const Machine8 &machine);
+
+  // drop the newest frame and restore the machine to the one before it;
+  // returns false (leaving the machine alone) once history is exhausted
+  auto StepBack(Machine8 &machine) -> bool;
+
+  // forget all history, e.g. after loading an unrelated save state
+  void Reset();
+
+  [[nodiscard]] auto FrameCount() const -> std::size_t { return count_; }
+  [[nodiscard]] auto BytesUsed() const -> std::size_t;
+  [[nodiscard]] auto Capacity() const -> std::size_t { return data_.size(); }
+
+private:
+  struct Entry {
+    std::size_t offset;
+    std::size_t size;
+    bool keyframe;
+  };
+
+  std::vector<Entry> entries_;
+  std::vector<Byte> data_;
+  std::vector<Byte> scratch_;
+  std::size_t first_ = {0};
+  std::size_t count_ = {0};
+  std::size_t writePos_ = {0};
+  std::size_t keyframes_ = {0};
+  std::size_t sinceKeyframe_ = {0};
+  bool forceKeyframe_ = {true};
+
+  // latest keyframe, for computing deltas, plus working copies
+  MachineState8 keyState_ = {};
+  MachineState8 current_ = {};
+
+  // ring slot of the pos-th stored frame, counting from the oldest
+  [[nodiscard]] auto Slot(std::size_t pos) const -> std::size_t {
+    return (first_ + pos) % entries_.size();
+  }
+
+  auto Encode(const MachineState8 &state, bool keyframe) -> std::size_t;
+  void ApplyEntry(const Entry &entry, MachineState8 &state) const;
+  void DecodeAt(std::size_t pos, MachineState8 &state) const;
+  auto Reserve(std::size_t size, bool keyframe) -> bool;
+  void EvictOldestGroup();
+};
+
+#endif /* EMU8_REWIND_H */
@@ -0,0 +1,363 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "instruction_set.h"
+#include "rom_bench.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Seconds = std::chrono::duration<double>;
+
+// opcodes kept for timing the decoder; longer runs decode a prefix of the
+// trace and scale the result
+constexpr std::size_t traceLimit = std::size_t{1} << 22;
+
+constexpr std::size_t medianPercent = 50;
+constexpr std::size_t tailPercent = 99;
+
+constexpr Instruction classMask = 0xF000;
+constexpr Instruction drawClass = 0xD000;
+
+// the key mask for each frame, the same on every run with the same config
+class Input {
+public:
+  explicit Input(const rombench8::Config &config)
+      : movie_(config.movie), script_(~config.seed) {}
+
+  auto Next(uint64_t frame) -> Word {
+    if (movie_ != nullptr) {
+      return (frame < movie_->FrameCount()) ? movie_->KeyMask(frame) : 0x0;
+    }
+
+    // hold one key, or none, for a few frames at a time
+    constexpr Byte pressBit = 0x10;
+    if (frame % rombench8::holdFrames == 0) {
+      const auto roll = script_.NextByte();
+      held_ = ((roll & pressBit) != 0)
+                  ? static_cast<Word>(1U << (roll & Keypad8::keyMax))
+                  : Word{0x0};
+    }
+    return held_;
+  }
+
+private:
+  const movie8::Movie *movie_;
+  Random8 script_;
+  Word held_{0x0};
+};
+
+auto Fault(const std::exception &err, uint64_t frame) -> std::runtime_error {
+  return std::runtime_error(std::string(err.what()) + " at frame " +
+                            std::to_string(frame));
+}
+
+// cost of a clock read, about what the timing itself adds to each of the
+// many short draw timings
+auto ClockOverhead() -> double {
+  constexpr int reads = 1000;
+  const auto start = Clock::now();
+  auto last = start;
+  for (int count = 0; count < reads; count++) {
+    last = Clock::now();
+  }
+  return Seconds(last - start).count() / reads;
+}
+
+auto Percentile(std::vector<double> &values, std::size_t percent) -> double {
+  constexpr std::size_t hundred = 100;
+  if (values.empty()) {
+    return 0.0;
+  }
+
+  const auto rank = std::min(values.size() - 1, values.size() * percent /
+                                                    hundred);
+  std::nth_element(values.begin(),
+                   values.begin() + static_cast<std::ptrdiff_t>(rank),
+                   values.end());
+  return values[rank];
+}
+
+// hardware events per emulated instruction, overall and for each opcode
+// class that ran, most frequent first
+void PrintEvents(std::ostream &out, const rombench8::Report &report) {
+  constexpr int nameWidth = 9;
+  constexpr int countWidth = 14;
+  constexpr int eventWidth = 18;
+  constexpr std::size_t eventCount = PerfCounters8::eventCount;
+
+  const auto perOp = [&report](uint64_t events, uint64_t count,
+                               std::size_t event) -> std::string {
+    if (!report.available.at(event)) {
+      return "n/a";
+    }
+    std::ostringstream value;
+    value << std::fixed << std::setprecision(2)
+          << static_cast<double>(events) /
+                 static_cast<double>(std::max<uint64_t>(count, 1));
+    return value.str();
+  };
+
+  out << "\nhardware events per instruction:\n";
+  for (std::size_t event = 0; event < eventCount; event++) {
+    out << "  " << std::left << std::setw(eventWidth)
+        << PerfCounters8::EventName(static_cast<PerfCounters8::Event>(event))
+        << std::right
+        << perOp(report.events.at(event), report.instructions, event)
+        << '\n';
+  }
+  const auto cycles = report.events[PerfCounters8::cycles];
+  if (cycles > 0) {
+    out << "  " << std::left << std::setw(eventWidth) << "IPC" << std::right
+        << static_cast<double>(report.events[PerfCounters8::instructions]) /
+               static_cast<double>(cycles)
+        << '\n';
+  }
+
+  std::vector<std::size_t> classes(Profiler8::classCount);
+  std::iota(classes.begin(), classes.end(), 0);
+  std::stable_sort(classes.begin(), classes.end(),
+                   [&report](auto lhs, auto rhs) {
+                     return report.classInstructions.at(lhs) >
+                            report.classInstructions.at(rhs);
+                   });
+
+  out << '\n' << std::left << std::setw(nameWidth) << "class" << std::right
+      << std::setw(countWidth) << "count";
+  for (std::size_t event = 0; event < eventCount; event++) {
+    out << std::setw(eventWidth)
+        << std::string(PerfCounters8::EventName(
+               static_cast<PerfCounters8::Event>(event))) +
+               "/op";
+  }
+  out << '\n';
+  for (const auto opClass : classes) {
+    const auto count = report.classInstructions.at(opClass);
+    if (count == 0) {
+      break;
+    }
+
+    out << std::left << std::setw(nameWidth) << Profiler8::ClassName(opClass)
+        << std::right << std::setw(countWidth) << count;
+    for (std::size_t event = 0; event < eventCount; event++) {
+      out << std::setw(eventWidth)
+          << perOp(report.classEvents.at(opClass).at(event), count, event);
+    }
+    out << '\n';
+  }
+}
+
+} // namespace
+
+auto rombench8::Run(std::span<const Byte> rom, const Config &config)
+    -> Report {
+  Report report;
+  report.frames = config.frames;
+
+  // timed run, as the frontend would do it but without waiting for ticks
+  Machine8 machine(config.memBase, config.ipt, config.seed);
+  machine.LoadProgram(rom);
+
+  std::vector<double> frameTimes(config.frames);
+  Input input(config);
+  double emulation = 0.0;
+  for (uint64_t frame = 0; frame < config.frames; frame++) {
+    const auto keyMask = input.Next(frame);
+    const auto start = Clock::now();
+    try {
+      machine.RunFrame(keyMask);
+    } catch (const std::exception &err) {
+      throw Fault(err, frame);
+    }
+    const auto ran = Clock::now();
+
+    auto &display = machine.Display();
+    if (config.present && display.Dirty()) {
+      config.present(display.Data());
+      display.ClearDirty();
+    }
+    const auto end = Clock::now();
+
+    emulation += Seconds(ran - start).count();
+    report.present += Seconds(end - ran).count();
+    frameTimes[frame] = Seconds(end - start).count();
+  }
+
+  report.instructions = machine.InstructionCount();
+  report.seconds = emulation + report.present;
+  report.frameP50 = Percentile(frameTimes, medianPercent);
+  report.frameP99 = Percentile(frameTimes, tailPercent);
+  report.stateHash = machine.StateHash();
+
+  // the same run again, one instruction at a time, timing each draw and
+  // keeping the opcodes to time the decoder on afterwards
+  Machine8 replay(config.memBase, config.ipt, config.seed);
+  replay.LoadProgram(rom);
+
+  std::vector<Instruction> trace;
+  trace.reserve(std::min<uint64_t>(traceLimit, config.frames * config.ipt));
+  Input replayInput(config);
+  uint64_t draws = 0;
+  for (uint64_t frame = 0; frame < config.frames; frame++) {
+    replay.Keys().SetState(replayInput.Next(frame));
+    for (std::size_t count = 0; count < config.ipt; count++) {
+      const auto opcode =
+          replay.Memory().fetchInstruction(replay.Registers().pc);
+      if (trace.size() < traceLimit) {
+        trace.push_back(opcode);
+      }
+
+      if ((opcode & classMask) == drawClass) {
+        const auto start = Clock::now();
+        replay.Step();
+        report.draw += Seconds(Clock::now() - start).count();
+        draws++;
+      } else {
+        replay.Step();
+      }
+    }
+    replay.EndFrame();
+  }
+
+  if (replay.StateHash() != report.stateHash) {
+    throw std::logic_error("Benchmark replay diverged from the timed run");
+  }
+  report.draw = std::max(0.0, report.draw -
+                                  static_cast<double>(draws) * ClockOverhead());
+
+  std::size_t decoded = 0;
+  const auto start = Clock::now();
+  for (const auto opcode : trace) {
+    decoded += (InstructionSet8::Decode(opcode) != nullptr) ? 1 : 0;
+  }
+  const auto decodeTime = Seconds(Clock::now() - start).count();
+  if (decoded != trace.size()) {
+    throw std::logic_error("Benchmark decoded an invalid opcode");
+  }
+
+  if (!trace.empty()) {
+    report.decode = decodeTime * static_cast<double>(report.instructions) /
+                    static_cast<double>(trace.size());
+  }
+  report.execute = std::max(0.0, emulation - report.decode - report.draw);
+
+  if (config.counters != nullptr) {
+    Machine8 counted(config.memBase, config.ipt, config.seed);
+    counted.LoadProgram(rom);
+
+    Input countedInput(config);
+    const auto before = config.counters->Read();
+    for (uint64_t frame = 0; frame < config.frames; frame++) {
+      counted.RunFrame(countedInput.Next(frame));
+    }
+    report.events =
+        PerfCounters8::Difference(config.counters->Read(), before);
+    report.counted = true;
+    for (std::size_t event = 0; event < PerfCounters8::eventCount; event++) {
+      report.available.at(event) = config.counters->Available(
+          static_cast<PerfCounters8::Event>(event));
+    }
+  }
+
+  // the events per opcode class come from the profiled run, so one is made
+  // up when the caller did not ask for a profile
+  std::unique_ptr<Profiler8> ownProfiler;
+  auto *profiler = config.profiler;
+  if (profiler == nullptr && config.counters != nullptr) {
+    ownProfiler = std::make_unique<Profiler8>();
+    profiler = ownProfiler.get();
+  }
+
+  if (profiler != nullptr) {
+    if (config.counters != nullptr) {
+      profiler->SetCounters(config.counters);
+    }
+
+    Machine8 profiled(config.memBase, config.ipt, config.seed);
+    profiled.LoadProgram(rom);
+    profiled.SetProfiler(profiler);
+
+    Input profiledInput(config);
+    for (uint64_t frame = 0; frame < config.frames; frame++) {
+      profiled.RunFrame(profiledInput.Next(frame));
+    }
+
+    if (config.counters != nullptr) {
+      for (std::size_t opClass = 0; opClass < Profiler8::classCount;
+           opClass++) {
+        report.classInstructions.at(opClass) = profiler->ClassCount(opClass);
+        report.classEvents.at(opClass) = profiler->ClassEvents(opClass);
+      }
+    }
+  }
+
+  return report;
+}
+
+void rombench8::Print(std::ostream &out, const Report &report) {
+  constexpr double mega = 1.0e6;
+  constexpr double milli = 1.0e3;
+  constexpr double micro = 1.0e6;
+  constexpr double percent = 100.0;
+  constexpr double realFps = 60.0;
+  constexpr int width = 9;
+
+  const double seconds = std::max(report.seconds, 1.0e-9);
+  const double fps = static_cast<double>(report.frames) / seconds;
+  const auto phase = [&](const char *name, double time) {
+    out << std::left << std::setw(width) << name << std::right
+        << std::setw(width) << time * milli << " ms  " << std::setw(width - 3)
+        << percent * time / seconds << "%\n";
+  };
+
+  out << std::fixed << std::setprecision(2) << "frames: " << report.frames
+      << '\n'
+      << "instructions: " << report.instructions << '\n'
+      << "seconds: " << std::setprecision(4) << report.seconds << '\n'
+      << std::setprecision(2) << "MIPS: "
+      << static_cast<double>(report.instructions) / seconds / mega << '\n'
+      << "frames per second: " << fps << " (" << fps / realFps
+      << "x real time)\n"
+      << "frame time p50: " << report.frameP50 * micro << " us\n"
+      << "frame time p99: " << report.frameP99 * micro << " us\n";
+
+  phase("decode", report.decode);
+  phase("execute", report.execute);
+  phase("draw", report.draw);
+  phase("present", report.present);
+
+  out << "state hash: " << std::hex << std::setw(16) << std::setfill('0')
+      << report.stateHash << std::dec << std::setfill(' ') << '\n';
+
+  if (report.counted) {
+    PrintEvents(out, report);
+  }
+}
@@ -0,0 +1,101 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_ROM_BENCH_H
+#define EMU8_ROM_BENCH_H
+
+#include <array>
+#include <functional>
+#include <ostream>
+#include <span>
+
+#include "common.h"
+#include "machine.h"
+#include "memory.h"
+#include "movie.h"
+#include "perf_counters.h"
+#include "profiler.h"
+#include "random.h"
+
+/*
+ * end-to-end benchmark of a ROM: a fixed number of frames run headless and
+ * unthrottled with deterministic input, timed as a whole and per frame, then
+ * run again to split the time between decoding, executing, and drawing
+ */
+namespace rombench8 {
+
+// frames each scripted key (or no key) is held for
+constexpr std::size_t holdFrames = 8;
+
+// host work done for a frame that changed the display, e.g. expanding it
+// into texels; timed as the present phase
+using Presenter = std::function<void(std::span<const Byte>)>;
+
+struct Config {
+  std::size_t memBase{Memory8::loadAddrDefault};
+  std::size_t ipt{Machine8::iptDefault};
+  uint64_t seed{Random8::defaultSeed};
+  uint64_t frames{0};
+
+  // input to replay, with no keys held once it ends; without a movie the
+  // keys come from a fixed script drawn from the seed
+  const movie8::Movie *movie{nullptr};
+
+  Presenter present{};
+
+  // when set, a final untimed run is profiled into it
+  Profiler8 *profiler{nullptr};
+
+  // when set, untimed runs count hardware events, once for the whole run
+  // and once per instruction to split them by opcode class
+  const PerfCounters8 *counters{nullptr};
+};
+
+// all times in seconds
+struct Report {
+  uint64_t frames{0};
+  uint64_t instructions{0};
+  double seconds{0.0};
+  double frameP50{0.0};
+  double frameP99{0.0};
+  double decode{0.0};
+  double execute{0.0};
+  double draw{0.0};
+  double present{0.0};
+  uint64_t stateHash{0};
+
+  // hardware events, when counters were given; the totals come from a run
+  // that reads the counters only at its ends
+  bool counted{false};
+  std::array<bool, PerfCounters8::eventCount> available{};
+  PerfCounters8::Counts events{};
+  std::array<uint64_t, Profiler8::classCount> classInstructions{};
+  std::array<PerfCounters8::Counts, Profiler8::classCount> classEvents{};
+};
+
+// throws if the program faults, naming the frame
+auto Run(std::span<const Byte> rom, const Config &config) -> Report;
+
+void Print(std::ostream &out, const Report &report);
+
+} // namespace rombench8
+
+#endif /* EMU8_ROM_BENCH_H */
@@ -0,0 +1,84 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_RUN_AHEAD_H
+#define EMU8_RUN_AHEAD_H
+
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+
+#include "common.h"
+#include "frame_buffer.h"
+#include "machine.h"
+#include "machine_state.h"
+
+/*
+ * run-ahead: many programs only act on input a few frames after reading it,
+ * so the frame shown is computed that many frames into the future with the
+ * current keys held, and the machine is then put back where it was; the
+ * hidden lag disappears at the cost of re-running a few frames per tick
+ */
+class RunAhead8 {
+public:
+  // more than this only shows mispredictions, not less lag
+  static constexpr std::size_t maxFrames = 8;
+
+  explicit RunAhead8(std::size_t frames) : frames_(frames) {}
+
+  // run the configured number of frames ahead of the machine with keyMask
+  // held, and return the display from then; the machine itself is left
+  // exactly as it was. The frames run here never really happen, so they are
+  // kept out of any attached profile or trace, and a fault in them only
+  // means the guess was wrong: the present display is shown instead
+  auto Preview(Machine8 &machine, Word keyMask) -> std::span<const Byte> {
+    auto *profiler = machine.Profiler();
+    auto *trace = machine.Trace();
+    machine.SetProfiler(nullptr);
+    machine.SetTrace(nullptr);
+
+    machine.SaveState(saved_);
+    try {
+      for (std::size_t frame = 0; frame < frames_; frame++) {
+        machine.RunFrame(keyMask);
+      }
+    } catch (const std::exception & /*err*/) {
+      machine.LoadState(saved_);
+    }
+
+    const auto future = machine.Display().Data();
+    std::copy(future.begin(), future.end(), display_.begin());
+
+    machine.LoadState(saved_);
+    machine.SetProfiler(profiler);
+    machine.SetTrace(trace);
+    return display_;
+  }
+
+  [[nodiscard]] auto Frames() const -> std::size_t { return frames_; }
+
+private:
+  std::size_t frames_;
+  MachineState8 saved_ = {};
+  FrameBuffer8::Buffer display_ = {};
+};
+
+#endif /* EMU8_RUN_AHEAD_H */
@@ -0,0 +1,196 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tuple>
+#include <unistd.h>
+
+#include "byte_stream.h"
+#include "save_state.h"
+
+namespace {
+
+[[noreturn]] void ReportFileError(const std::string &msg,
+                                  const std::string &path) {
+  throw std::runtime_error(msg + path + ": " + std::strerror(errno));
+}
+
+// read-only private mapping of a whole file, released on scope exit
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &path) {
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC); // NOLINT
+    if (fd_ < 0) {
+      ReportFileError("Could not open save state ", path);
+    }
+
+    struct stat info = {};
+    if (::fstat(fd_, &info) < 0) {
+      ::close(fd_);
+      ReportFileError("Could not stat save state ", path);
+    }
+
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ == 0) {
+      ::close(fd_);
+      throw std::runtime_error("Save state is empty: " + path);
+    }
+
+    addr_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (addr_ == MAP_FAILED) { // NOLINT
+      ::close(fd_);
+      ReportFileError("Could not map save state ", path);
+    }
+  }
+
+  ~MappedFile() {
+    ::munmap(addr_, size_);
+    ::close(fd_);
+  }
+
+  MappedFile(const MappedFile &other) = delete;
+  MappedFile(MappedFile &&other) = delete;
+  auto operator=(const MappedFile &other) -> MappedFile & = delete;
+  auto operator=(MappedFile &&other) -> MappedFile & = delete;
+
+  [[nodiscard]] auto Bytes() const -> std::span<const Byte> {
+    return {static_cast<const Byte *>(addr_), size_};
+  }
+
+private:
+  int fd_ = {-1};
+  void *addr_ = {nullptr};
+  std::size_t size_ = {0};
+};
+
+} // namespace
+
+void state8::Serialize(const MachineState8 &state, std::vector<Byte> &buf) {
+  buf.clear();
+  buf.reserve(fileSize);
+
+  ByteWriter writer(buf);
+  std::copy(fileMagic.begin(), fileMagic.end(), std::back_inserter(buf));
+  writer.Put<uint16_t>(formatVersion);
+  writer.Put<uint16_t>(0);
+  writer.Put<uint32_t>(payloadSize);
+
+  writer.PutRange<Byte>(state.memory);
+  writer.PutRange<Byte>(state.registers);
+  writer.PutRange<Address>(state.callStack);
+  writer.Put<Byte>(state.stackDepth);
+  writer.Put<Byte>(state.regDT);
+  writer.Put<Byte>(state.regST);
+  writer.Put<Byte>(0);
+  writer.Put<Address>(state.regI);
+  writer.Put<Address>(state.pc);
+  writer.Put<uint64_t>(state.rngState);
+  writer.PutRange<Byte>(state.display);
+  writer.Put<Word>(state.keysHeld);
+  writer.Put<Word>(state.keysPressed);
+  writer.Put<uint64_t>(state.instrTotal);
+  writer.Put<uint64_t>(state.frameTotal);
+}
+
+void state8::Deserialize(std::span<const Byte> image, MachineState8 &state) {
+  ByteReader reader(image, "Save state");
+
+  const auto magic = reader.Take(fileMagic.size());
+  if (!std::equal(magic.begin(), magic.end(), fileMagic.begin())) {
+    throw std::runtime_error("Not an emu8 save state");
+  }
+
+  const auto version = reader.Get<uint16_t>();
+  if (version != formatVersion) {
+    throw std::runtime_error("Unsupported save state version " +
+                             std::to_string(version));
+  }
+
+  std::ignore = reader.Get<uint16_t>();
+  if (reader.Get<uint32_t>() != payloadSize) {
+    throw std::runtime_error("Save state payload size mismatch");
+  }
+
+  // the RAM image is the bulk of the payload, so copy it in one go
+  const auto ram = reader.Take(state.memory.size());
+  std::copy(ram.begin(), ram.end(), state.memory.begin());
+
+  reader.GetRange<Byte>(state.registers);
+  reader.GetRange<Address>(state.callStack);
+  state.stackDepth = reader.Get<Byte>();
+  state.regDT = reader.Get<Byte>();
+  state.regST = reader.Get<Byte>();
+  std::ignore = reader.Get<Byte>();
+  state.regI = reader.Get<Address>();
+  state.pc = reader.Get<Address>();
+  state.rngState = reader.Get<uint64_t>();
+
+  const auto pixels = reader.Take(state.display.size());
+  std::copy(pixels.begin(), pixels.end(), state.display.begin());
+
+  state.keysHeld = reader.Get<Word>();
+  state.keysPressed = reader.Get<Word>();
+  state.instrTotal = reader.Get<uint64_t>();
+  state.frameTotal = reader.Get<uint64_t>();
+}
+
+void state8::SaveFile(const Machine8 &machine, const std::string &path) {
+  MachineState8 state;
+  machine.SaveState(state);
+
+  std::vector<Byte> buf;
+  Serialize(state, buf);
+
+  // write to a temporary name first so a failed save never clobbers a good one
+  const std::string tmpPath = path + ".tmp";
+  std::ofstream stateFile(tmpPath, std::ios::binary | std::ios::trunc);
+  if (!stateFile.good()) {
+    throw std::runtime_error("Could not create save state: " + tmpPath);
+  }
+
+  stateFile.write(reinterpret_cast<const char *>(buf.data()), // NOLINT
+                  static_cast<std::streamsize>(buf.size()));
+  stateFile.close();
+  if (stateFile.fail()) {
+    throw std::runtime_error("Could not write save state: " + tmpPath);
+  }
+
+  if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    ReportFileError("Could not replace save state ", path);
+  }
+}
+
+void state8::LoadFile(Machine8 &machine, const std::string &path) {
+  const MappedFile mapping(path);
+
+  MachineState8 state;
+  Deserialize(mapping.Bytes(), state);
+  machine.LoadState(state);
+}
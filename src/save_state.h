@@ -0,0 +1,86 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_SAVE_STATE_H
+#define EMU8_SAVE_STATE_H
+
+#include <array>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "machine.h"
+#include "machine_state.h"
+
+/*
+ * binary save state format, all multi-byte fields little-endian:
+ *
+ *   offset  size  field
+ *        0     8  magic "EMU8STAT"
+ *        8     2  format version
+ *       10     2  reserved, zero
+ *       12     4  payload size in bytes
+ *       16  4096  RAM
+ *     4112    16  registers V0-VF
+ *     4128    32  call stack, 16 addresses, bottom first
+ *     4160     1  call stack depth
+ *     4161     1  delay timer
+ *     4162     1  sound timer
+ *     4163     1  reserved, zero
+ *     4164     2  register I
+ *     4166     2  program counter
+ *     4168     8  random generator state
+ *     4176   256  display, bit-packed rows (see FrameBuffer8)
+ *     4432     2  held key mask
+ *     4434     2  latched key mask
+ *     4436     8  instructions executed
+ *     4444     8  frames executed
+ *
+ * readers reject a different version or payload size outright, so any layout
+ * change must bump the version
+ */
+namespace state8 {
+
+constexpr std::array<char, 8> fileMagic = {'E', 'M', 'U', '8',
+                                           'S', 'T', 'A', 'T'};
+constexpr uint16_t formatVersion = 1;
+constexpr std::size_t headerSize = 16;
+constexpr std::size_t payloadSize = 4436;
+constexpr std::size_t fileSize = headerSize + payloadSize;
+
+// encode a machine state into buf, replacing its contents
+void Serialize(const MachineState8 &state, std::vector<Byte> &buf);
+
+// decode a machine state, throwing std::runtime_error if the image is
+// truncated, has the wrong magic number, or uses another format version
+void Deserialize(std::span<const Byte> image, MachineState8 &state);
+
+// write the machine's full state to a file
+void SaveFile(const Machine8 &machine, const std::string &path);
+
+// restore the machine from a state file; the file is mapped rather than read,
+// so the state is decoded straight out of the page cache
+void LoadFile(Machine8 &machine, const std::string &path);
+
+} // namespace state8
+
+#endif /* EMU8_SAVE_STATE_H */
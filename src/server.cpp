@@ -0,0 +1,336 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "save_state.h"
+#include "server.h"
+
+namespace {
+
+// session ids carry a generation count above the slot number, so that an id
+// kept after its session closed never reaches the slot's next session
+constexpr unsigned slotBits = 20;
+constexpr uint32_t slotMask = (1U << slotBits) - 1;
+
+// offset of the status byte in a response, counting the length field
+constexpr std::size_t statusOffset = server8::lengthSize + 1;
+
+// a request that cannot be carried out, answered with this status
+class RequestError : public std::runtime_error {
+public:
+  RequestError(server8::Status status, const std::string &what)
+      : std::runtime_error(what), status_(status) {}
+
+  [[nodiscard]] auto GetStatus() const -> server8::Status { return status_; }
+
+private:
+  server8::Status status_;
+};
+
+} // namespace
+
+server8::Server::Server(std::size_t sessions, std::size_t memBase,
+                        std::size_t ipt, bool hugePages)
+    : memBase_(memBase), ipt_(ipt),
+      pool_(sessions, memBase, ipt, Random8::defaultSeed, hugePages),
+      sessions_(pool_.Size()), freeSessions_(pool_.Size()) {
+  if (pool_.Size() > slotMask + 1) {
+    throw std::invalid_argument("Too many sessions: " +
+                                std::to_string(pool_.Size()));
+  }
+
+  // hand out low slots first
+  for (std::size_t slot = 0; slot < pool_.Size(); slot++) {
+    freeSessions_[slot] = static_cast<uint32_t>(pool_.Size() - 1 - slot);
+  }
+}
+
+auto server8::Server::AddRom(std::span<const Byte> rom) -> uint32_t {
+  if (rom.empty() || rom.size() > Memory8::memSize - memBase_) {
+    throw std::invalid_argument("ROM of " + std::to_string(rom.size()) +
+                                " bytes does not fit in memory");
+  }
+
+  // the power-on state with the ROM loaded, which sessions start from
+  Rom entry;
+  entry.image.assign(rom.begin(), rom.end());
+  Machine8 fresh(memBase_, ipt_);
+  fresh.LoadProgram(rom);
+  fresh.SaveState(entry.initial);
+
+  roms_.push_back(std::move(entry));
+  return static_cast<uint32_t>(roms_.size() - 1);
+}
+
+auto server8::Server::IsOpen(uint32_t id) const -> bool {
+  const auto slot = id & slotMask;
+  return slot < sessions_.size() && sessions_[slot].open &&
+         sessions_[slot].generation == (id >> slotBits);
+}
+
+auto server8::Server::FindSession(uint32_t id) -> Session * {
+  if (!IsOpen(id)) {
+    throw RequestError(Status::notFound,
+                       "No such session: " + std::to_string(id));
+  }
+  return &sessions_[id & slotMask];
+}
+
+void server8::Server::CloseSession(std::size_t slot) {
+  auto &session = sessions_[slot];
+  session.open = false;
+  session.snapshots.clear();
+  freeSessions_.push_back(static_cast<uint32_t>(slot));
+}
+
+void server8::Server::Disconnect(Connection &connection) {
+  // ids another connection already closed fail the generation check, so a
+  // slot that has been handed out again is left alone
+  for (const auto id : connection.sessions) {
+    if (IsOpen(id)) {
+      CloseSession(id & slotMask);
+    }
+  }
+  connection.sessions.clear();
+}
+
+auto server8::Server::Process(std::span<const Byte> input,
+                              std::vector<Byte> &output,
+                              Connection &connection) -> std::size_t {
+  std::size_t consumed = 0;
+  while (input.size() - consumed >= lengthSize) {
+    ByteReader header(input.subspan(consumed, lengthSize), "Length");
+    const auto length = header.Get<uint32_t>();
+    if (length > maxMessage) {
+      throw std::runtime_error("Message of " + std::to_string(length) +
+                               " bytes is too long");
+    }
+    if (input.size() - consumed - lengthSize < length) {
+      break;
+    }
+
+    ByteReader body(input.subspan(consumed + lengthSize, length), "Request");
+    consumed += lengthSize + length;
+
+    // the response header, with the length and status filled in at the end
+    const auto start = output.size();
+    ByteWriter result(output);
+    Byte op = 0;
+    uint32_t tag = 0;
+    Status status = Status::badRequest;
+    try {
+      op = body.Get<Byte>();
+      tag = body.Get<uint32_t>();
+    } catch (const std::exception & /*err*/) {
+      // too short to hold a header; answered with op and tag zero
+    }
+
+    result.Put<uint32_t>(0);
+    result.Put<Byte>(op);
+    result.Put<Byte>(0);
+    result.Put<uint32_t>(tag);
+    const auto resultStart = output.size();
+
+    std::string error = "Request too short";
+    if (length >= sizeof(op) + sizeof(tag)) {
+      try {
+        status = Handle(static_cast<Op>(op), body, result, connection);
+      } catch (const RequestError &err) {
+        status = err.GetStatus();
+        error = err.what();
+      } catch (const std::exception &err) {
+        status = Status::badRequest;
+        error = err.what();
+      }
+    }
+
+    if (status != Status::ok) {
+      output.resize(resultStart);
+      result.PutRange(std::span<const Byte>{
+          reinterpret_cast<const Byte *>(error.data()), // NOLINT
+          error.size()});
+    }
+
+    output[start + statusOffset] = static_cast<Byte>(status);
+    const auto size = static_cast<uint32_t>(output.size() - start - lengthSize);
+    for (std::size_t idx = 0; idx < lengthSize; idx++) {
+      output[start + idx] = static_cast<Byte>(size >> (CHAR_BIT * idx));
+    }
+  }
+
+  return consumed;
+}
+
+auto server8::Server::Handle(Op op, ByteReader &args, ByteWriter &result,
+                             Connection &connection) -> Status {
+  switch (op) {
+  case Op::addRom:
+    result.Put<uint32_t>(AddRom(args.Take(args.Remaining())));
+    return Status::ok;
+
+  case Op::create:
+    return Create(args, result, connection);
+
+  case Op::close:
+  case Op::step:
+  case Op::display:
+  case Op::getState:
+  case Op::setState:
+  case Op::snapshot:
+  case Op::restore:
+  case Op::drop:
+    break;
+
+  default:
+    throw RequestError(Status::badRequest,
+                       "Unknown op: " + std::to_string(static_cast<int>(op)));
+  }
+
+  // the rest act on one session
+  const auto id = args.Get<uint32_t>();
+  auto &session = *FindSession(id);
+  const auto slot = static_cast<std::size_t>(&session - sessions_.data());
+  auto &machine = pool_.At(slot);
+  MachineState8 state;
+
+  switch (op) {
+  case Op::close:
+    CloseSession(slot);
+    std::erase(connection.sessions, id);
+    break;
+
+  case Op::step:
+    return Step(session, machine, args, result);
+
+  case Op::display:
+    result.PutRange(machine.Display().Data());
+    break;
+
+  case Op::getState:
+    machine.SaveState(state);
+    state8::Serialize(state, scratch_);
+    result.PutRange(std::span<const Byte>{scratch_});
+    break;
+
+  case Op::setState:
+    state8::Deserialize(args.Take(args.Remaining()), state);
+    machine.LoadState(state);
+    session.faulted = false;
+    break;
+
+  case Op::snapshot:
+    if (session.snapshots.size() >= maxSnapshots) {
+      throw RequestError(Status::full, "Too many snapshots in session");
+    }
+    machine.SaveState(session.snapshots[session.nextSnapshot]);
+    result.Put<uint32_t>(session.nextSnapshot++);
+    break;
+
+  case Op::restore: {
+    const auto found = session.snapshots.find(args.Get<uint32_t>());
+    if (found == session.snapshots.end()) {
+      throw RequestError(Status::notFound, "No such snapshot");
+    }
+    machine.LoadState(found->second);
+    session.faulted = false;
+    break;
+  }
+
+  case Op::drop:
+    if (session.snapshots.erase(args.Get<uint32_t>()) == 0) {
+      throw RequestError(Status::notFound, "No such snapshot");
+    }
+    break;
+
+  case Op::addRom:
+  case Op::create:
+  default:
+    break;
+  }
+
+  return Status::ok;
+}
+
+auto server8::Server::Create(ByteReader &args, ByteWriter &result,
+                             Connection &connection) -> Status {
+  const auto rom = args.Get<uint32_t>();
+  const auto seed = args.Get<uint64_t>();
+  if (rom >= roms_.size()) {
+    throw RequestError(Status::notFound, "No such ROM: " + std::to_string(rom));
+  }
+  if (freeSessions_.empty()) {
+    throw RequestError(Status::full, "All sessions are in use");
+  }
+
+  // a warm machine from the pool, reset to the ROM's power-on state
+  const auto slot = freeSessions_.back();
+  freeSessions_.pop_back();
+  auto &machine = pool_.At(slot);
+  machine.LoadState(roms_[rom].initial);
+  machine.Instructions().Rng().Seed(seed);
+
+  auto &session = sessions_[slot];
+  session.generation = (session.generation + 1) & (UINT32_MAX >> slotBits);
+  session.rom = rom;
+  session.open = true;
+  session.faulted = false;
+  session.nextSnapshot = 0;
+
+  // sessions closed from another connection are forgotten here, so the list
+  // never outgrows the pool
+  const auto id = (session.generation << slotBits) | slot;
+  std::erase_if(connection.sessions,
+                [this](uint32_t owned) { return !IsOpen(owned); });
+  connection.sessions.push_back(id);
+
+  result.Put<uint32_t>(id);
+  return Status::ok;
+}
+
+auto server8::Server::Step(Session &session, Machine8 &machine,
+                           ByteReader &args, ByteWriter &result) -> Status {
+  const auto keyMask = args.Get<Word>();
+  const auto frames = args.Get<uint32_t>();
+  if (frames > maxStepFrames) {
+    throw RequestError(Status::badRequest,
+                       "Too many frames: " + std::to_string(frames));
+  }
+  if (session.faulted) {
+    throw RequestError(Status::fault, "Session is stopped after a fault");
+  }
+
+  try {
+    for (uint32_t frame = 0; frame < frames; frame++) {
+      machine.RunFrame(keyMask);
+    }
+  } catch (const std::exception &err) {
+    session.faulted = true;
+    throw RequestError(Status::fault, err.what());
+  }
+
+  result.Put<uint64_t>(machine.FrameCount());
+  result.Put<Byte>((machine.Registers().regST > 0) ? 1 : 0);
+  return Status::ok;
+}
@@ -0,0 +1,165 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_SERVER_H
+#define EMU8_SERVER_H
+
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "byte_stream.h"
+#include "common.h"
+#include "machine.h"
+#include "machine_pool.h"
+#include "machine_state.h"
+#include "memory.h"
+
+/*
+ * request handling for the emu8d server, kept apart from the sockets so that
+ * it can be driven from a buffer; sessions are machines from a MachinePool8
+ * built at startup, and ROMs are loaded once and reused by every session
+ *
+ * the protocol is a stream of messages, each a 32-bit length followed by
+ * that many bytes of body, all fields little-endian:
+ *
+ *   request body:  u8 op, u32 tag, arguments
+ *   response body: u8 op, u8 status, u32 tag, result (or an error message)
+ *
+ *   op            arguments                     result
+ *   0x01 addRom   ROM image                     u32 rom
+ *   0x02 create   u32 rom, u64 seed             u32 session
+ *   0x03 close    u32 session                   -
+ *   0x04 step     u32 session, u16 keys,        u64 frame, u8 sound
+ *                 u32 frames
+ *   0x05 display  u32 session                   256 bytes, as FrameBuffer8
+ *   0x06 getState u32 session                   save state image
+ *   0x07 setState u32 session, state image      -
+ *   0x08 snapshot u32 session                   u32 snapshot
+ *   0x09 restore  u32 session, u32 snapshot     -
+ *   0x0A drop     u32 session, u32 snapshot     -
+ *
+ * requests are answered strictly in order, so clients may pipeline any
+ * number of them and match responses by position or by the tag they chose;
+ * a session that faults stops until it is restored or given a new state
+ *
+ * snapshots belong to the session that took them, are numbered within it,
+ * and are freed when it closes; one step runs at most maxStepFrames frames,
+ * so that no request holds up the others for long
+ *
+ * each session is also recorded against the connection that created it, and
+ * whatever that connection leaves open is closed when it goes away
+ */
+namespace server8 {
+
+enum class Op : Byte {
+  addRom = 0x01,
+  create = 0x02,
+  close = 0x03,
+  step = 0x04,
+  display = 0x05,
+  getState = 0x06,
+  setState = 0x07,
+  snapshot = 0x08,
+  restore = 0x09,
+  drop = 0x0A,
+};
+
+enum class Status : Byte {
+  ok = 0,
+  badRequest = 1, // malformed request or unknown op
+  notFound = 2,   // no such ROM, session or snapshot
+  fault = 3,      // the program faulted; the session is stopped
+  full = 4,       // every session, or the session's snapshots, in use
+};
+
+// bodies above this size are a protocol error, and end the connection
+constexpr std::size_t maxMessage = 0x10000;
+constexpr std::size_t lengthSize = 4;
+
+// a minute of emulated time per step request
+constexpr uint32_t maxStepFrames = 3600;
+constexpr std::size_t maxSnapshots = 64;
+
+// the sessions one client has created and not yet closed
+struct Connection {
+  std::vector<uint32_t> sessions{};
+};
+
+class Server {
+public:
+  Server(std::size_t sessions, std::size_t memBase = Memory8::loadAddrDefault,
+         std::size_t ipt = Machine8::iptDefault, bool hugePages = false);
+
+  // load a ROM for sessions to use, returning its number
+  auto AddRom(std::span<const Byte> rom) -> uint32_t;
+
+  // handle every complete message at the start of input from connection,
+  // appending one response per request to output, and return the bytes
+  // consumed; throws std::runtime_error on an oversized message
+  auto Process(std::span<const Byte> input, std::vector<Byte> &output,
+               Connection &connection) -> std::size_t;
+
+  // close every session the connection left open, with its snapshots
+  void Disconnect(Connection &connection);
+
+  [[nodiscard]] auto OpenSessions() const -> std::size_t {
+    return pool_.Size() - freeSessions_.size();
+  }
+
+private:
+  struct Rom {
+    std::vector<Byte> image{};
+    MachineState8 initial{};
+  };
+
+  struct Session {
+    uint32_t generation{0};
+    uint32_t rom{0};
+    bool open{false};
+    bool faulted{false};
+    std::unordered_map<uint32_t, MachineState8> snapshots{};
+    uint32_t nextSnapshot{0};
+  };
+
+  std::size_t memBase_;
+  std::size_t ipt_;
+  MachinePool8 pool_;
+  std::vector<Session> sessions_;
+  std::vector<uint32_t> freeSessions_;
+  std::vector<Rom> roms_{};
+  std::vector<Byte> scratch_{};
+
+  auto Handle(Op op, ByteReader &args, ByteWriter &result,
+              Connection &connection) -> Status;
+  auto Create(ByteReader &args, ByteWriter &result, Connection &connection)
+      -> Status;
+  auto Step(Session &session, Machine8 &machine, ByteReader &args,
+            ByteWriter &result) -> Status;
+  auto FindSession(uint32_t id) -> Session *;
+  [[nodiscard]] auto IsOpen(uint32_t id) const -> bool;
+  void CloseSession(std::size_t slot);
+};
+
+} // namespace server8
+
+#endif /* EMU8_SERVER_H */
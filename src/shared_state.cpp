@@ -0,0 +1,178 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "shared_state.h"
+
+namespace {
+
+constexpr mode_t segmentMode = 0644;
+
+// shared memory names are a single path component after a leading slash
+auto SegmentName(const std::string &name) -> std::string {
+  return (!name.empty() && name.front() == '/') ? name : "/" + name;
+}
+
+[[noreturn]] void ReportError(const std::string &msg,
+                              const std::string &name) {
+  throw std::runtime_error(msg + name + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+SharedExport8::SharedExport8(const std::string &name)
+    : name_(SegmentName(name)) {
+  // never take over a segment another emulator is publishing to, nor one
+  // planted with other contents; a stale one has to be removed by hand
+  const int fd = ::shm_open(name_.c_str(),
+                            O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, segmentMode);
+  if (fd < 0 && errno == EEXIST) {
+    throw std::runtime_error("Shared memory " + name_ +
+                             " already exists; another emulator may be "
+                             "using it, or remove /dev/shm" + name_);
+  }
+  if (fd < 0) {
+    ReportError("Could not create shared memory ", name_);
+  }
+
+  if (::ftruncate(fd, sizeof(SharedSegment8)) < 0) {
+    ::close(fd);
+    ::shm_unlink(name_.c_str());
+    ReportError("Could not size shared memory ", name_);
+  }
+
+  void *addr = ::mmap(nullptr, sizeof(SharedSegment8), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) { // NOLINT
+    ::shm_unlink(name_.c_str());
+    ReportError("Could not map shared memory ", name_);
+  }
+
+  // the header goes in last, so readers never accept a half-built segment
+  segment_ = new (addr) SharedSegment8();
+  segment_->version = SharedSegment8::versionValue;
+  segment_->size = sizeof(SharedSegment8);
+  std::atomic_thread_fence(std::memory_order_release);
+  segment_->magic = SharedSegment8::magicValue;
+}
+
+SharedExport8::~SharedExport8() {
+  ::munmap(segment_, sizeof(SharedSegment8));
+  ::shm_unlink(name_.c_str());
+}
+
+void SharedExport8::Publish(const Machine8 &machine) {
+  auto &sequence = segment_->sequence;
+  const auto start = sequence.load(std::memory_order_relaxed);
+  sequence.store(start + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  auto &state = segment_->state;
+  const auto &regs = machine.Registers();
+  state.frame = machine.FrameCount();
+  state.instructions = machine.InstructionCount();
+  state.registers = regs.registers;
+  std::copy_n(regs.callStack.data(), regs.callStack.size(),
+              state.callStack.begin());
+  state.stackDepth = static_cast<Byte>(regs.callStack.size());
+  state.regI = regs.regI;
+  state.pc = regs.pc;
+  state.regDT = regs.regDT;
+  state.regST = regs.regST;
+  state.keysHeld = machine.Keys().GetState();
+  state.keysPressed = machine.Keys().GetLatched();
+
+  const auto display = machine.Display().Data();
+  std::copy(display.begin(), display.end(), state.display.begin());
+  const auto ram = machine.Memory().viewSequence(0, Memory8::memSize);
+  std::copy(ram.begin(), ram.end(), state.memory.begin());
+
+  sequence.store(start + 2, std::memory_order_release);
+}
+
+SharedView8::SharedView8(const std::string &name) {
+  const auto path = SegmentName(name);
+  const int fd = ::shm_open(path.c_str(), O_RDONLY | O_CLOEXEC, 0);
+  if (fd < 0) {
+    ReportError("Could not open shared memory ", path);
+  }
+
+  struct stat info = {};
+  if (::fstat(fd, &info) < 0 ||
+      static_cast<std::size_t>(info.st_size) < sizeof(SharedSegment8)) {
+    ::close(fd);
+    throw std::runtime_error("Shared memory is not an emu8 segment: " + path);
+  }
+
+  void *addr =
+      ::mmap(nullptr, sizeof(SharedSegment8), PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) { // NOLINT
+    ReportError("Could not map shared memory ", path);
+  }
+
+  segment_ = static_cast<const SharedSegment8 *>(addr);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (segment_->magic != SharedSegment8::magicValue ||
+      segment_->version != SharedSegment8::versionValue ||
+      segment_->size != sizeof(SharedSegment8)) {
+    ::munmap(addr, sizeof(SharedSegment8));
+    throw std::runtime_error("Shared memory is not a version " +
+                             std::to_string(SharedSegment8::versionValue) +
+                             " emu8 segment: " + path);
+  }
+}
+
+SharedView8::~SharedView8() {
+  ::munmap(const_cast<SharedSegment8 *>(segment_), // NOLINT
+           sizeof(SharedSegment8));
+}
+
+auto SharedView8::Begin() const -> uint64_t {
+  uint64_t sequence = segment_->sequence.load(std::memory_order_acquire);
+  while ((sequence & 1U) != 0) {
+    sequence = segment_->sequence.load(std::memory_order_acquire);
+  }
+  return sequence;
+}
+
+auto SharedView8::Valid(uint64_t sequence) const -> bool {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return segment_->sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+void SharedView8::Read(SharedFrame8 &frame) const {
+  uint64_t sequence = 0;
+  do {
+    sequence = Begin();
+    frame = segment_->state;
+  } while (!Valid(sequence));
+}
@@ -0,0 +1,130 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_SHARED_STATE_H
+#define EMU8_SHARED_STATE_H
+
+#include <array>
+#include <atomic>
+#include <string>
+
+#include "common.h"
+#include "frame_buffer.h"
+#include "machine.h"
+#include "memory.h"
+#include "register_set.h"
+
+/*
+ * live machine state published in a POSIX shared memory segment, for
+ * monitors, visualizers and bots in other processes; the emulator copies the
+ * state in once per frame, and readers map the segment and read it in place
+ * with no system calls
+ *
+ * writes are guarded by a seqlock: the sequence number is odd while a frame
+ * is being written and even once it is complete, so a reader takes the
+ * number, reads, and accepts what it read only if the number is still the
+ * same even value afterwards
+ */
+
+// everything published each frame; fixed size and layout, native byte order
+struct SharedFrame8 {
+  uint64_t frame{0};
+  uint64_t instructions{0};
+  std::array<Byte, RegisterSet8::regCount> registers{};
+  std::array<Address, RegisterSet8::stackSize> callStack{};
+  Address regI{0};
+  Address pc{0};
+  Byte stackDepth{0};
+  Byte regDT{0};
+  Byte regST{0};
+  Byte reserved{0};
+  Word keysHeld{0};
+  Word keysPressed{0};
+  FrameBuffer8::Buffer display{};
+  std::array<Byte, Memory8::memSize> memory{};
+};
+
+struct SharedSegment8 {
+  static constexpr std::array<char, 8> magicValue = {'E', 'M', 'U', '8',
+                                                     'L', 'I', 'V', 'E'};
+  static constexpr uint32_t versionValue = 1;
+
+  std::array<char, 8> magic{};
+  uint32_t version{0};
+  uint32_t size{0};
+  std::atomic<uint64_t> sequence{0};
+  SharedFrame8 state{};
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "the seqlock must work across processes");
+
+// the emulator's side: creates the segment, and removes it when destroyed
+class SharedExport8 {
+public:
+  explicit SharedExport8(const std::string &name);
+  ~SharedExport8();
+
+  SharedExport8(const SharedExport8 &other) = delete;
+  SharedExport8(SharedExport8 &&other) = delete;
+  auto operator=(const SharedExport8 &other) -> SharedExport8 & = delete;
+  auto operator=(SharedExport8 &&other) -> SharedExport8 & = delete;
+
+  // copy the machine's current state into the segment
+  void Publish(const Machine8 &machine);
+
+  [[nodiscard]] auto Name() const -> const std::string & { return name_; }
+
+private:
+  std::string name_;
+  SharedSegment8 *segment_{nullptr};
+};
+
+// a reader's side: maps an existing segment read-only
+class SharedView8 {
+public:
+  explicit SharedView8(const std::string &name);
+  ~SharedView8();
+
+  SharedView8(const SharedView8 &other) = delete;
+  SharedView8(SharedView8 &&other) = delete;
+  auto operator=(const SharedView8 &other) -> SharedView8 & = delete;
+  auto operator=(SharedView8 &&other) -> SharedView8 & = delete;
+
+  // the live segment, for reading in place between Begin() and Valid()
+  [[nodiscard]] auto Segment() const -> const SharedSegment8 & {
+    return *segment_;
+  }
+
+  // wait until no frame is being written, and return the sequence number
+  [[nodiscard]] auto Begin() const -> uint64_t;
+
+  // whether nothing was written since Begin() returned sequence
+  [[nodiscard]] auto Valid(uint64_t sequence) const -> bool;
+
+  // copy out one consistent frame
+  void Read(SharedFrame8 &frame) const;
+
+private:
+  const SharedSegment8 *segment_{nullptr};
+};
+
+#endif /* EMU8_SHARED_STATE_H */
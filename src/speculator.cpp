@@ -0,0 +1,138 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include "speculator.h"
+
+Speculator8::Speculator8(std::size_t memBase, std::size_t ipt,
+                         std::size_t threads)
+    : machines_(), threads_(), mutex_(), startCond_(), doneCond_() {
+  const auto count = std::clamp<std::size_t>(threads, 1, branchCount);
+  for (std::size_t worker = 0; worker < count; worker++) {
+    machines_.push_back(std::make_unique<Machine8>(memBase, ipt));
+  }
+
+  for (std::size_t worker = 0; worker < count; worker++) {
+    threads_.emplace_back(&Speculator8::WorkerLoop, this, worker);
+  }
+}
+
+Speculator8::~Speculator8() {
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  startCond_.notify_all();
+
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+auto Speculator8::DefaultThreads() -> std::size_t {
+  const std::size_t cores = std::thread::hardware_concurrency();
+  return std::clamp<std::size_t>(cores > 1 ? cores - 1 : 1, 1, branchCount);
+}
+
+void Speculator8::WorkerLoop(std::size_t worker) {
+  auto &machine = *machines_[worker];
+  uint64_t seen = 0;
+
+  while (true) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    startCond_.wait(lock, [&] { return stop_ || generation_ != seen; });
+    if (stop_) {
+      return;
+    }
+    seen = generation_;
+    lock.unlock();
+
+    // each worker takes every n-th key, so no two touch the same result
+    for (std::size_t key = worker; key < branchCount; key += threads_.size()) {
+      machine.LoadState(base_);
+      try {
+        machine.RunFrame(static_cast<Word>(1U << key));
+        machine.SaveState(results_[key]);
+        faulted_[key] = false;
+      } catch (const std::exception & /*err*/) {
+        // the fault is raised again if this key really is pressed
+        faulted_[key] = true;
+      }
+    }
+
+    lock.lock();
+    pending_--;
+    if (pending_ == 0) {
+      doneCond_.notify_all();
+    }
+  }
+}
+
+void Speculator8::Begin(const Machine8 &machine) {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  // the previous round may still be reading base_
+  doneCond_.wait(lock, [&] { return pending_ == 0; });
+  active_ = machine.WaitingForKey();
+  if (!active_) {
+    return;
+  }
+
+  machine.SaveState(base_);
+  generation_++;
+  pending_ = threads_.size();
+  lock.unlock();
+
+  startCond_.notify_all();
+}
+
+auto Speculator8::TryCommit(Machine8 &machine, Word keyMask) -> bool {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!active_ || !std::has_single_bit(keyMask)) {
+    return false;
+  }
+
+  // speculation only holds for the exact state it started from; anything
+  // run or loaded since shows up in the running totals
+  if (machine.FrameCount() != base_.frameTotal ||
+      machine.InstructionCount() != base_.instrTotal) {
+    active_ = false;
+    return false;
+  }
+
+  doneCond_.wait(lock, [&] { return pending_ == 0; });
+  active_ = false;
+
+  const auto key = static_cast<std::size_t>(std::countr_zero(keyMask));
+  if (faulted_.at(key)) {
+    return false;
+  }
+  machine.LoadState(results_.at(key));
+  return true;
+}
+
+void Speculator8::Invalidate() {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  active_ = false;
+}
@@ -0,0 +1,99 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_SPECULATOR_H
+#define EMU8_SPECULATOR_H
+
+#include <array>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common.h"
+#include "keypad.h"
+#include "machine.h"
+#include "machine_state.h"
+
+/*
+ * speculative execution across Fx0A key waits: while a program is blocked
+ * waiting for a key, its next frame can only go one of 16 ways (one per key),
+ * so worker threads compute all of them from a copy of the machine state, and
+ * the branch matching the key that actually arrives is committed by loading
+ * its precomputed state instead of emulating the frame
+ *
+ * the result is always exactly the state that running the frame would have
+ * produced; input that was not speculated (no key, several keys at once, a
+ * key whose frame faults, or a machine that has changed since) simply runs
+ * the frame as normal
+ */
+class Speculator8 {
+public:
+  static constexpr std::size_t branchCount = Keypad8::keyCount;
+
+  // workers run machines with the given load address and clock rate, which
+  // must match the machine being speculated on
+  Speculator8(std::size_t memBase, std::size_t ipt, std::size_t threads);
+
+  Speculator8(const Speculator8 &other) = delete;
+  Speculator8(Speculator8 &&other) = delete;
+  auto operator=(const Speculator8 &other) -> Speculator8 & = delete;
+  auto operator=(Speculator8 &&other) -> Speculator8 & = delete;
+  ~Speculator8();
+
+  // one worker per idle core, up to one per branch
+  static auto DefaultThreads() -> std::size_t;
+
+  // if the machine is waiting on Fx0A, start computing its next frame for
+  // each single key press
+  void Begin(const Machine8 &machine);
+
+  // if keyMask is a single key press covered by the current speculation,
+  // wait for it to finish and load the matching next frame into the machine;
+  // returns false if the frame still has to be run normally
+  auto TryCommit(Machine8 &machine, Word keyMask) -> bool;
+
+  // drop the current speculation, e.g. after loading a state
+  void Invalidate();
+
+private:
+  std::vector<std::unique_ptr<Machine8>> machines_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable startCond_;
+  std::condition_variable doneCond_;
+  uint64_t generation_ = {0};
+  std::size_t pending_ = {0};
+  bool active_ = {false};
+  bool stop_ = {false};
+
+  // written only while no worker is running
+  MachineState8 base_ = {};
+  std::array<MachineState8, branchCount> results_ = {};
+  // branches whose frame faulted have no result and run normally instead
+  std::array<bool, branchCount> faulted_ = {};
+
+  void WorkerLoop(std::size_t worker);
+};
+
+#endif /* EMU8_SPECULATOR_H */
@@ -0,0 +1,101 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include "timeline.h"
+
+namespace {
+
+constexpr std::array<const char *, Timeline8::trackCount> trackNames = {
+    "emulation", "audio"};
+
+} // namespace
+
+Timeline8::Timeline8(std::size_t capacity) : origin_(Clock::now()) {
+  for (auto &track : tracks_) {
+    track.events.resize(capacity);
+  }
+}
+
+void Timeline8::Add(Track track, const char *name, Clock::time_point start,
+                    uint64_t frame) {
+  const auto end = Clock::now();
+  auto &events = tracks_.at(static_cast<std::size_t>(track));
+
+  // only this track's thread writes to it, so a relaxed load of its own
+  // count is enough; the release store publishes the event to Write()
+  const auto next = events.count.load(std::memory_order_relaxed);
+  if (next == events.events.size()) {
+    events.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  events.events[next] = {name, frame, start, end};
+  events.count.store(next + 1, std::memory_order_release);
+}
+
+void Timeline8::Write(std::ostream &out) const {
+  constexpr int precision = 3;
+  const auto micros = [this](Clock::time_point time) {
+    return std::chrono::duration<double, std::micro>(time - origin_).count();
+  };
+
+  out << std::fixed << std::setprecision(precision)
+      << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+  for (std::size_t tid = 0; tid < trackCount; tid++) {
+    const auto &track = tracks_.at(tid);
+    out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+        << "\"tid\": " << tid + 1 << ", \"args\": {\"name\": \""
+        << trackNames.at(tid) << "\", \"dropped\": "
+        << track.dropped.load(std::memory_order_relaxed) << "}}";
+
+    const auto count = track.count.load(std::memory_order_acquire);
+    for (std::size_t idx = 0; idx < count; idx++) {
+      const auto &event = track.events[idx];
+      out << ",\n{\"name\": \"" << event.name
+          << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << tid + 1
+          << ", \"ts\": " << micros(event.start)
+          << ", \"dur\": " << micros(event.end) - micros(event.start);
+      if (event.frame != noFrame) {
+        out << ", \"args\": {\"frame\": " << event.frame << '}';
+      }
+      out << '}';
+    }
+    out << ((tid + 1 < trackCount) ? ",\n" : "\n");
+  }
+  out << "]}\n";
+}
+
+void Timeline8::Save(const std::string &path) const {
+  std::ofstream out(path, std::ios::trunc);
+  if (!out.good()) {
+    throw std::runtime_error("Could not create timeline: " + path);
+  }
+
+  Write(out);
+  out.close();
+  if (out.fail()) {
+    throw std::runtime_error("Could not write timeline: " + path);
+  }
+}
@@ -0,0 +1,110 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_TIMELINE_H
+#define EMU8_TIMELINE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+ * timeline of where the frontend spends each frame (executing, polling
+ * events, updating the texture, presenting, sleeping) and of the audio
+ * callbacks, written as Chrome trace-event JSON for chrome://tracing or
+ * Perfetto; each thread appends to its own preallocated track, so recording
+ * never allocates or locks, and stops once a track is full
+ */
+class Timeline8 {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // events kept per track, about ten minutes of frames
+  static constexpr std::size_t defaultCapacity = std::size_t{1} << 18;
+  static constexpr uint64_t noFrame = std::numeric_limits<uint64_t>::max();
+
+  // one track per recording thread
+  enum class Track : std::size_t { emulation, audio };
+  static constexpr std::size_t trackCount = 2;
+
+  explicit Timeline8(std::size_t capacity = defaultCapacity);
+
+  // record that name ran from start until now on track; name must be a
+  // string literal, as only the pointer is kept
+  void Add(Track track, const char *name, Clock::time_point start,
+           uint64_t frame = noFrame);
+
+  // times a block as one event when a timeline is given, and costs nothing
+  // but a null check otherwise
+  class Scope {
+  public:
+    Scope(Timeline8 *timeline, Track track, const char *name,
+          uint64_t frame = noFrame)
+        : timeline_(timeline), track_(track), name_(name), frame_(frame),
+          start_((timeline != nullptr) ? Clock::now() : Clock::time_point{}) {
+    }
+    ~Scope() {
+      if (timeline_ != nullptr) {
+        timeline_->Add(track_, name_, start_, frame_);
+      }
+    }
+
+    Scope(const Scope &other) = delete;
+    Scope(Scope &&other) = delete;
+    auto operator=(const Scope &other) -> Scope & = delete;
+    auto operator=(Scope &&other) -> Scope & = delete;
+
+  private:
+    Timeline8 *timeline_;
+    Track track_;
+    const char *name_;
+    uint64_t frame_;
+    Clock::time_point start_;
+  };
+
+  // events recorded so far on every track, as one JSON document; safe to
+  // call while other threads are still recording
+  void Write(std::ostream &out) const;
+  void Save(const std::string &path) const;
+
+private:
+  struct Event {
+    const char *name{nullptr};
+    uint64_t frame{noFrame};
+    Clock::time_point start{};
+    Clock::time_point end{};
+  };
+
+  struct Events {
+    std::vector<Event> events{};
+    std::atomic<std::size_t> count{0};
+    std::atomic<std::size_t> dropped{0};
+  };
+
+  Clock::time_point origin_;
+  std::array<Events, trackCount> tracks_{};
+};
+
+#endif /* EMU8_TIMELINE_H */
@@ -0,0 +1,45 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <numbers>
+
+#include "tone.h"
+
+namespace {
+
+constexpr auto twoPi = static_cast<float>(2.0 * std::numbers::pi);
+
+} // namespace
+
+Tone8::Tone8(float toneFreq, float sampleFreq, float amplitude)
+    : step_(twoPi * (toneFreq / sampleFreq)), amplitude_(amplitude) {}
+
+void Tone8::Fill(std::span<float> samples) {
+  std::size_t idx = 0;
+  for (auto &sample : samples) {
+    sample = amplitude_ * std::sin(step_ * static_cast<float>(idx) + phase_);
+    idx++;
+  }
+
+  // keep the phase small so float precision does not drift over long runs
+  phase_ = std::fmod(phase_ + step_ * static_cast<float>(idx), twoPi);
+}
@@ -0,0 +1,47 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_TONE_H
+#define EMU8_TONE_H
+
+#include <span>
+
+/*
+ * sine tone generator for the sound timer beep, filling mono float buffers
+ * the way the SDL audio callback requests them; the phase carries over from
+ * one buffer to the next so consecutive buffers join without a click
+ */
+class Tone8 {
+public:
+  static constexpr float defaultAmplitude = 0.1F;
+
+  Tone8(float toneFreq, float sampleFreq, float amplitude = defaultAmplitude);
+
+  // overwrite samples with the next stretch of the tone
+  void Fill(std::span<float> samples);
+
+private:
+  float step_;
+  float amplitude_;
+  float phase_ = {0.0F};
+};
+
+#endif /* EMU8_TONE_H */
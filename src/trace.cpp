@@ -0,0 +1,125 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <stdexcept>
+
+#include "byte_stream.h"
+#include "trace.h"
+
+Trace8::Trace8(std::size_t length)
+    : entries_(std::bit_ceil(std::max<std::size_t>(length, 1))),
+      mask_(entries_.size() - 1) {}
+
+auto Trace8::Entries() const -> std::vector<Entry> {
+  const auto held = std::min<uint64_t>(recorded_, entries_.size());
+
+  std::vector<Entry> ordered;
+  ordered.reserve(held);
+  for (auto seq = recorded_ - held; seq < recorded_; seq++) {
+    ordered.push_back(entries_[seq & mask_]);
+  }
+  return ordered;
+}
+
+void Trace8::Serialize(std::vector<Byte> &buf) const {
+  const auto ordered = Entries();
+
+  buf.clear();
+  buf.reserve(headerSize + ordered.size() * sizeof(uint64_t));
+  ByteWriter writer(buf);
+
+  buf.insert(buf.end(), fileMagic.begin(), fileMagic.end());
+  writer.Put<uint16_t>(formatVersion);
+  writer.Put<uint32_t>(static_cast<uint32_t>(ordered.size()));
+  writer.Put<uint64_t>(recorded_);
+
+  for (const auto &entry : ordered) {
+    writer.Put<Address>(entry.pc);
+    writer.Put<Instruction>(entry.opcode);
+    writer.Put<Address>(entry.regI);
+    writer.Put<Byte>(entry.valX);
+    writer.Put<Byte>(entry.valY);
+  }
+}
+
+auto Trace8::Deserialize(std::span<const Byte> image) -> Trace8 {
+  constexpr std::size_t entrySize = 8;
+  ByteReader reader(image, "Trace");
+
+  const auto magic = reader.Take(fileMagic.size());
+  if (!std::equal(magic.begin(), magic.end(), fileMagic.begin())) {
+    throw std::runtime_error("Not an emu8 trace");
+  }
+
+  const auto version = reader.Get<uint16_t>();
+  if (version != formatVersion) {
+    throw std::runtime_error("Unsupported trace version " +
+                             std::to_string(version));
+  }
+
+  const auto count = reader.Get<uint32_t>();
+  const auto recorded = reader.Get<uint64_t>();
+
+  // check the sizes before trusting them with an allocation
+  if (reader.Remaining() != std::size_t{count} * entrySize ||
+      count > recorded) {
+    throw std::runtime_error("Trace entry count does not match its size");
+  }
+
+  Trace8 trace(count);
+  trace.recorded_ = recorded - count;
+  for (uint32_t idx = 0; idx < count; idx++) {
+    Entry entry;
+    entry.pc = reader.Get<Address>();
+    entry.opcode = reader.Get<Instruction>();
+    entry.regI = reader.Get<Address>();
+    entry.valX = reader.Get<Byte>();
+    entry.valY = reader.Get<Byte>();
+    trace.entries_[trace.recorded_ & trace.mask_] = entry;
+    trace.recorded_++;
+  }
+
+  return trace;
+}
+
+void Trace8::Save(const std::string &path) const {
+  std::vector<Byte> buf;
+  Serialize(buf);
+
+  std::ofstream traceFile(path, std::ios::binary | std::ios::trunc);
+  if (!traceFile.good()) {
+    throw std::runtime_error("Could not create trace: " + path);
+  }
+
+  traceFile.write(reinterpret_cast<const char *>(buf.data()), // NOLINT
+                  static_cast<std::streamsize>(buf.size()));
+  traceFile.close();
+  if (traceFile.fail()) {
+    throw std::runtime_error("Could not write trace: " + path);
+  }
+}
+
+auto Trace8::Load(const std::string &path) -> Trace8 {
+  return Deserialize(ReadFileBytes(path));
+}
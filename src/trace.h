@@ -0,0 +1,101 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_TRACE_H
+#define EMU8_TRACE_H
+
+#include <array>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "bits.h"
+#include "common.h"
+#include "register_set.h"
+
+/*
+ * execution trace: the last few thousand instructions a machine ran, kept in
+ * a fixed ring so that recording is a single 8-byte store per instruction
+ * and can stay on in normal play; dumped next to the core file when a
+ * program faults, and read back by emu8-trace
+ *
+ * file format, all multi-byte fields little-endian:
+ *
+ *   offset  size  field
+ *        0     8  magic "EMU8TRAC"
+ *        8     2  format version
+ *       10     4  entry count n
+ *       14     8  instructions recorded in total, including overwritten ones
+ *       22   8*n  entries, oldest first: 2 byte PC, 2 byte opcode, 2 byte I,
+ *                 then 1 byte each for Vx and Vy as the opcode names them
+ *
+ * registers are captured before the instruction runs, so the last entry of a
+ * faulting program shows the inputs of the instruction that faulted
+ */
+class Trace8 {
+public:
+  static constexpr std::array<char, 8> fileMagic = {'E', 'M', 'U', '8',
+                                                    'T', 'R', 'A', 'C'};
+  static constexpr uint16_t formatVersion = 1;
+  static constexpr std::size_t headerSize = 22;
+  static constexpr std::size_t defaultLength = 4096;
+
+  struct Entry {
+    Address pc{0};
+    Instruction opcode{0};
+    Address regI{0};
+    Byte valX{0};
+    Byte valY{0};
+  };
+
+  // the length is rounded up to a power of two
+  explicit Trace8(std::size_t length = defaultLength);
+
+  void Record(Address pc, Instruction opcode, const RegisterSet8 &regs) {
+    const auto [high, low] = bits8::splitWord(opcode);
+    entries_[recorded_ & mask_] = {pc, opcode, regs.regI, // NOLINT
+                                   regs.registers[bits8::lowNibble(high)],
+                                   regs.registers[bits8::highNibble(low)]};
+    recorded_++;
+  }
+
+  [[nodiscard]] auto Length() const -> std::size_t { return entries_.size(); }
+  [[nodiscard]] auto Recorded() const -> uint64_t { return recorded_; }
+
+  // the entries still held, oldest first
+  [[nodiscard]] auto Entries() const -> std::vector<Entry>;
+
+  // encode into buf, replacing its contents
+  void Serialize(std::vector<Byte> &buf) const;
+
+  // decode a trace image, throwing std::runtime_error on a malformed one
+  static auto Deserialize(std::span<const Byte> image) -> Trace8;
+
+  void Save(const std::string &path) const;
+  static auto Load(const std::string &path) -> Trace8;
+
+private:
+  std::vector<Entry> entries_;
+  std::size_t mask_;
+  uint64_t recorded_{0};
+};
+
+#endif /* EMU8_TRACE_H */
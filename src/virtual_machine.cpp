@@ -30,18 +30,60 @@
 #include <thread>
 #include <vector>
 
+#include "alloc_counter.h"
+#include "byte_stream.h"
+#include "hash.h"
+#include "save_state.h"
 #include "virtual_machine.h"
 
 namespace bpt = boost::property_tree;
 
 VirtualMachine8::VirtualMachine8(const std::string &title,
                                  const Settings &settings)
-    : memBase_(settings.memBase), instrPerTick_(settings.ipt),
-      interface_(title, regSet_, settings.audioSize, settings.scaling),
-      memory_(settings.memBase), instructionSet_(regSet_, memory_, interface_) {
+    : countAllocs_(settings.countAllocs), stateFile_(settings.stateFile),
+      loadState_(settings.loadState), seed_(settings.seed),
+      recordPath_(settings.recordMovie), playback_(settings.playback),
+      timelinePath_(settings.timeline),
+      interface_(title, settings.audioSize, settings.scaling),
+      machine_(settings.memBase, settings.ipt, settings.seed) {
   if (!settings.config.empty()) {
     LoadKeyConfig(settings.config);
   }
+
+  if (settings.rewindSeconds > 0) {
+    rewind_.emplace(settings.rewindSeconds * framesPerSecond);
+  }
+
+  if (settings.runAhead > 0) {
+    runAhead_.emplace(settings.runAhead);
+  }
+
+  if (settings.speculate) {
+    speculator_ = std::make_unique<Speculator8>(
+        machine_.GetMemBase(), machine_.GetInstructionsPerTick(),
+        Speculator8::DefaultThreads());
+  }
+
+  if (!settings.sharedMemory.empty()) {
+    shared_.emplace(settings.sharedMemory);
+  }
+
+  if (!settings.metrics.empty()) {
+    metrics_.emplace(settings.metrics);
+    interface_.SetMetrics(&metrics_->Slot());
+  }
+
+  machine_.SetProfiler(settings.profiler);
+
+  if (!settings.timeline.empty()) {
+    timeline_ = std::make_unique<Timeline8>();
+    interface_.SetTimeline(timeline_.get());
+  }
+
+  if (settings.traceLength > 0) {
+    trace_.emplace(settings.traceLength);
+    machine_.SetTrace(&trace_.value());
+  }
 }
 
 auto VirtualMachine8::ParseFile(const std::string &iniFile)
@@ -80,48 +122,279 @@ void VirtualMachine8::LoadKeyConfig(const std::string &config) {
   interface_.SetKeyMapping(std::move(mapping));
 }
 
+static constexpr auto tickLength = std::chrono::milliseconds(16);
+
 static auto GetNextTick() {
-  using std::chrono::operator""ms;
-  const auto tickLen = 16ms;
-  return (std::chrono::steady_clock::now() + tickLen);
+  return (std::chrono::steady_clock::now() + tickLength);
+}
+
+auto VirtualMachine8::MovieActive() const -> bool {
+  return recording_ || (playback_ && playFrame_ < playback_->FrameCount());
+}
+
+auto VirtualMachine8::NextKeyMask() -> Word {
+  Word keyMask = 0x0;
+  if (playback_ && playFrame_ < playback_->FrameCount()) {
+    keyMask = playback_->KeyMask(playFrame_);
+    playFrame_++;
+    if (playFrame_ == playback_->FrameCount()) {
+      std::cerr << "Movie playback finished, switching to live input\n";
+    }
+  } else {
+    keyMask = interface_.PollKeys();
+  }
+
+  if (recording_) {
+    recording_->Append(keyMask);
+  }
+  return keyMask;
+}
+
+void VirtualMachine8::FinishRecording() {
+  if (!recording_) {
+    return;
+  }
+
+  try {
+    recording_->Save(recordPath_);
+    std::cerr << "Saved movie of " << recording_->FrameCount()
+              << " frames to " << recordPath_ << '\n';
+  } catch (const std::runtime_error &err) {
+    std::cerr << "WARNING: " << err.what() << '\n';
+  }
+}
+
+void VirtualMachine8::FinishTimeline() {
+  if (!timeline_) {
+    return;
+  }
+
+  try {
+    timeline_->Save(timelinePath_);
+    std::cerr << "Saved timeline to " << timelinePath_ << '\n';
+  } catch (const std::runtime_error &err) {
+    std::cerr << "WARNING: " << err.what() << '\n';
+  }
+}
+
+void VirtualMachine8::HandleHotkey(SDL_Scancode scanCode) {
+  // a failed save or load is reported but never ends the session
+  try {
+    if (scanCode == saveStateKey) {
+      state8::SaveFile(machine_, stateFile_);
+      std::cerr << "Saved state to " << stateFile_ << '\n';
+    } else if (scanCode == loadStateKey && MovieActive()) {
+      // a movie only records input, so it cannot follow a jump in state
+      std::cerr << "WARNING: state loading is disabled during movies\n";
+    } else if (scanCode == loadStateKey) {
+      state8::LoadFile(machine_, stateFile_);
+      std::cerr << "Loaded state from " << stateFile_ << '\n';
+
+      // history from before the load no longer leads to this state
+      if (rewind_) {
+        rewind_->Reset();
+      }
+      if (speculator_) {
+        speculator_->Invalidate();
+      }
+    }
+  } catch (const std::runtime_error &err) {
+    std::cerr << "WARNING: " << err.what() << '\n';
+  }
+}
+
+void VirtualMachine8::RunFrame(Word keyMask) {
+  const auto allocsBefore = alloc8::ThreadAllocations();
+  auto *timeline = timeline_.get();
+  const auto frame = machine_.FrameCount();
+
+  {
+    const Timeline8::Scope scope(timeline, Timeline8::Track::emulation,
+                                 "execute", frame);
+
+    // a key arriving during an Fx0A wait may already have its frame computed
+    if (!speculator_ || !speculator_->TryCommit(machine_, keyMask)) {
+      machine_.RunFrame(keyMask);
+    }
+    if (speculator_) {
+      speculator_->Begin(machine_);
+    }
+  }
+
+  if (rewind_) {
+    const Timeline8::Scope scope(timeline, Timeline8::Track::emulation,
+                                 "record history", frame);
+    rewind_->Record(machine_);
+  }
+
+  // only redraw when something was drawn or cleared since the last frame;
+  // a run-ahead frame can differ even when the real one does not, so it is
+  // always redrawn
+  auto &display = machine_.Display();
+  if (runAhead_) {
+    std::span<const Byte> preview;
+    {
+      const Timeline8::Scope scope(timeline, Timeline8::Track::emulation,
+                                   "run ahead", frame);
+      preview = runAhead_->Preview(machine_, keyMask);
+    }
+    interface_.Present(preview);
+    display.ClearDirty();
+  } else if (display.Dirty()) {
+    interface_.Present(display.Data());
+    display.ClearDirty();
+  }
+  interface_.SetAudio(machine_.Registers().regST > 0);
+
+  if (shared_) {
+    shared_->Publish(machine_);
+  }
+
+  if (countAllocs_ && machine_.FrameCount() > allocWarmupFrames) {
+    const auto allocs = alloc8::ThreadAllocations() - allocsBefore;
+    if (allocs != 0) {
+      allocFrames_++;
+      allocTotal_ += allocs;
+    }
+  }
 }
 
-void VirtualMachine8::TickReset() {
-  // decrement tick registers
-  if (regSet_.regST > 0) {
-    regSet_.regST--;
+void VirtualMachine8::CountTick(std::chrono::steady_clock::time_point deadline,
+                                std::chrono::steady_clock::time_point finished,
+                                std::chrono::steady_clock::time_point woke) {
+  auto &slot = metrics_->Slot();
+  slot.instructions.store(machine_.InstructionCount(),
+                          std::memory_order_relaxed);
+
+  // a frame that ran past its deadline missed that tick and any others it
+  // ran through; otherwise the sleep should have ended right on time
+  if (finished > deadline) {
+    MetricsSlot8::Add(slot.ticksMissed,
+                      1 + static_cast<uint64_t>((finished - deadline) /
+                                                tickLength));
+  } else if (woke > deadline) {
+    MetricsSlot8::Add(
+        slot.sleepOvershootNs,
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(woke -
+                                                                 deadline)
+                .count()));
   }
-  regSet_.audioOn = (regSet_.regST > 0);
+}
+
+void VirtualMachine8::RewindFrame() {
+  if (!rewind_->StepBack(machine_)) {
+    return;
+  }
+
+  if (speculator_) {
+    speculator_->Invalidate();
+  }
+
+  // loading a state always marks the display for redrawing
+  auto &display = machine_.Display();
+  if (display.Dirty()) {
+    interface_.Present(display.Data());
+    display.ClearDirty();
+  }
+  interface_.SetAudio(false);
 
-  if (regSet_.regDT > 0) {
-    regSet_.regDT--;
+  if (shared_) {
+    shared_->Publish(machine_);
   }
+}
+
+void VirtualMachine8::ReportAllocations() const {
+  const auto frames = machine_.FrameCount();
+  const auto measured = (frames > allocWarmupFrames)
+                            ? frames - allocWarmupFrames
+                            : 0;
 
-  // reset instruction count
-  instrCount_ = 0;
+  std::cerr << "Allocation count after " << allocWarmupFrames
+            << " warm-up frames: " << allocTotal_ << " allocations in "
+            << allocFrames_ << " of " << measured << " frames\n";
+}
+
+void VirtualMachine8::DumpCore(const std::string &romFile) {
+  std::string coreName = romFile + ".core";
+  std::ofstream coreFile(coreName, std::ios::binary);
+  if (!coreFile.good()) {
+    // nothing else we can do
+    return;
+  }
+
+  std::cerr << "Dumping memory core file: " << coreName << '\n';
+  machine_.Memory().dumpCore(coreFile);
+  coreFile.close();
+
+  // the instructions leading up to the fault, for emu8-trace
+  if (trace_) {
+    const std::string traceName = romFile + ".trace";
+    try {
+      trace_->Save(traceName);
+      std::cerr << "Dumping execution trace: " << traceName << '\n';
+    } catch (const std::runtime_error &err) {
+      std::cerr << "WARNING: " << err.what() << '\n';
+    }
+  }
 }
 
 auto VirtualMachine8::Run(const std::string &romFile) -> int {
-  std::ifstream romData(romFile, std::ios::binary);
-  if (!romData.good()) {
-    std::cerr << "Could not open ROM file: " << romFile << '\n';
+  std::vector<Byte> rom;
+  try {
+    rom = ReadFileBytes(romFile);
+    if (playback_) {
+      movie8::CheckRom(*playback_, rom);
+    }
+  } catch (const std::runtime_error &err) {
+    std::cerr << "ERROR: " << err.what() << '\n';
     return EXIT_FAILURE;
   }
 
+  if (!recordPath_.empty()) {
+    recording_.emplace(hash8::Fnv1a(rom), seed_, machine_.GetMemBase(),
+                       machine_.GetInstructionsPerTick());
+  }
+
+  if (stateFile_.empty()) {
+    stateFile_ = romFile + ".state";
+  }
+
   try {
-    memory_.loadProgram(romData);
-    romData.close();
+    machine_.LoadProgram(rom);
+
+    if (!loadState_.empty()) {
+      state8::LoadFile(machine_, loadState_);
+    }
+
+    if (shared_) {
+      shared_->Publish(machine_);
+    }
 
-    regSet_.pc = static_cast<Address>(memBase_);
     auto nextTick = GetNextTick();
-    instrCount_ = 0;
 
     bool quit = false;
     while (!quit) {
-      SDL_Event event;
-      while (SDL_PollEvent(&event) != 0) {
-        if (event.type == SDL_QUIT) {
-          quit = true;
+      const Timeline8::Scope frameScope(timeline_.get(),
+                                        Timeline8::Track::emulation, "frame",
+                                        machine_.FrameCount());
+      {
+        const Timeline8::Scope scope(timeline_.get(),
+                                     Timeline8::Track::emulation,
+                                     "poll events", machine_.FrameCount());
+        SDL_Event event;
+        while (SDL_PollEvent(&event) != 0) {
+          if (event.type == SDL_QUIT) {
+            quit = true;
+          } else if (event.type == SDL_KEYDOWN && event.key.repeat == 0) {
+            HandleHotkey(event.key.keysym.scancode);
+          }
+
+          if (metrics_ &&
+              (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) &&
+              event.key.repeat == 0) {
+            MetricsSlot8::Add(metrics_->Slot().inputEvents);
+          }
         }
       }
 
@@ -129,38 +402,43 @@ auto VirtualMachine8::Run(const std::string &romFile) -> int {
         break;
       }
 
-      if (std::chrono::steady_clock::now() >= nextTick) {
-        TickReset();
-        nextTick = GetNextTick();
+      if (rewind_ && !MovieActive() && Interface8::ScancodeHeld(rewindKey)) {
+        RewindFrame();
+      } else {
+        RunFrame(NextKeyMask());
       }
 
-      if (instrCount_ >= instrPerTick_) {
+      const auto finished = std::chrono::steady_clock::now();
+      {
+        const Timeline8::Scope scope(timeline_.get(),
+                                     Timeline8::Track::emulation, "sleep");
         std::this_thread::sleep_until(nextTick);
-        TickReset();
-        nextTick = GetNextTick();
       }
-
-      auto opcode = memory_.fetchInstruction(regSet_.pc);
-      regSet_.pc += 2;
-
-      instructionSet_.DecodeExecuteInstruction(opcode);
-      instrCount_++;
+      if (metrics_) {
+        CountTick(nextTick, finished, std::chrono::steady_clock::now());
+      }
+      nextTick = GetNextTick();
     }
   } catch (const std::exception &err) {
     std::cerr << "ERROR: " << err.what() << '\n';
-
-    std::string coreName = romFile + ".core";
-    std::ofstream coreFile(coreName, std::ios::binary);
-    if (!coreFile.good()) {
-      // nothing else we can do
-      return EXIT_FAILURE;
+    if (metrics_) {
+      MetricsSlot8::Add(metrics_->Slot().faults);
     }
 
-    std::cerr << "Dumping memory core file: " << coreName << '\n';
-    memory_.dumpCore(coreFile);
-    coreFile.close();
+    // the input leading up to a crash is what reproduces it
+    FinishRecording();
+    FinishTimeline();
+
+    DumpCore(romFile);
     return EXIT_FAILURE;
   }
 
+  FinishRecording();
+  FinishTimeline();
+
+  if (countAllocs_) {
+    ReportAllocations();
+  }
+
   return EXIT_SUCCESS;
 }
@@ -23,27 +23,73 @@
 #define EMU8_VIRTUAL_MACHINE_H
 
 #include <SDL2/SDL_scancode.h>
+#include <chrono>
 #include <map>
+#include <memory>
+#include <optional>
 #include <string>
 
 #include "common.h"
-#include "instruction_set.h"
 #include "interface.h"
+#include "machine.h"
 #include "memory.h"
-#include "register_set.h"
+#include "metrics.h"
+#include "movie.h"
+#include "profiler.h"
+#include "random.h"
+#include "rewind.h"
+#include "run_ahead.h"
+#include "shared_state.h"
+#include "speculator.h"
+#include "timeline.h"
+#include "trace.h"
 
 class VirtualMachine8 {
 public:
-  // set instruction rate around 400 Hz
-  static constexpr std::size_t iptDefault = 7;
+  // frames allowed to allocate before --countAllocs starts reporting
+  static constexpr std::size_t allocWarmupFrames = 60;
+
+  // save state hotkeys
+  static constexpr SDL_Scancode saveStateKey = SDL_SCANCODE_F5;
+  static constexpr SDL_Scancode loadStateKey = SDL_SCANCODE_F9;
+
+  // steps back through recorded history while held
+  static constexpr SDL_Scancode rewindKey = SDL_SCANCODE_BACKSPACE;
+  static constexpr std::size_t framesPerSecond = 60;
 
   struct Settings {
     int scaling{Interface8::defaultScaling};
     Address audioSize{Interface8::defaultAudioBufSize};
     std::size_t memBase{Memory8::loadAddrDefault};
     std::size_t ipt{};
+    uint64_t seed{Random8::defaultSeed};
+    std::size_t rewindSeconds{0};
+    std::size_t runAhead{0};
+    bool countAllocs{false};
+    bool speculate{false};
     std::string config{};
     std::string romFile{};
+    std::string stateFile{};
+    std::string loadState{};
+    std::string recordMovie{};
+    std::string playMovie{};
+    std::string sharedMemory{};
+
+    // shared memory page of runtime counters for monitoring agents
+    std::string metrics{};
+
+    // Chrome trace-event file written on exit, recording frame phases
+    std::string timeline{};
+
+    // instructions kept in the execution trace dumped on a fault, 0 for none
+    std::size_t traceLength{Trace8::defaultLength};
+
+    // movie loaded from playMovie; its seed, load address and clock rate
+    // replace the values above
+    std::optional<movie8::Movie> playback{};
+
+    // attached to the machine for the whole run when set; owned by the caller
+    Profiler8 *profiler{nullptr};
   };
 
   VirtualMachine8(const std::string &title, const Settings &settings);
@@ -52,19 +98,43 @@ public:
   auto Run(const std::string &romFile) -> int;
 
 private:
-  std::size_t memBase_;
-  std::size_t instrPerTick_;
-  std::size_t instrCount_{0};
+  bool countAllocs_;
+  std::string stateFile_;
+  std::string loadState_;
+  std::size_t allocFrames_{0};
+  std::size_t allocTotal_{0};
+  uint64_t seed_;
+  std::string recordPath_;
+  std::optional<movie8::Movie> playback_;
+  std::size_t playFrame_{0};
+  std::optional<movie8::Movie> recording_{};
+  std::string timelinePath_;
+  std::unique_ptr<Timeline8> timeline_{};
+  std::optional<MetricsExport8> metrics_{};
 
   Interface8 interface_;
-  Memory8 memory_;
-  RegisterSet8 regSet_ = {};
-  InstructionSet8 instructionSet_;
+  Machine8 machine_;
+  std::optional<Rewind8> rewind_{};
+  std::optional<RunAhead8> runAhead_{};
+  std::unique_ptr<Speculator8> speculator_{};
+  std::optional<SharedExport8> shared_{};
+  std::optional<Trace8> trace_{};
 
   static auto ParseFile(const std::string &iniFile)
       -> std::map<Byte, SDL_Scancode>;
 
-  void TickReset();
+  [[nodiscard]] auto MovieActive() const -> bool;
+  auto NextKeyMask() -> Word;
+  void FinishRecording();
+  void FinishTimeline();
+  void HandleHotkey(SDL_Scancode scanCode);
+  void RunFrame(Word keyMask);
+  void CountTick(std::chrono::steady_clock::time_point deadline,
+                 std::chrono::steady_clock::time_point finished,
+                 std::chrono::steady_clock::time_point woke);
+  void RewindFrame();
+  void ReportAllocations() const;
+  void DumpCore(const std::string &romFile);
 };
 
 #endif /* EMU8_VIRTUAL_MACHINE_H */
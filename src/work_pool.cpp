@@ -0,0 +1,111 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <thread>
+#include <tuple>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "work_pool.h"
+
+WorkPool8::WorkPool8(std::size_t threads, bool pinCores)
+    : threads_(std::max<std::size_t>(threads, 1)), pinCores_(pinCores),
+      queues_() {
+  for (std::size_t worker = 0; worker < threads_; worker++) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+}
+
+auto WorkPool8::DefaultThreads() -> std::size_t {
+  return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+void WorkPool8::PinToCore(std::size_t core) {
+#ifdef __linux__
+  const auto cores = std::max<std::size_t>(std::thread::hardware_concurrency(),
+                                           1);
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(core % cores, &cpuSet);
+
+  // affinity is only a hint for throughput, so failure is not an error
+  pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#else
+  std::ignore = core;
+#endif
+}
+
+auto WorkPool8::NextJob(std::size_t worker, std::size_t &job) -> bool {
+  {
+    auto &own = *queues_[worker];
+    const std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.jobs.empty()) {
+      job = own.jobs.front();
+      own.jobs.pop_front();
+      return true;
+    }
+  }
+
+  // steal from the back, away from where the owner is working
+  for (std::size_t offset = 1; offset < threads_; offset++) {
+    auto &victim = *queues_[(worker + offset) % threads_];
+    const std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.jobs.empty()) {
+      job = victim.jobs.back();
+      victim.jobs.pop_back();
+      return true;
+    }
+  }
+
+  // no job is ever added once Run() starts, so empty queues mean done
+  return false;
+}
+
+void WorkPool8::WorkerLoop(std::size_t worker, const Job &job) {
+  if (pinCores_) {
+    PinToCore(worker);
+  }
+
+  std::size_t next = 0;
+  while (NextJob(worker, next)) {
+    job(next, worker);
+  }
+}
+
+void WorkPool8::Run(std::size_t jobCount, const Job &job) {
+  for (std::size_t next = 0; next < jobCount; next++) {
+    queues_[next % threads_]->jobs.push_back(next);
+  }
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads_);
+  for (std::size_t worker = 0; worker < threads_; worker++) {
+    workers.emplace_back(&WorkPool8::WorkerLoop, this, worker, std::cref(job));
+  }
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
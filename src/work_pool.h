@@ -0,0 +1,71 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef EMU8_WORK_POOL_H
+#define EMU8_WORK_POOL_H
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common.h"
+
+/*
+ * fixed-size pool of worker threads for running many independent jobs,
+ * identified by index; jobs are dealt out round-robin up front, each worker
+ * takes from the front of its own queue and, once that is empty, steals from
+ * the back of the others', so a few long jobs never hold up the rest
+ */
+class WorkPool8 {
+public:
+  using Job = std::function<void(std::size_t job, std::size_t worker)>;
+
+  // pinCores binds worker n to CPU n (modulo the CPU count), where the
+  // platform supports it
+  explicit WorkPool8(std::size_t threads, bool pinCores = false);
+
+  // number of hardware threads, or 1 if unknown
+  static auto DefaultThreads() -> std::size_t;
+
+  [[nodiscard]] auto Threads() const -> std::size_t { return threads_; }
+
+  // run jobs 0 to jobCount - 1 and wait for all of them; job must be safe to
+  // call concurrently and must not throw
+  void Run(std::size_t jobCount, const Job &job);
+
+private:
+  struct Queue {
+    std::mutex mutex{};
+    std::deque<std::size_t> jobs{};
+  };
+
+  std::size_t threads_;
+  bool pinCores_;
+  std::vector<std::unique_ptr<Queue>> queues_;
+
+  auto NextJob(std::size_t worker, std::size_t &job) -> bool;
+  void WorkerLoop(std::size_t worker, const Job &job);
+  static void PinToCore(std::size_t core);
+};
+
+#endif /* EMU8_WORK_POOL_H */
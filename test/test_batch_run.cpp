@@ -0,0 +1,73 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "batch_run.h"
+#include "test_fixture.h"
+#include "work_pool.h"
+#include "test_batch_run.h"
+
+using fixture8::spriteRom;
+
+void TestBatchRun::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestBatchRun::batchRunTest() {
+  batch8::RunConfig config;
+  config.budget.frames = 100;
+  auto result = batch8::Run(spriteRom, config);
+  assert(result.status == "ok" && result.stop == "frames" &&
+         result.frames == config.budget.frames && "frame budget");
+
+  // the instruction budget never lets a frame run past it
+  config.budget = {0, 50, 0.0};
+  result = batch8::Run(spriteRom, config);
+  assert(result.stop == "instructions" && result.instructions <= 50 &&
+         result.instructions + config.ipt > 50 && "instruction budget");
+
+  // a return with an empty call stack faults instead of throwing
+  const std::vector<Byte> badRom = {0x00, 0xEE};
+  result = batch8::Run(badRom, config);
+  assert(result.status == "fault" && !result.message.empty() &&
+         "fault recorded");
+
+  // every job runs exactly once, however the workers steal
+  const std::size_t jobs = 1000;
+  std::vector<std::atomic<unsigned>> runs(jobs);
+  WorkPool8 pool(4);
+  pool.Run(jobs, [&](std::size_t job, std::size_t /*worker*/) {
+    runs[job]++;
+  });
+  assert(std::all_of(runs.begin(), runs.end(),
+                     [](const auto &count) { return count == 1; }) &&
+         "each job run once");
+}
@@ -0,0 +1,45 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TEST_BATCH_RUN_H
+#define TEST_BATCH_RUN_H
+
+#include <map>
+#include <string>
+
+#include "test.h"
+
+class TestBatchRun;
+using BatchRunMemFn = void (TestBatchRun::*)();
+
+class TestBatchRun : public Test {
+public:
+  TestBatchRun() = default;
+  void runTests() override;
+
+private:
+  void batchRunTest();
+
+  const std::map<std::string, BatchRunMemFn> functionMap_ = {
+      {"Batch runs and worker pool", &TestBatchRun::batchRunTest}};
+};
+
+#endif /* TEST_BATCH_RUN_H */
@@ -0,0 +1,106 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "disassembler.h"
+#include "test_disassembler.h"
+
+void TestDisassembler::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestDisassembler::disassemblerTest() {
+  // calls a routine that stores V0 over the jump at 0x20E, then jumps there
+  // through Bnnn with V0 known; 0x206 and 0x212 are never reached
+  const std::vector<Byte> rom = {0x22, 0x08, 0x60, 0x02, 0xB2, 0x0C, 0x12,
+                                 0x06, 0xA2, 0x0E, 0xF0, 0x55, 0x00, 0xEE,
+                                 0x12, 0x10, 0x12, 0x10, 0xFF, 0xFF};
+  const auto analysis = dis8::Analyze(rom);
+
+  using Range = std::pair<Address, Address>;
+  assert((analysis.blocks.size() == 5) && (analysis.Instructions() == 8) &&
+         (analysis.blocks.at(0x200).successors ==
+          std::vector<Address>{0x202}) &&
+         (analysis.blocks.at(0x202).successors ==
+          std::vector<Address>{0x20E}) &&
+         "blocks split at calls and follow a Bnnn with V0 known");
+  assert((analysis.data == std::vector<Range>{{0x206, 0x208},
+                                              {0x212, 0x214}}) &&
+         "unreached bytes are data");
+  assert((analysis.calls.at(0x200) == std::set<Address>{0x208}) &&
+         analysis.calls.at(0x208).empty() && "call graph found");
+  assert((analysis.selfWrites.size() == 1) &&
+         (analysis.selfWrites[0].pc == 0x20A) &&
+         analysis.selfWrites[0].resolved &&
+         (analysis.selfWrites[0].target == 0x20E) &&
+         "store over code found");
+
+  // with V0 unknown, a Bnnn takes the 1nnn jumps at nnn as its table
+  const std::vector<Byte> table = {0xC0, 0x03, 0xB2, 0x04,
+                                   0x12, 0x04, 0x12, 0x06};
+  const auto tabled = dis8::Analyze(table);
+  assert((tabled.blocks.at(0x200).successors ==
+          std::vector<Address>{0x204, 0x206}) &&
+         !tabled.blocks.at(0x200).indirect && "jump table resolved");
+
+  // the skip reaches the Bnnn with V0 still 0, so the LD V0 just before it
+  // does not decide the target
+  const std::vector<Byte> joined = {0x60, 0x00, 0x31, 0x00, 0x60,
+                                    0x02, 0xB2, 0x0A, 0x00, 0x00,
+                                    0x12, 0x0A, 0x12, 0x0C};
+  const auto joinedAnalysis = dis8::Analyze(joined);
+  assert((joinedAnalysis.blocks.at(0x206).successors ==
+          std::vector<Address>{0x20A, 0x20C}) &&
+         (joinedAnalysis.data == std::vector<Range>{{0x208, 0x20A}}) &&
+         "V0 forgotten where paths join");
+
+  // the routine called in between sets V0 to 2
+  const std::vector<Byte> called = {0x60, 0x00, 0x22, 0x0A, 0xB2,
+                                    0x06, 0x12, 0x06, 0x12, 0x08,
+                                    0x60, 0x02, 0x00, 0xEE};
+  const auto calledAnalysis = dis8::Analyze(called);
+  assert((calledAnalysis.blocks.at(0x204).successors ==
+          std::vector<Address>{0x206, 0x208}) &&
+         "V0 forgotten across calls");
+
+  // the 0nnn forms are told apart by their low byte alone, as Decode does
+  const std::vector<Byte> system = {0x01, 0xEE, 0x01, 0xE0};
+  const auto systemAnalysis = dis8::Analyze(system);
+  assert(systemAnalysis.blocks.at(0x200).successors.empty() &&
+         (systemAnalysis.Instructions() == 1) && "0nEE returns");
+
+  assert((dis8::Mnemonic(0xD125) == "DRW V1, V2, 5") &&
+         (dis8::Mnemonic(0xF333) == "LD B, V3") &&
+         (dis8::Mnemonic(0x8ABE) == "SHL VA, VB") &&
+         (dis8::Mnemonic(0x01E0) == "CLS") &&
+         (dis8::Mnemonic(0x01EE) == "RET") &&
+         (dis8::Mnemonic(0x0123) == "DW 0x0123") && "mnemonics");
+}
@@ -0,0 +1,45 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TEST_DISASSEMBLER_H
+#define TEST_DISASSEMBLER_H
+
+#include <map>
+#include <string>
+
+#include "test.h"
+
+class TestDisassembler;
+using DisassemblerMemFn = void (TestDisassembler::*)();
+
+class TestDisassembler : public Test {
+public:
+  TestDisassembler() = default;
+  void runTests() override;
+
+private:
+  void disassemblerTest();
+
+  const std::map<std::string, DisassemblerMemFn> functionMap_ = {
+      {"Disassembler", &TestDisassembler::disassemblerTest}};
+};
+
+#endif /* TEST_DISASSEMBLER_H */
@@ -0,0 +1,168 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "emu8.h"
+#include "save_state.h"
+#include "test_fixture.h"
+#include "test_emu8.h"
+
+using fixture8::LoadRom;
+using fixture8::SameState;
+using fixture8::spriteRom;
+
+void TestLibrary::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestLibrary::capiTest() {
+  const std::size_t frames = 120;
+  const uint64_t seed = 5;
+  const Word keyMask = 0x4;
+
+  emu8_machine *handle = emu8_create(EMU8_LOAD_ADDRESS_DEFAULT,
+                                     EMU8_INSTRUCTIONS_PER_TICK_DEFAULT, seed);
+  assert((handle != nullptr) && "machine created");
+  assert((emu8_load_rom(handle, spriteRom.data(), spriteRom.size()) ==
+          EMU8_OK) &&
+         "ROM loaded");
+
+  Machine8 reference(Memory8::loadAddrDefault, Machine8::iptDefault, seed);
+  LoadRom(reference, spriteRom);
+
+  // frames driven through the C interface match the core exactly, and the
+  // framebuffer pointer tracks the live display
+  const uint8_t *pixels = emu8_framebuffer(handle);
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    assert((emu8_set_keys(handle, keyMask) == EMU8_OK) && "keys set");
+    assert((emu8_step_frames(handle, 1) == EMU8_OK) && "frame ran");
+    reference.RunFrame(keyMask);
+  }
+  const auto display = reference.Display().Data();
+  assert(std::equal(display.begin(), display.end(), pixels) &&
+         "framebuffer matches");
+  assert((emu8_frame_count(handle) == reference.FrameCount()) &&
+         (emu8_instruction_count(handle) == reference.InstructionCount()) &&
+         "counters match");
+
+  // states use the save file format and restore exactly
+  std::vector<Byte> saved(emu8_state_size());
+  assert((emu8_save_state(handle, saved.data(), saved.size()) == EMU8_OK) &&
+         "state saved");
+  MachineState8 state;
+  state8::Deserialize(saved, state);
+  Machine8 restored(Memory8::loadAddrDefault, Machine8::iptDefault, seed);
+  restored.LoadState(state);
+  assert(SameState(restored, reference) && "saved state matches");
+
+  assert((emu8_step_instructions(handle, frames) == EMU8_OK) && "steps ran");
+  assert((emu8_load_state(handle, saved.data(), saved.size()) == EMU8_OK) &&
+         "state loaded");
+  assert((emu8_frame_count(handle) == reference.FrameCount()) &&
+         "state restored");
+
+  // bad input is reported, never thrown across the interface
+  assert((emu8_load_state(handle, saved.data(), saved.size() - 1) ==
+          EMU8_ERROR_STATE) &&
+         "truncated state rejected");
+  assert((std::string(emu8_last_error(handle)).length() > 0) &&
+         "error described");
+  const std::vector<Byte> oversized(Memory8::memSize, 0x00);
+  assert((emu8_load_rom(handle, oversized.data(), oversized.size()) ==
+          EMU8_ERROR_ARGUMENT) &&
+         "oversized ROM rejected");
+
+  // a fault stops the machine until the next load
+  const std::vector<Byte> faultRom = {0x00, 0xEE};
+  assert((emu8_load_rom(handle, faultRom.data(), faultRom.size()) ==
+          EMU8_OK) &&
+         "fault ROM loaded");
+  assert((emu8_step_frames(handle, 1) == EMU8_ERROR_FAULT) && "fault seen");
+  assert((emu8_step_instructions(handle, 1) == EMU8_ERROR_FAULT) &&
+         "machine stays stopped");
+  assert((emu8_load_state(handle, saved.data(), saved.size()) == EMU8_OK) &&
+         (emu8_step_frames(handle, 1) == EMU8_OK) && "load clears the fault");
+
+  // observations are views of the machine itself
+  emu8_observation observation = {};
+  assert((emu8_set_ram_window(handle, 0x300, 3) == EMU8_OK) &&
+         (emu8_set_ram_window(handle, 0xFFF, 2) == EMU8_ERROR_ARGUMENT) &&
+         "RAM window checked");
+  assert((emu8_step(handle, keyMask, 2, &observation) == EMU8_OK) &&
+         (observation.framebuffer == pixels) && (observation.ram_size == 3) &&
+         (observation.frame == emu8_frame_count(handle)) &&
+         (observation.running == 1) && "step observed");
+
+  emu8_destroy(handle);
+  assert((emu8_step_frames(nullptr, 1) == EMU8_ERROR_ARGUMENT) &&
+         "null handle rejected");
+
+  // a load address past the end of memory leaves no room for a program
+  const uint16_t badAddress = 0x2000;
+  assert((emu8_create(badAddress, EMU8_INSTRUCTIONS_PER_TICK_DEFAULT, seed) ==
+          nullptr) &&
+         (emu8_create(Memory8::memSize, EMU8_INSTRUCTIONS_PER_TICK_DEFAULT,
+                      seed) == nullptr) &&
+         "out-of-range load address rejected");
+  assert((emu8_batch_create(2, spriteRom.data(), spriteRom.size(),
+                            badAddress, EMU8_INSTRUCTIONS_PER_TICK_DEFAULT,
+                            seed, 0x300, 3) == nullptr) &&
+         "out-of-range batch load address rejected");
+  try {
+    Machine8 misplaced(badAddress);
+    assert(false && "machine built past the end of memory");
+  } catch (const std::out_of_range &err) {
+    std::ignore = err;
+  }
+
+  // a batch steps every machine with its own keys
+  const std::size_t count = 4;
+  emu8_batch *batch = emu8_batch_create(
+      count, spriteRom.data(), spriteRom.size(), EMU8_LOAD_ADDRESS_DEFAULT,
+      EMU8_INSTRUCTIONS_PER_TICK_DEFAULT, seed, 0x300, 3);
+  assert((batch != nullptr) && (emu8_batch_size(batch) == count) &&
+         "batch created");
+  const emu8_observation *batchView = emu8_batch_observations(batch);
+  const std::vector<uint16_t> keys = {0x0, 0x4, 0x0, 0x4};
+  assert((emu8_batch_step(batch, keys.data(), frames) == EMU8_OK) &&
+         std::all_of(batchView, batchView + count,
+                     [&](const emu8_observation &env) {
+                       return env.frame == frames && env.running == 1;
+                     }) &&
+         "batch stepped");
+  assert((emu8_batch_reset(batch, 1) == EMU8_OK) &&
+         (batchView[1].frame == 0) &&
+         (emu8_batch_reset(batch, count) == EMU8_ERROR_ARGUMENT) &&
+         "batch reset");
+  emu8_batch_destroy(batch);
+}
@@ -0,0 +1,100 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "explorer.h"
+#include "test_fixture.h"
+#include "test_explorer.h"
+
+using fixture8::LoadRom;
+using fixture8::SameState;
+using fixture8::puzzleRom;
+using fixture8::spriteRom;
+
+void TestExplorer::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestExplorer::explorerTest() {
+  const std::size_t frames = 30;
+  const Word keyMask = 0x4;
+  const Explorer8::Goal goal = {0x300, 6};
+
+  // a clone runs on exactly like the original, and hashes like it
+  Machine8 machine;
+  Machine8 slot;
+  LoadRom(machine, spriteRom);
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    machine.RunFrame(keyMask);
+  }
+  machine.CloneInto(slot);
+  assert(SameState(machine, slot) && "clone matches");
+  assert((slot.StateHash() == machine.StateHash()) && "clone hash matches");
+
+  const auto before = alloc8::ThreadAllocations();
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    machine.CloneInto(slot);
+  }
+  assert((alloc8::ThreadAllocations() == before) && "clone alloc-free");
+
+  machine.RunFrame(keyMask);
+  slot.RunFrame(keyMask);
+  assert(SameState(machine, slot) && "clone runs on identically");
+  slot.RunFrame(0x0);
+  assert((slot.StateHash() != machine.StateHash()) && "hash follows state");
+
+  // the shortest way to 6 is 1, 2, 1, 2 (+1, x2, +1, x2)
+  for (const auto mode : {Explorer8::Mode::breadth, Explorer8::Mode::novelty}) {
+    Explorer8::Config config;
+    config.mode = mode;
+    config.goal = goal;
+    Explorer8 explorer(config);
+    const auto result = explorer.Run(puzzleRom);
+    assert(result.solved && "puzzle solved");
+    assert((result.duplicates > 0) && "duplicate states merged");
+    assert((result.covered == puzzleRom.size() / 2) && "every opcode run");
+
+    if (mode == Explorer8::Mode::breadth) {
+      assert((result.solution == std::vector<Word>{0x2, 0x4, 0x2, 0x4}) &&
+             "shortest solution");
+    }
+
+    // replaying the solution reaches the goal
+    Machine8 replay;
+    LoadRom(replay, puzzleRom);
+    for (const auto keys : result.solution) {
+      for (std::size_t frame = 0; frame < config.framesPerAction; frame++) {
+        replay.RunFrame(keys);
+      }
+    }
+    assert((replay.Memory().fetchByte(goal.addr) == goal.value) &&
+           "solution replays");
+  }
+}
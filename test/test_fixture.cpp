@@ -0,0 +1,49 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <sstream>
+#include <string>
+
+#include "machine_state.h"
+#include "test_fixture.h"
+
+void fixture8::LoadRom(Machine8 &machine, const std::vector<Byte> &rom) {
+  const std::string image(rom.begin(), rom.end());
+  std::istringstream romStream(image);
+  machine.LoadProgram(romStream);
+}
+
+auto fixture8::SameState(const Machine8 &lhs, const Machine8 &rhs) -> bool {
+  MachineState8 left;
+  MachineState8 right;
+  lhs.SaveState(left);
+  rhs.SaveState(right);
+
+  return left.memory == right.memory && left.registers == right.registers &&
+         left.callStack == right.callStack &&
+         left.stackDepth == right.stackDepth && left.regDT == right.regDT &&
+         left.regST == right.regST && left.regI == right.regI &&
+         left.pc == right.pc && left.rngState == right.rngState &&
+         left.display == right.display && left.keysHeld == right.keysHeld &&
+         left.keysPressed == right.keysPressed &&
+         left.instrTotal == right.instrTotal &&
+         left.frameTotal == right.frameTotal;
+}
@@ -0,0 +1,63 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TEST_FIXTURE_H
+#define TEST_FIXTURE_H
+
+#include <vector>
+
+#include "common.h"
+#include "machine.h"
+
+/*
+ * programs and helpers shared by the tests that run whole machines
+ */
+namespace fixture8 {
+
+// draws random sprites, calls a subroutine that shows a BCD counter with
+// the font sprites, sets both timers, and clears the screen on key 2
+inline const std::vector<Byte> spriteRom = {
+    0x00, 0xE0, 0x6A, 0x00, 0xC0, 0x3F, 0xC1, 0x1F, 0xA2, 0x30, 0xD0,
+    0x18, 0x22, 0x20, 0x7A, 0x01, 0x6C, 0x02, 0xFC, 0x15, 0xFC, 0x18,
+    0xEC, 0x9E, 0x12, 0x04, 0x00, 0xE0, 0x12, 0x04, 0x00, 0x00, 0xA3,
+    0x00, 0xFA, 0x33, 0xF2, 0x65, 0xF2, 0x55, 0xF0, 0x29, 0xDD, 0xE5,
+    0x00, 0xEE, 0x00, 0x00, 0xFF, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81,
+    0xFF};
+
+// waits for a key, then draws its digit and moves right
+inline const std::vector<Byte> keyWaitRom = {0xF0, 0x0A, 0xF0, 0x29, 0xD1,
+                                             0x25, 0x71, 0x05, 0x12, 0x00};
+
+// waits for a key: key 1 adds one to V0 and key 2 doubles it, and V0 is
+// stored at 0x300 after each press
+inline const std::vector<Byte> puzzleRom = {0xF1, 0x0A, 0x41, 0x01, 0x70,
+                                            0x01, 0x41, 0x02, 0x80, 0x04,
+                                            0xA3, 0x00, 0xF0, 0x55, 0x12,
+                                            0x00};
+
+void LoadRom(Machine8 &machine, const std::vector<Byte> &rom);
+
+// whether two machines are in exactly the same state
+auto SameState(const Machine8 &lhs, const Machine8 &rhs) -> bool;
+
+} // namespace fixture8
+
+#endif /* TEST_FIXTURE_H */
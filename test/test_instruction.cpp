@@ -68,7 +68,7 @@ static auto BuildAddressInstruction(const Byte instrNib, Address addr)
 TestInstruction::TestInstruction()
     : eng(rdev()), byteDist(BYTE_MIN, BYTE_MAX),
       validAddrDist(0, Memory8::memSize), memory_(Memory8::loadAddrDefault),
-      regSet_(), interface_("test", regSet_) {}
+      regSet_(), display_(), keypad_() {}
 
 void TestInstruction::runTests() {
   for (const auto &[desc, func] : functionMap_) {
@@ -95,7 +95,7 @@ void TestInstruction::Test00EE() {
     addr += incr;
   }
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
   const Instruction opcode = 0x00EE;
 
@@ -123,7 +123,7 @@ void TestInstruction::Test00EE() {
 void TestInstruction::Test1nnn() {
   const Byte instrId = 0x1;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   for (Address addr = 0; addr < Memory8::memSize; addr++) {
@@ -138,7 +138,7 @@ void TestInstruction::Test2nnn() {
   const Byte instrId = 0x2;
   const Address incr = 0x111;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
   while (!regSet_.callStack.empty()) {
     regSet_.callStack.pop();
@@ -169,7 +169,7 @@ void TestInstruction::Test2nnn() {
 void TestInstruction::Test3xkk() {
   const Byte hiByte = 0x30;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   // test Vx == kk
@@ -201,7 +201,7 @@ void TestInstruction::Test3xkk() {
 void TestInstruction::Test4xkk() {
   const Byte hiByte = 0x40;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   // test Vx == kk
@@ -233,7 +233,7 @@ void TestInstruction::Test4xkk() {
 void TestInstruction::Test5xy0() {
   const Byte hiByte = 0x50;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   // check Vx != Vy
@@ -281,7 +281,7 @@ void TestInstruction::Test5xy0() {
 void TestInstruction::Test6xkk() {
   const Byte hiByte = 0x60;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   for (Byte reg = 0; reg < RegisterSet8::regCount; reg++) {
@@ -299,7 +299,7 @@ void TestInstruction::Test6xkk() {
 void TestInstruction::Test7xkk() {
   const Byte hiByte = 0x70;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   for (Byte reg = 0; reg < RegisterSet8::regCount; reg++) {
@@ -335,7 +335,7 @@ void TestInstruction::Test8xy0() {
   const Byte typeCode = 0x0;
   MidRegBytes rdata{TestInstruction::arithmeticCode, typeCode, 0x0, 0x0};
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   for (Byte regX = 0; regX < RegisterSet8::regCount; regX++) {
@@ -378,7 +378,7 @@ void TestInstruction::RunArithmeticTests(const Byte typeCode,
                                          const BinaryOp &flagOp) {
   MidRegBytes rdata{TestInstruction::arithmeticCode, typeCode, 0x0, 0x0};
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   // test distinct registers and special values
@@ -596,7 +596,7 @@ void TestInstruction::Test8xyE() {
 void TestInstruction::Test9xy0() {
   const Byte hiByte = 0x90;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   // check Vx != Vy
@@ -645,7 +645,7 @@ void TestInstruction::Test9xy0() {
 void TestInstruction::TestAnnn() {
   const Byte instrId = 0xA;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   for (Address addr = 0; addr < Memory8::memSize; addr++) {
@@ -659,7 +659,7 @@ void TestInstruction::TestAnnn() {
 void TestInstruction::TestBnnn() {
   const Byte instrId = 0xB;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   for (Address addr = 0; addr < Memory8::memSize; addr++) {
@@ -673,6 +673,41 @@ void TestInstruction::TestBnnn() {
   }
 }
 
+// RND Vx, byte
+void TestInstruction::TestCxkk() {
+  const Byte hiByte = 0xC0;
+  const uint64_t seed = 0x1234;
+
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_, seed);
+  InstructionSet8 twin(regSet_, memory_, display_, keypad_, seed);
+  regSet_.pc = Memory8::loadAddrDefault;
+
+  // identical seeds must give identical sequences, restricted to mask kk
+  for (Byte reg = 0; reg < RegisterSet8::regCount; reg++) {
+    for (int kk = 0; kk <= BYTE_MAX; kk++) {
+      const auto mask = static_cast<Byte>(kk);
+      Instruction opcode = bits8::fuseBytes((hiByte | reg), mask);
+
+      iset.DecodeExecuteInstruction(opcode);
+      const auto first = regSet_.registers.at(reg);
+      twin.DecodeExecuteInstruction(opcode);
+      const auto second = regSet_.registers.at(reg);
+
+      assert((first == second) && "Reproducible random byte 0xCxkk");
+      assert(((first & ~mask) == 0) && "Random byte masked by kk 0xCxkk");
+    }
+  }
+
+  // restoring a saved generator state must replay the same bytes
+  const auto state = iset.Rng().GetState();
+  const Instruction opcode = 0xC0FF;
+  iset.DecodeExecuteInstruction(opcode);
+  const auto before = regSet_.registers.at(0);
+  iset.Rng().SetState(state);
+  iset.DecodeExecuteInstruction(opcode);
+  assert((regSet_.registers.at(0) == before) && "Restored RNG state 0xCxkk");
+}
+
 void TestInstruction::TestBlockF() {
   TestFx07();
   TestFx15();
@@ -689,7 +724,7 @@ void TestInstruction::TestFx07() {
   const Byte hiByte = 0xF0;
   const Byte lowByte = 0x07;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   for (Byte reg = 0; reg < RegisterSet8::regCount; reg++) {
@@ -708,7 +743,7 @@ void TestInstruction::TestFx15() {
   const Byte hiByte = 0xF0;
   const Byte lowByte = 0x15;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   for (Byte reg = 0; reg < RegisterSet8::regCount; reg++) {
@@ -727,7 +762,7 @@ void TestInstruction::TestFx18() {
   const Byte hiByte = 0xF0;
   const Byte lowByte = 0x18;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   for (Byte reg = 0; reg < RegisterSet8::regCount; reg++) {
@@ -746,7 +781,7 @@ void TestInstruction::TestFx1E() {
   const Byte hiByte = 0xF0;
   const Byte lowByte = 0x1E;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   const std::size_t testIter = 1000;
@@ -775,7 +810,7 @@ void TestInstruction::TestFx29() {
   const Byte hiByte = 0xF0;
   const Byte lowByte = 0x29;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
 
   // test valid sprites
@@ -818,7 +853,7 @@ void TestInstruction::TestFx33() {
   const Byte lowByte = 0x33;
   const Byte places = 3;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
   regSet_.regI = Memory8::loadAddrDefault;
 
@@ -845,7 +880,7 @@ void TestInstruction::TestFx55() {
   const Byte hiByte = 0xF0;
   const Byte lowByte = 0x55;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
   regSet_.regI = Memory8::loadAddrDefault;
 
@@ -874,7 +909,7 @@ void TestInstruction::TestFx65() {
   const Byte hiByte = 0xF0;
   const Byte lowByte = 0x65;
 
-  InstructionSet8 iset(regSet_, memory_, interface_);
+  InstructionSet8 iset(regSet_, memory_, display_, keypad_);
   regSet_.pc = Memory8::loadAddrDefault;
   regSet_.regI = Memory8::loadAddrDefault;
 
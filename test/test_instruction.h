@@ -24,10 +24,12 @@
 
 #include <functional>
 #include <map>
+#include <random>
 #include <set>
 
+#include "frame_buffer.h"
 #include "instruction_set.h"
-#include "interface.h"
+#include "keypad.h"
 #include "memory.h"
 #include "register_set.h"
 #include "test.h"
@@ -68,6 +70,7 @@ private:
   void Test9xy0();
   void TestAnnn();
   void TestBnnn();
+  void TestCxkk();
 
   void TestBlockF();
   void TestFx07();
@@ -89,7 +92,8 @@ private:
 
   Memory8 memory_;
   RegisterSet8 regSet_;
-  Interface8 interface_;
+  FrameBuffer8 display_;
+  Keypad8 keypad_;
 
   const std::map<std::string, InstructionMemFn> functionMap_ = {
       {"Instruction 00EE", &TestInstruction::Test00EE},
@@ -104,6 +108,7 @@ private:
       {"Instruction 9xy0", &TestInstruction::Test9xy0},
       {"Instruction Annn", &TestInstruction::TestAnnn},
       {"Instruction Bnnn", &TestInstruction::TestBnnn},
+      {"Instruction Cxkk", &TestInstruction::TestCxkk},
       {"Instruction Block F000", &TestInstruction::TestBlockF}};
 };
 
@@ -0,0 +1,197 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+#include "alloc_counter.h"
+#include "environment.h"
+#include "test_lockstep.h"
+
+void TestLockstep::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestLockstep::CheckLanes(const Lockstep8 &engine,
+                              const std::vector<Byte> &rom,
+                              std::size_t frames) {
+  for (std::size_t lane = 0; lane < engine.Lanes(); lane++) {
+    auto machine = std::make_unique<Machine8>(
+        Memory8::loadAddrDefault, Machine8::iptDefault, LaneSeed(lane));
+    machine->LoadProgram(rom);
+    for (std::size_t frame = 0; frame < frames; frame++) {
+      machine->RunFrame(LaneKeys(lane, frame));
+    }
+
+    MachineState8 expected;
+    MachineState8 actual;
+    machine->SaveState(expected);
+    engine.SaveLane(lane, actual);
+
+    assert(actual.memory == expected.memory &&
+           actual.registers == expected.registers &&
+           actual.callStack == expected.callStack &&
+           actual.stackDepth == expected.stackDepth &&
+           actual.regDT == expected.regDT && actual.regST == expected.regST &&
+           actual.regI == expected.regI && actual.pc == expected.pc &&
+           actual.rngState == expected.rngState &&
+           actual.display == expected.display &&
+           actual.keysHeld == expected.keysHeld &&
+           actual.keysPressed == expected.keysPressed &&
+           actual.instrTotal == expected.instrTotal &&
+           actual.frameTotal == expected.frameTotal &&
+           "lane matches machine");
+  }
+}
+
+void TestLockstep::matchesMachineTest() {
+  const std::size_t frames = 240;
+  Lockstep8::Stats totals;
+
+  for (const auto *rom : {&aluRom_, &spriteRom_}) {
+    Lockstep8 engine(laneCount_);
+    engine.LoadProgram(*rom);
+    for (std::size_t lane = 0; lane < laneCount_; lane++) {
+      engine.Seed(lane, LaneSeed(lane));
+    }
+
+    std::vector<Word> keys(laneCount_);
+    for (std::size_t frame = 0; frame < frames; frame++) {
+      for (std::size_t lane = 0; lane < laneCount_; lane++) {
+        keys[lane] = LaneKeys(lane, frame);
+      }
+      engine.RunFrame(keys);
+    }
+
+    CheckLanes(engine, *rom, frames);
+
+    const auto &stats = engine.GetStats();
+    assert(stats.convergedSteps > 0 && stats.convergedSteps < stats.steps &&
+           "lanes diverge and reconverge");
+    totals.vectorGroups += stats.vectorGroups;
+    totals.scalarGroups += stats.scalarGroups;
+  }
+
+  assert(totals.vectorGroups > 0 && totals.scalarGroups > 0 &&
+         "vector and scalar execution both used");
+}
+
+void TestLockstep::faultIsolationTest() {
+  Lockstep8 engine(laneCount_);
+  engine.LoadProgram(spriteRom_);
+  for (std::size_t lane = 0; lane < laneCount_; lane++) {
+    engine.Seed(lane, LaneSeed(lane));
+  }
+
+  // send one lane off the end of memory
+  const std::size_t badLane = 5;
+  MachineState8 state;
+  engine.SaveLane(badLane, state);
+  state.pc = Memory8::memSize - 1;
+  engine.LoadLane(badLane, state);
+
+  const std::size_t frames = 60;
+  std::vector<Word> keys(laneCount_);
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    for (std::size_t lane = 0; lane < laneCount_; lane++) {
+      keys[lane] = LaneKeys(lane, frame);
+    }
+    engine.RunFrame(keys);
+  }
+
+  assert(!engine.Running(badLane) && !engine.Fault(badLane).empty() &&
+         "faulting lane stopped");
+  for (std::size_t lane = 0; lane < laneCount_; lane++) {
+    assert((lane == badLane || engine.Running(lane)) &&
+           "other lanes unaffected");
+  }
+}
+
+void TestLockstep::environmentBatchTest() {
+  const std::size_t frames = 60;
+  const std::size_t frameSkip = 4;
+  const uint64_t seed = 11;
+  const RamWindow8 window = {0x300, 3}; // the BCD digits spriteRom_ writes
+
+  EnvironmentBatch8 batch(laneCount_, spriteRom_, window,
+                          Memory8::loadAddrDefault, Machine8::iptDefault,
+                          seed);
+  const auto observations = batch.Observations();
+  const Byte *firstDisplay = observations.front().display.data();
+
+  std::vector<Word> keys(laneCount_);
+  const auto before = alloc8::ThreadAllocations();
+  for (std::size_t frame = 0; frame < frames; frame += frameSkip) {
+    for (std::size_t env = 0; env < laneCount_; env++) {
+      keys[env] = LaneKeys(env, frame);
+    }
+    std::ignore = batch.Step(keys, frameSkip);
+  }
+  assert((alloc8::ThreadAllocations() == before) && "batch step alloc-free");
+  assert((observations.front().display.data() == firstDisplay) &&
+         "observations are stable views");
+
+  // each environment sees exactly what a lone environment would
+  for (std::size_t env = 0; env < laneCount_; env++) {
+    Environment8 single(spriteRom_, window, Memory8::loadAddrDefault,
+                        Machine8::iptDefault, seed + env);
+    for (std::size_t frame = 0; frame < frames; frame += frameSkip) {
+      std::ignore = single.Step(LaneKeys(env, frame), frameSkip);
+    }
+
+    const auto &expected = single.Observation();
+    const auto &actual = observations[env];
+    assert(std::ranges::equal(actual.display, expected.display) &&
+           std::ranges::equal(actual.ram, expected.ram) &&
+           actual.frame == expected.frame && actual.sound == expected.sound &&
+           actual.running && "environment matches");
+    assert((actual.ram.size() == window.size) && "RAM window sized");
+  }
+
+  // a reset environment starts over while the rest carry on
+  batch.Reset(0);
+  assert((observations.front().frame == 0) && "environment reset");
+  assert((observations.back().frame == frames) && "others untouched");
+
+  // a load address outside memory is refused before anything is built
+  try {
+    EnvironmentBatch8 misplaced(laneCount_, spriteRom_, window,
+                                Memory8::memSize, Machine8::iptDefault, seed);
+    assert(false && "batch built past the end of memory");
+  } catch (const std::invalid_argument &err) {
+    std::ignore = err;
+  }
+  try {
+    Environment8 misplaced(spriteRom_, window, Memory8::memSize,
+                           Machine8::iptDefault, seed);
+    assert(false && "environment built past the end of memory");
+  } catch (const std::invalid_argument &err) {
+    std::ignore = err;
+  }
+}
@@ -0,0 +1,86 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TEST_LOCKSTEP_H
+#define TEST_LOCKSTEP_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "lockstep.h"
+#include "machine.h"
+#include "test.h"
+
+class TestLockstep;
+using LockstepMemFn = void (TestLockstep::*)();
+
+class TestLockstep : public Test {
+public:
+  TestLockstep() = default;
+  void runTests() override;
+
+private:
+  void matchesMachineTest();
+  void faultIsolationTest();
+  void environmentBatchTest();
+
+  // run the same program on one Machine8 per lane, with the same seeds and
+  // keys, and check every lane against its machine
+  static void CheckLanes(const Lockstep8 &engine,
+                         const std::vector<Byte> &rom, std::size_t frames);
+
+  static auto LaneSeed(std::size_t lane) -> uint64_t { return lane * 7919; }
+  static auto LaneKeys(std::size_t lane, std::size_t frame) -> Word {
+    return static_cast<Word>(1U << ((lane + frame / 8) % Keypad8::keyCount));
+  }
+
+  static constexpr std::size_t laneCount_ = 37;
+
+  // register arithmetic with data-dependent skips, so lanes diverge and
+  // reconverge every pass
+  const std::vector<Byte> aluRom_ = {
+      0xC0, 0xFF, 0xC1, 0xFF, 0x80, 0x14, 0x82, 0x15, 0x80, 0x16, 0x81,
+      0x1E, 0x80, 0x17, 0x81, 0x21, 0x82, 0x02, 0x83, 0x03, 0x8F, 0x14,
+      0x4F, 0x00, 0x75, 0x01, 0x52, 0x30, 0x90, 0x10, 0x66, 0x11, 0xF6,
+      0x15, 0xF7, 0x07, 0xA3, 0x00, 0xF5, 0x1E, 0x60, 0x00, 0xB2, 0x2E,
+      0x00, 0x00, 0x12, 0x00};
+
+  // random sprites, a BCD subroutine, timers, and a key-dependent clear; the
+  // clear and the return are spelled 01E0 and 0FEE, which only the low byte
+  // tells apart from the other 0nnn forms
+  const std::vector<Byte> spriteRom_ = {
+      0x00, 0xE0, 0x6A, 0x00, 0xC0, 0x3F, 0xC1, 0x1F, 0xA2, 0x30, 0xD0,
+      0x18, 0x22, 0x20, 0x7A, 0x01, 0x6C, 0x02, 0xFC, 0x15, 0xFC, 0x18,
+      0xEC, 0x9E, 0x12, 0x04, 0x01, 0xE0, 0x12, 0x04, 0x00, 0x00, 0xA3,
+      0x00, 0xFA, 0x33, 0xF2, 0x65, 0xF2, 0x55, 0xF0, 0x29, 0xDD, 0xE5,
+      0x0F, 0xEE, 0x00, 0x00, 0xFF, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81,
+      0xFF};
+
+  const std::map<std::string, LockstepMemFn> functionMap_ = {
+      {"Lockstep lanes match machines", &TestLockstep::matchesMachineTest},
+      {"Lockstep fault isolation", &TestLockstep::faultIsolationTest},
+      {"Environment batch observations",
+       &TestLockstep::environmentBatchTest}};
+};
+
+#endif /* TEST_LOCKSTEP_H */
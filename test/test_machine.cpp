@@ -0,0 +1,92 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+
+#include "alloc_counter.h"
+#include "test_fixture.h"
+#include "test_machine.h"
+
+using fixture8::LoadRom;
+using fixture8::keyWaitRom;
+using fixture8::spriteRom;
+
+void TestMachine::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestMachine::allocationFreeTest() {
+  for (const auto *rom : {&spriteRom, &keyWaitRom}) {
+    Machine8 machine;
+    LoadRom(machine, *rom);
+
+    // cycle through every key so all input paths are exercised
+    auto keyMask = [](std::size_t frame) {
+      return static_cast<Word>(1U << (frame % Keypad8::keyCount));
+    };
+
+    for (std::size_t frame = 0; frame < warmupFrames_; frame++) {
+      machine.RunFrame(keyMask(frame));
+    }
+
+    const auto before = alloc8::ThreadAllocations();
+    for (std::size_t frame = 0; frame < measuredFrames_; frame++) {
+      machine.RunFrame(keyMask(frame));
+      machine.Display().ClearDirty();
+    }
+    const auto allocs = alloc8::ThreadAllocations() - before;
+
+    assert((allocs == 0) && "no allocations in steady-state frames");
+  }
+}
+
+void TestMachine::keyWaitTest() {
+  Machine8 machine;
+  LoadRom(machine, keyWaitRom);
+
+  const Byte delay = 0x10;
+  const Byte keyVal = 0x5;
+  auto &regs = machine.Registers();
+  regs.regDT = delay;
+
+  // with no key held the machine must stay on Fx0A, but timers keep running
+  const std::size_t idleFrames = 4;
+  for (std::size_t frame = 0; frame < idleFrames; frame++) {
+    machine.RunFrame(0x0);
+  }
+  assert((regs.pc == Memory8::loadAddrDefault) && "waiting on Fx0A");
+  assert((regs.regDT == delay - idleFrames) && "timers run during Fx0A");
+
+  // a newly pressed key is stored and execution continues
+  const auto keyMask = static_cast<Word>(1U << keyVal);
+  machine.RunFrame(keyMask);
+  assert((regs.registers.at(0) == keyVal) && "key stored by Fx0A");
+
+  // holding the key is not a new press, so the next Fx0A waits again
+  machine.RunFrame(keyMask);
+  assert((regs.pc == Memory8::loadAddrDefault) && "held key not re-read");
+}
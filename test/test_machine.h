@@ -0,0 +1,50 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TEST_MACHINE_H
+#define TEST_MACHINE_H
+
+#include <map>
+#include <string>
+
+#include "test.h"
+
+class TestMachine;
+using MachineMemFn = void (TestMachine::*)();
+
+class TestMachine : public Test {
+public:
+  TestMachine() = default;
+  void runTests() override;
+
+private:
+  void allocationFreeTest();
+  void keyWaitTest();
+
+  static constexpr std::size_t warmupFrames_ = 10;
+  static constexpr std::size_t measuredFrames_ = 3600;
+
+  const std::map<std::string, MachineMemFn> functionMap_ = {
+      {"Headless allocation-free frames", &TestMachine::allocationFreeTest},
+      {"Non-blocking key wait", &TestMachine::keyWaitTest}};
+};
+
+#endif /* TEST_MACHINE_H */
@@ -0,0 +1,76 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+
+#include "alloc_counter.h"
+#include "machine_pool.h"
+#include "test_fixture.h"
+#include "test_machine_pool.h"
+
+using fixture8::LoadRom;
+using fixture8::SameState;
+using fixture8::spriteRom;
+
+void TestMachinePool::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestMachinePool::machinePoolTest() {
+  const std::size_t count = 50;
+  const std::size_t frames = 60;
+  const uint64_t seed = 3;
+
+  // machines own no heap memory, so they can live wholly in an arena
+  const auto before = alloc8::ThreadAllocations();
+  MachinePool8 pool(count, Memory8::loadAddrDefault, Machine8::iptDefault,
+                    seed, true);
+  assert((alloc8::ThreadAllocations() == before) && "pool alloc-free");
+  assert((pool.GetArena().Bytes() >= count * sizeof(Machine8)) &&
+         "pool sized");
+
+  pool.LoadProgram(spriteRom);
+  for (std::size_t index = 0; index < count; index++) {
+    const auto addr = reinterpret_cast<uintptr_t>(&pool.At(index)); // NOLINT
+    assert((addr % Arena8::cacheLine == 0) && "slot aligned");
+
+    for (std::size_t frame = 0; frame < frames; frame++) {
+      pool.At(index).RunFrame(0x0);
+    }
+  }
+
+  // every machine runs just like a standalone one with its seed
+  for (std::size_t index = 0; index < count; index += count / 5) {
+    Machine8 reference(Memory8::loadAddrDefault, Machine8::iptDefault,
+                       seed + index);
+    LoadRom(reference, spriteRom);
+    for (std::size_t frame = 0; frame < frames; frame++) {
+      reference.RunFrame(0x0);
+    }
+    assert(SameState(pool.At(index), reference) && "pooled machine matches");
+  }
+}
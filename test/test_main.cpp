@@ -23,9 +23,29 @@
 #include <vector>
 
 #include "test.h"
+#include "test_batch_run.h"
 #include "test_bits.h"
+#include "test_disassembler.h"
+#include "test_emu8.h"
+#include "test_explorer.h"
 #include "test_instruction.h"
+#include "test_lockstep.h"
+#include "test_machine.h"
+#include "test_machine_pool.h"
 #include "test_mem.h"
+#include "test_metrics.h"
+#include "test_movie.h"
+#include "test_perf_counters.h"
+#include "test_profiler.h"
+#include "test_rewind.h"
+#include "test_rom_bench.h"
+#include "test_run_ahead.h"
+#include "test_save_state.h"
+#include "test_server.h"
+#include "test_shared_state.h"
+#include "test_speculator.h"
+#include "test_timeline.h"
+#include "test_trace.h"
 
 auto main() -> int {
 
@@ -33,10 +53,50 @@ auto main() -> int {
   TestBits tbits;
   TestMemory tmem;
   TestInstruction tinstr;
+  TestMachine tmachine;
+  TestSaveState tsavestate;
+  TestRewind trewind;
+  TestMovie tmovie;
+  TestRunAhead trunahead;
+  TestSpeculator tspeculator;
+  TestBatchRun tbatchrun;
+  TestLockstep tlockstep;
+  TestLibrary tlibrary;
+  TestExplorer texplorer;
+  TestMachinePool tmachinepool;
+  TestServer tserver;
+  TestSharedState tsharedstate;
+  TestRomBench trombench;
+  TestProfiler tprofiler;
+  TestTrace ttrace;
+  TestTimeline ttimeline;
+  TestPerfCounters tperfcounters;
+  TestMetrics tmetrics;
+  TestDisassembler tdisassembler;
 
   testPtrs.push_back(&tbits);
   testPtrs.push_back(&tmem);
   testPtrs.push_back(&tinstr);
+  testPtrs.push_back(&tmachine);
+  testPtrs.push_back(&tsavestate);
+  testPtrs.push_back(&trewind);
+  testPtrs.push_back(&tmovie);
+  testPtrs.push_back(&trunahead);
+  testPtrs.push_back(&tspeculator);
+  testPtrs.push_back(&tbatchrun);
+  testPtrs.push_back(&tlockstep);
+  testPtrs.push_back(&tlibrary);
+  testPtrs.push_back(&texplorer);
+  testPtrs.push_back(&tmachinepool);
+  testPtrs.push_back(&tserver);
+  testPtrs.push_back(&tsharedstate);
+  testPtrs.push_back(&trombench);
+  testPtrs.push_back(&tprofiler);
+  testPtrs.push_back(&ttrace);
+  testPtrs.push_back(&ttimeline);
+  testPtrs.push_back(&tperfcounters);
+  testPtrs.push_back(&tmetrics);
+  testPtrs.push_back(&tdisassembler);
 
   for (const auto &ptr : testPtrs) {
     ptr->runTests();
@@ -194,6 +194,62 @@ void TestMemory::inverseGetSetSequenceTest() {
            "equal sequence contents");
   }
 }
+
+void TestMemory::viewSequenceBoundsTest() {
+  Memory8 mem{Memory8::loadAddrDefault};
+  const Word size = 0x10;
+
+  // testing bad bounds (should throw), including ranges that run off the end
+  std::vector<Address> badStarts = badAddrBounds;
+  badStarts.push_back(Memory8::memSize - size + 1);
+  for (const auto &addr : badStarts) {
+    try {
+      std::ignore = mem.viewSequence(addr, size);
+      throw std::runtime_error("Invalid memory view permitted");
+    } catch (const std::out_of_range &err) {
+      std::ignore = err;
+    }
+
+    try {
+      std::ignore = mem.mutableSequence(addr, size);
+      throw std::runtime_error("Invalid mutable memory view permitted");
+    } catch (const std::out_of_range &err) {
+      std::ignore = err;
+    }
+  }
+
+  // good bounds determined by length of sequence
+  const auto low = mem.viewSequence(Memory8::loadAddrDefault, size);
+  const auto high = mem.mutableSequence(Memory8::memSize - size, size);
+  assert((low.size() == size) && "view length matches request");
+  assert((high.size() == size) && "mutable view length matches request");
+}
+
+void TestMemory::viewAliasingTest() {
+  Memory8 mem{Memory8::loadAddrDefault};
+
+  for (std::size_t i = 0; i < randomTestCount_; i++) {
+    const Address addr =
+        static_cast<Address>(byteDist(eng)) + Memory8::loadAddrDefault;
+    const Word vsize = static_cast<Word>(byteDist(eng)) + 1;
+
+    // writes through a mutable view must be visible to every read path
+    const auto dest = mem.mutableSequence(addr, vsize);
+    std::generate(dest.begin(), dest.end(), [this]() { return byteDist(eng); });
+
+    const auto view = mem.viewSequence(addr, vsize);
+    assert(std::equal(view.begin(), view.end(), dest.begin()) &&
+           "view reflects mutable view contents");
+
+    for (Word off = 0; off < vsize; off++) {
+      const auto curr = static_cast<Address>(addr + off);
+      assert((mem.fetchByte(curr) == mem.fetchByteUnchecked(curr)) &&
+             "checked and unchecked fetch agree");
+      assert((mem.fetchByte(curr) == view[off]) && "view aliases memory");
+    }
+  }
+}
+
 // test program loading and dumping via string streams
 
 // test load/dump inverse property via arrays/vectors
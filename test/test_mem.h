@@ -46,6 +46,8 @@ private:
   void setSequenceBoundsTest();
   void inverseGetSetSingleTest();
   void inverseGetSetSequenceTest();
+  void viewSequenceBoundsTest();
+  void viewAliasingTest();
 
   std::random_device rdev = {};
   std::default_random_engine eng;
@@ -70,7 +72,9 @@ private:
       {"Sequence set bounds", &TestMemory::setSequenceBoundsTest},
       {"Inverse get-set single byte", &TestMemory::inverseGetSetSingleTest},
       {"Inverse get-set byte sequence",
-       &TestMemory::inverseGetSetSequenceTest}};
+       &TestMemory::inverseGetSetSequenceTest},
+      {"Sequence view bounds", &TestMemory::viewSequenceBoundsTest},
+      {"Sequence view aliasing", &TestMemory::viewAliasingTest}};
 };
 
 #endif /* TEST_MEM_H */
@@ -0,0 +1,74 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "metrics.h"
+#include "test_metrics.h"
+
+void TestMetrics::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestMetrics::metricsTest() {
+  const std::string name =
+      "/emu8-metrics-test-" + std::to_string(::getpid()); // NOLINT
+  const auto self = static_cast<uint32_t>(::getpid());
+  const uint64_t presented = 3;
+
+  {
+    auto first = std::make_unique<MetricsExport8>(name);
+    MetricsExport8 second(name);
+    const MetricsView8 view(name);
+    const auto &page = view.Page();
+    assert((page.instances.load() == 2) &&
+           (&first->Slot() != &second.Slot()) &&
+           (page.slot[0].pid.load() == self) &&
+           "each instance claims a slot of the shared page");
+
+    // counters are visible to the agent in place, and stay readable after
+    // their instance exits
+    MetricsSlot8::Add(first->Slot().framesPresented, presented);
+    first.reset();
+    assert((page.instances.load() == 1) && (page.slot[0].pid.load() == 0) &&
+           (page.slot[0].lastPid.load() == self) &&
+           (page.slot[0].framesPresented.load() == presented) &&
+           "an exited instance leaves its counters");
+
+    // a new instance takes an unused slot before an exited one
+    const MetricsExport8 third(name);
+    assert((page.slot[2].pid.load() == self) &&
+           (page.slot[0].framesPresented.load() == presented) &&
+           "exited counters are reused last");
+  }
+
+  ::shm_unlink(name.c_str());
+}
@@ -0,0 +1,113 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "hash.h"
+#include "movie.h"
+#include "test_fixture.h"
+#include "test_movie.h"
+
+using fixture8::SameState;
+using fixture8::keyWaitRom;
+using fixture8::spriteRom;
+
+void TestMovie::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestMovie::movieReplayTest() {
+  const uint64_t seed = 0x5EED;
+  const std::size_t frames = 600;
+  const std::size_t holdFrames = 45;
+
+  Machine8 original(Memory8::loadAddrDefault, Machine8::iptDefault, seed);
+  original.LoadProgram(spriteRom);
+  movie8::Movie movie(hash8::Fnv1a(spriteRom), seed,
+                      original.GetMemBase(), original.GetInstructionsPerTick());
+
+  // hold each key for a while, including key 2 which clears the screen
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    const auto key = (frame / holdFrames) % Keypad8::keyCount;
+    const auto keyMask = static_cast<Word>(1U << key);
+    movie.Append(keyMask);
+    original.RunFrame(keyMask);
+  }
+
+  std::vector<Byte> image;
+  movie.Serialize(image);
+  const auto runs = (frames + holdFrames - 1) / holdFrames;
+  assert((image.size() == movie8::headerSize + (runs * 2 * sizeof(Word))) &&
+         "movie runs are length-coded");
+
+  const auto decoded = movie8::Movie::Deserialize(image);
+  Machine8 replayed(decoded.MemBase(), decoded.Ipt(), decoded.Seed());
+  movie8::Play(replayed, decoded, spriteRom);
+  assert(SameState(original, replayed) && "replay matches recorded run");
+
+  // a movie never plays against a different ROM
+  Machine8 other(decoded.MemBase(), decoded.Ipt(), decoded.Seed());
+  try {
+    movie8::Play(other, decoded, keyWaitRom);
+    assert(false && "movie played on the wrong ROM");
+  } catch (const std::runtime_error &err) {
+    std::ignore = err;
+  }
+
+  // a header claiming more frames than its runs hold is refused before
+  // anything is allocated for them
+  const std::size_t frameCountOffset = 32;
+  std::vector<Byte> inflated(image.begin(),
+                             image.begin() + movie8::headerSize);
+  std::fill_n(inflated.begin() + frameCountOffset, 2 * sizeof(uint32_t),
+              Byte{0x00});
+  std::fill_n(inflated.begin() + frameCountOffset, sizeof(uint32_t),
+              Byte{0xFF});
+  try {
+    std::ignore = movie8::Movie::Deserialize(inflated);
+    assert(false && "oversized frame count accepted");
+  } catch (const std::runtime_error &err) {
+    std::ignore = err;
+  }
+
+  // so is a clock rate that would run nothing, or run one frame for ages
+  const std::size_t iptOffset = 12;
+  for (const Byte fill : {Byte{0x00}, Byte{0xFF}}) {
+    std::vector<Byte> clocked = image;
+    std::fill_n(clocked.begin() + iptOffset, sizeof(uint32_t), fill);
+    try {
+      std::ignore = movie8::Movie::Deserialize(clocked);
+      assert(false && "out-of-range clock rate accepted");
+    } catch (const std::runtime_error &err) {
+      std::ignore = err;
+    }
+  }
+}
@@ -0,0 +1,70 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+
+#include "perf_counters.h"
+#include "rom_bench.h"
+#include "test_fixture.h"
+#include "test_perf_counters.h"
+
+using fixture8::spriteRom;
+
+void TestPerfCounters::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestPerfCounters::perfCountersTest() {
+  const std::size_t frames = 30;
+
+  assert((PerfCounters8::Difference({5, 7, 0, 2}, {3, 7, 1, 0}) ==
+          PerfCounters8::Counts{2, 0, 0, 2}) &&
+         "differences never wrap");
+
+  // most virtual machines and containers have no counters to open
+  std::unique_ptr<PerfCounters8> counters;
+  try {
+    counters = std::make_unique<PerfCounters8>();
+  } catch (const std::runtime_error &err) {
+    return;
+  }
+
+  rombench8::Config config;
+  config.frames = frames;
+  config.counters = counters.get();
+  const auto report = rombench8::Run(spriteRom, config);
+
+  const auto classTotal = std::accumulate(report.classInstructions.begin(),
+                                          report.classInstructions.end(),
+                                          uint64_t{0});
+  assert(report.counted && (classTotal == report.instructions) &&
+         (report.events[PerfCounters8::instructions] > report.instructions) &&
+         "every emulated instruction is counted once, in its class");
+}
@@ -0,0 +1,145 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "profiler.h"
+#include "run_ahead.h"
+#include "test_fixture.h"
+#include "test_profiler.h"
+
+using fixture8::LoadRom;
+using fixture8::spriteRom;
+
+void TestProfiler::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestProfiler::profilerTest() {
+  const std::size_t frames = 30;
+  const Word keyMask = 0x4;
+
+  assert((Profiler8::ClassName(Profiler8::Classify(0x8AB4)) == "8xy4") &&
+         (Profiler8::ClassName(Profiler8::Classify(0xF355)) == "Fx55") &&
+         (Profiler8::ClassName(Profiler8::Classify(0xD125)) == "Dxyn") &&
+         (Profiler8::Classify(0x0123) == Profiler8::invalidClass) &&
+         (Profiler8::Classify(0xE1FF) == Profiler8::invalidClass) &&
+         "opcodes classify as they decode");
+
+  // profiling only observes the machine, never changes how it runs
+  Machine8 plain;
+  Machine8 profiled;
+  auto profiler = std::make_unique<Profiler8>();
+  LoadRom(plain, spriteRom);
+  LoadRom(profiled, spriteRom);
+  profiled.SetProfiler(profiler.get());
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    plain.RunFrame(keyMask);
+    profiled.RunFrame(keyMask);
+  }
+  assert((plain.StateHash() == profiled.StateHash()) && "profiling is passive");
+
+  uint64_t classTotal = 0;
+  for (std::size_t opClass = 0; opClass < Profiler8::classCount; opClass++) {
+    classTotal += profiler->ClassCount(opClass);
+  }
+  const auto &executes = profiler->Executes();
+  assert((profiler->Instructions() == profiled.InstructionCount()) &&
+         (classTotal == profiler->Instructions()) &&
+         (std::accumulate(executes.begin(), executes.end(), uint64_t{0}) ==
+          profiler->Instructions()) &&
+         "every instruction is counted once");
+
+  // the sprite rows drawn are counted as reads
+  const auto &reads = profiler->Reads();
+  assert((profiler->ClassCount(Profiler8::Classify(0xD000)) > 0) &&
+         (std::accumulate(reads.begin(), reads.end(), uint64_t{0}) > 0) &&
+         "draws read memory");
+
+  std::ostringstream image;
+  profiler->HeatMap(image);
+  const std::string header = "P6\n64 64\n255\n";
+  assert((image.str().size() == header.size() + 3 * Memory8::memSize) &&
+         (image.str().compare(0, header.size(), header) == 0) &&
+         "heat map is a 64x64 image");
+}
+
+void TestProfiler::callGraphTest() {
+  // main calls 0x206 twice, which calls 0x20C each time, then loops
+  const std::vector<Byte> rom = {0x22, 0x06, 0x22, 0x06, 0x12, 0x04,
+                                 0x60, 0x01, 0x22, 0x0C, 0x00, 0xEE,
+                                 0x70, 0x01, 0x00, 0xEE};
+  const std::size_t frames = 2;
+
+  Machine8 machine;
+  auto profiler = std::make_unique<Profiler8>();
+  std::istringstream symbols("# routines\n206 outer\n\n");
+  profiler->LoadSymbols(symbols);
+  LoadRom(machine, rom);
+  machine.SetProfiler(profiler.get());
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    machine.RunFrame(0x0);
+  }
+
+  // calls count towards the caller and returns towards the callee
+  std::ostringstream folded;
+  profiler->FoldedStacks(folded, Profiler8::Weight::instructions);
+  assert((folded.str() == "main 4\nmain;outer 6\nmain;outer;sub_20C 4\n") &&
+         "instructions folded by call stack");
+
+  // run-ahead previews, which leave and re-enter calls, change nothing
+  Machine8 previewed;
+  auto shadow = std::make_unique<Profiler8>();
+  std::istringstream sameSymbols(symbols.str());
+  shadow->LoadSymbols(sameSymbols);
+  LoadRom(previewed, rom);
+  previewed.SetProfiler(shadow.get());
+  RunAhead8 runAhead(RunAhead8::maxFrames);
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    std::ignore = runAhead.Preview(previewed, 0x0);
+    previewed.RunFrame(0x0);
+  }
+  std::ostringstream shadowFolded;
+  shadow->FoldedStacks(shadowFolded, Profiler8::Weight::instructions);
+  assert((shadowFolded.str() == folded.str()) && "previews not profiled");
+
+  std::istringstream badSymbol("1000 past_the_end\n");
+  bool thrown = false;
+  try {
+    profiler->LoadSymbols(badSymbol);
+  } catch (const std::invalid_argument &err) {
+    thrown = true;
+  }
+  assert(thrown && "symbols must lie in RAM");
+}
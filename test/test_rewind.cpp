@@ -0,0 +1,83 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "rewind.h"
+#include "test_fixture.h"
+#include "test_rewind.h"
+
+using fixture8::LoadRom;
+using fixture8::SameState;
+using fixture8::spriteRom;
+
+void TestRewind::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestRewind::rewindTest() {
+  const std::size_t maxFrames = 150;
+  const std::size_t frames = 400;
+
+  Machine8 machine;
+  LoadRom(machine, spriteRom);
+  Rewind8 rewind(maxFrames);
+
+  std::vector<MachineState8> history(frames);
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    machine.RunFrame(static_cast<Word>(frame));
+    rewind.Record(machine);
+    machine.SaveState(history.at(frame));
+  }
+
+  // old frames are dropped, and deltas keep well under full-state size
+  const auto kept = rewind.FrameCount();
+  assert((kept > 0 && kept <= maxFrames) && "rewind frame count bounded");
+  assert((rewind.BytesUsed() <= rewind.Capacity()) && "rewind byte budget");
+  assert((rewind.BytesUsed() < kept * sizeof(MachineState8)) &&
+         "rewind frames delta compressed");
+
+  // every step back must land exactly on the recorded earlier frame
+  Machine8 expected;
+  for (std::size_t step = 1; step < kept; step++) {
+    assert(rewind.StepBack(machine) && "rewind step available");
+    expected.LoadState(history.at(frames - 1 - step));
+    assert(SameState(machine, expected) && "rewound state matches");
+  }
+  assert(!rewind.StepBack(machine) && "rewind history exhausted");
+
+  // recording resumes cleanly from the rewound state
+  const auto resumed = frames - kept;
+  for (std::size_t frame = resumed + 1; frame < frames; frame++) {
+    machine.RunFrame(static_cast<Word>(frame));
+    rewind.Record(machine);
+  }
+  assert(rewind.StepBack(machine) && "rewind after resuming");
+  expected.LoadState(history.at(frames - 2));
+  assert(SameState(machine, expected) && "resumed run rewinds in step");
+}
@@ -0,0 +1,71 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <span>
+
+#include "hash.h"
+#include "movie.h"
+#include "rom_bench.h"
+#include "test_fixture.h"
+#include "test_rom_bench.h"
+
+using fixture8::LoadRom;
+using fixture8::spriteRom;
+
+void TestRomBench::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestRomBench::romBenchTest() {
+  const std::size_t frames = 30;
+  const Word keyMask = 0x4;
+
+  movie8::Movie movie(hash8::Fnv1a(spriteRom), Random8::defaultSeed,
+                      Memory8::loadAddrDefault, Machine8::iptDefault);
+  Machine8 machine;
+  LoadRom(machine, spriteRom);
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    movie.Append(keyMask);
+    machine.RunFrame(keyMask);
+  }
+
+  // the benchmark runs the movie exactly, presenting and timing its frames
+  std::size_t presented = 0;
+  rombench8::Config config;
+  config.frames = frames;
+  config.movie = &movie;
+  config.present = [&presented](std::span<const Byte>) { presented++; };
+  const auto report = rombench8::Run(spriteRom, config);
+
+  assert((report.stateHash == machine.StateHash()) &&
+         (report.instructions == machine.InstructionCount()) &&
+         "benchmark follows the movie");
+  assert((presented > 0) && (report.seconds > 0.0) &&
+         (report.frameP50 <= report.frameP99) &&
+         "benchmark presents and times frames");
+}
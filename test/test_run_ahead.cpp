@@ -0,0 +1,113 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "profiler.h"
+#include "run_ahead.h"
+#include "test_fixture.h"
+#include "test_run_ahead.h"
+
+using fixture8::LoadRom;
+using fixture8::SameState;
+using fixture8::spriteRom;
+
+void TestRunAhead::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestRunAhead::runAheadTest() {
+  const std::size_t frames = 90;
+  const std::size_t ahead = 3;
+  const Word keyMask = 0x4;
+
+  Machine8 machine;
+  Machine8 reference;
+  LoadRom(machine, spriteRom);
+  LoadRom(reference, spriteRom);
+  RunAhead8 runAhead(ahead);
+
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    machine.RunFrame(keyMask);
+    const auto preview = runAhead.Preview(machine, keyMask);
+
+    // the preview shows the future, but the machine carries on unchanged
+    reference.RunFrame(keyMask);
+    assert(SameState(machine, reference) && "run-ahead leaves machine alone");
+
+    MachineState8 saved;
+    reference.SaveState(saved);
+    for (std::size_t step = 0; step < ahead; step++) {
+      reference.RunFrame(keyMask);
+    }
+    const auto future = reference.Display().Data();
+    assert(std::equal(preview.begin(), preview.end(), future.begin()) &&
+           "run-ahead shows the future frame");
+    reference.LoadState(saved);
+  }
+
+  // previews must not touch the allocator either
+  const auto before = alloc8::ThreadAllocations();
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    machine.RunFrame(keyMask);
+    std::ignore = runAhead.Preview(machine, keyMask);
+  }
+  assert((alloc8::ThreadAllocations() == before) && "run-ahead alloc-free");
+}
+
+void TestRunAhead::runAheadFaultTest() {
+  // returns with an empty stack while key 5 is held
+  const std::vector<Byte> faultRom = {0x60, 0x05, 0xE0, 0xA1,
+                                      0x00, 0xEE, 0x12, 0x02};
+  const auto keyMask = static_cast<Word>(1U << 0x5);
+
+  Machine8 machine;
+  Machine8 reference;
+  LoadRom(machine, faultRom);
+  LoadRom(reference, faultRom);
+  auto profiler = std::make_unique<Profiler8>();
+  machine.SetProfiler(profiler.get());
+  machine.RunFrame(0x0);
+  reference.RunFrame(0x0);
+  const auto profiled = profiler->Instructions();
+
+  // the guessed key faults, which must neither escape nor leave a trace
+  RunAhead8 runAhead(RunAhead8::maxFrames);
+  const auto preview = runAhead.Preview(machine, keyMask);
+  const auto present = machine.Display().Data();
+  assert(std::equal(preview.begin(), preview.end(), present.begin()) &&
+         "a faulting guess shows the present frame");
+  assert(SameState(machine, reference) && "a faulting guess is undone");
+  assert((machine.Profiler() == profiler.get()) &&
+         (profiler->Instructions() == profiled) &&
+         "preview frames are not profiled");
+}
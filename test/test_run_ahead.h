@@ -0,0 +1,47 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TEST_RUN_AHEAD_H
+#define TEST_RUN_AHEAD_H
+
+#include <map>
+#include <string>
+
+#include "test.h"
+
+class TestRunAhead;
+using RunAheadMemFn = void (TestRunAhead::*)();
+
+class TestRunAhead : public Test {
+public:
+  TestRunAhead() = default;
+  void runTests() override;
+
+private:
+  void runAheadTest();
+  void runAheadFaultTest();
+
+  const std::map<std::string, RunAheadMemFn> functionMap_ = {
+      {"Run-ahead preview", &TestRunAhead::runAheadTest},
+      {"Run-ahead faulting guess", &TestRunAhead::runAheadFaultTest}};
+};
+
+#endif /* TEST_RUN_AHEAD_H */
@@ -0,0 +1,115 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "emu8.h"
+#include "save_state.h"
+#include "test_fixture.h"
+#include "test_save_state.h"
+
+using fixture8::LoadRom;
+using fixture8::SameState;
+using fixture8::spriteRom;
+
+void TestSaveState::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestSaveState::saveStateRoundTripTest() {
+  const uint64_t seed = 0xC8;
+  Machine8 original(Memory8::loadAddrDefault, Machine8::iptDefault, seed);
+  LoadRom(original, spriteRom);
+
+  const std::size_t frames = 120;
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    original.RunFrame(static_cast<Word>(frame));
+  }
+
+  // encode and decode, then check both copies evolve identically
+  MachineState8 state;
+  original.SaveState(state);
+  std::vector<Byte> image;
+  state8::Serialize(state, image);
+  assert((image.size() == state8::fileSize) && "save state size");
+
+  MachineState8 decoded;
+  state8::Deserialize(image, decoded);
+  Machine8 restored;
+  restored.LoadState(decoded);
+  assert(SameState(original, restored) && "restored state matches");
+
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    original.RunFrame(static_cast<Word>(frame));
+    restored.RunFrame(static_cast<Word>(frame));
+  }
+  assert(SameState(original, restored) && "restored machine runs in step");
+
+  // truncated images and unknown versions must be refused
+  const std::vector<Byte> truncated(image.begin(), image.end() - 1);
+  try {
+    state8::Deserialize(truncated, decoded);
+    assert(false && "truncated save state accepted");
+  } catch (const std::runtime_error &err) {
+    std::ignore = err;
+  }
+
+  auto badVersion = image;
+  badVersion.at(state8::fileMagic.size())++;
+  try {
+    state8::Deserialize(badVersion, decoded);
+    assert(false && "unknown save state version accepted");
+  } catch (const std::runtime_error &err) {
+    std::ignore = err;
+  }
+}
+
+void TestSaveState::saveStateFileTest() {
+  const auto path =
+      (std::filesystem::temp_directory_path() / "emu8_test.state").string();
+
+  Machine8 original;
+  LoadRom(original, spriteRom);
+  const std::size_t frames = 30;
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    original.RunFrame(0x0);
+  }
+
+  state8::SaveFile(original, path);
+  assert((std::filesystem::file_size(path) == state8::fileSize) &&
+         "save state file size");
+
+  Machine8 restored;
+  state8::LoadFile(restored, path);
+  assert(SameState(original, restored) && "state restored from file");
+
+  std::filesystem::remove(path);
+}
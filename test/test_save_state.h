@@ -0,0 +1,47 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TEST_SAVE_STATE_H
+#define TEST_SAVE_STATE_H
+
+#include <map>
+#include <string>
+
+#include "test.h"
+
+class TestSaveState;
+using SaveStateMemFn = void (TestSaveState::*)();
+
+class TestSaveState : public Test {
+public:
+  TestSaveState() = default;
+  void runTests() override;
+
+private:
+  void saveStateRoundTripTest();
+  void saveStateFileTest();
+
+  const std::map<std::string, SaveStateMemFn> functionMap_ = {
+      {"Save state round trip", &TestSaveState::saveStateRoundTripTest},
+      {"Save state file", &TestSaveState::saveStateFileTest}};
+};
+
+#endif /* TEST_SAVE_STATE_H */
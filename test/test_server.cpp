@@ -0,0 +1,207 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+#include "byte_stream.h"
+#include "server.h"
+#include "test_fixture.h"
+#include "test_server.h"
+
+using fixture8::LoadRom;
+using fixture8::spriteRom;
+
+void TestServer::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestServer::serverTest() {
+  const uint64_t seed = 9;
+  const Word keyMask = 0x4;
+  const uint32_t frames = 40;
+
+  server8::Server server(2);
+  const auto rom = server.AddRom(spriteRom);
+
+  // one request: length, op, tag, then the arguments
+  std::vector<Byte> input;
+  const auto request = [&input](server8::Op op, uint32_t tag,
+                                const auto &...args) {
+    std::vector<Byte> body;
+    ByteWriter writer(body);
+    writer.Put(static_cast<Byte>(op));
+    writer.Put(tag);
+    (writer.Put(args), ...);
+
+    ByteWriter(input).Put(static_cast<uint32_t>(body.size()));
+    input.insert(input.end(), body.begin(), body.end());
+  };
+
+  server8::Connection connection;
+  std::vector<Byte> output;
+  request(server8::Op::create, 1, rom, seed);
+  assert((server.Process(input, output, connection) == input.size()) &&
+         "request used");
+  ByteReader created(output, "Response");
+  std::ignore = created.Take(server8::lengthSize + 2 + sizeof(uint32_t));
+  const auto session = created.Get<uint32_t>();
+
+  // pipelined requests come back in order, answered together
+  input.clear();
+  output.clear();
+  request(server8::Op::step, 2, session, keyMask, frames);
+  request(server8::Op::snapshot, 3, session);
+  request(server8::Op::step, 4, session, keyMask, frames);
+  request(server8::Op::restore, 5, session, uint32_t{0});
+  request(server8::Op::display, 6, session);
+  request(server8::Op::close, 7, session);
+  request(server8::Op::step, 8, session, keyMask, frames);
+
+  // a partial request waits for the rest of its bytes
+  const auto complete = input.size();
+  request(server8::Op::close, 9, session);
+  input.pop_back();
+  assert((server.Process(input, output, connection) == complete) &&
+         "partial kept");
+
+  Machine8 reference(Memory8::loadAddrDefault, Machine8::iptDefault, seed);
+  LoadRom(reference, spriteRom);
+  for (uint32_t frame = 0; frame < frames; frame++) {
+    reference.RunFrame(keyMask);
+  }
+
+  ByteReader responses(output, "Response");
+  std::vector<server8::Status> statuses;
+  for (uint32_t tag = 2; tag <= 8; tag++) {
+    const auto length = responses.Get<uint32_t>();
+    ByteReader body(responses.Take(length), "Response");
+    std::ignore = body.Get<Byte>();
+    statuses.push_back(static_cast<server8::Status>(body.Get<Byte>()));
+    assert((body.Get<uint32_t>() == tag) && "responses in order");
+
+    // after restoring the snapshot the display is the one after one step
+    if (tag == 6) {
+      const auto pixels = body.Take(body.Remaining());
+      const auto expected = reference.Display().Data();
+      assert(std::equal(pixels.begin(), pixels.end(), expected.begin()) &&
+             (pixels.size() == expected.size()) && "display matches");
+    }
+  }
+
+  const std::vector<server8::Status> expected = {
+      server8::Status::ok, server8::Status::ok, server8::Status::ok,
+      server8::Status::ok, server8::Status::ok, server8::Status::ok,
+      server8::Status::notFound};
+  assert((statuses == expected) && "statuses match");
+  assert((server.OpenSessions() == 0) && "session closed");
+
+  // answer a batch of requests from a connection with one status each, and
+  // the first result
+  const auto answerFrom = [&](server8::Connection &from, uint32_t &first) {
+    output.clear();
+    assert((server.Process(input, output, from) == input.size()) &&
+           "request used");
+    input.clear();
+    ByteReader replies(output, "Response");
+    std::vector<server8::Status> got;
+    while (replies.Remaining() > 0) {
+      ByteReader body(replies.Take(replies.Get<uint32_t>()), "Response");
+      std::ignore = body.Get<Byte>();
+      got.push_back(static_cast<server8::Status>(body.Get<Byte>()));
+      std::ignore = body.Get<uint32_t>();
+      if (got.size() == 1 && body.Remaining() >= sizeof(first)) {
+        first = body.Get<uint32_t>();
+      }
+    }
+    return got;
+  };
+  const auto answer = [&](uint32_t &first) {
+    return answerFrom(connection, first);
+  };
+
+  // snapshots belong to their session, are bounded, and go when it closes;
+  // steps are bounded too
+  uint32_t owner = 0;
+  uint32_t other = 0;
+  uint32_t unused = 0;
+  input.clear();
+  request(server8::Op::create, 10, rom, seed);
+  std::ignore = answer(owner);
+  request(server8::Op::create, 11, rom, seed);
+  std::ignore = answer(other);
+  for (std::size_t snap = 0; snap <= server8::maxSnapshots; snap++) {
+    request(server8::Op::snapshot, 12, owner);
+  }
+  const auto taken = answer(unused);
+  assert((taken.back() == server8::Status::full) &&
+         (std::count(taken.begin(), taken.end(), server8::Status::ok) ==
+          server8::maxSnapshots) &&
+         "snapshots per session capped");
+
+  request(server8::Op::restore, 13, other, uint32_t{0});
+  request(server8::Op::drop, 14, other, uint32_t{0});
+  request(server8::Op::step, 15, owner, keyMask, server8::maxStepFrames + 1);
+  request(server8::Op::drop, 16, owner, uint32_t{0});
+  request(server8::Op::close, 17, owner);
+  const std::vector<server8::Status> scoped = {
+      server8::Status::notFound, server8::Status::notFound,
+      server8::Status::badRequest, server8::Status::ok, server8::Status::ok};
+  assert((answer(unused) == scoped) && "snapshots scoped to the session");
+
+  // the next session takes the freed slot, and starts with no snapshots
+  uint32_t reopened = 0;
+  request(server8::Op::create, 18, rom, seed);
+  std::ignore = answer(reopened);
+  request(server8::Op::restore, 19, reopened, uint32_t{1});
+  request(server8::Op::snapshot, 20, reopened);
+  const std::vector<server8::Status> fresh = {server8::Status::notFound,
+                                              server8::Status::ok};
+  assert((answer(unused) == fresh) && "snapshots freed on close");
+
+  // a connection that goes away takes the sessions it opened with it, and
+  // leaves the other connections' sessions alone
+  server8::Connection guest;
+  uint32_t visiting = 0;
+  server.Disconnect(connection);
+  assert((server.OpenSessions() == 0) && "sessions closed on disconnect");
+  request(server8::Op::create, 21, rom, seed);
+  std::ignore = answerFrom(guest, visiting);
+  request(server8::Op::create, 22, rom, seed);
+  std::ignore = answer(unused);
+  request(server8::Op::snapshot, 23, unused);
+  std::ignore = answer(unused);
+  server.Disconnect(connection);
+  assert((server.OpenSessions() == 1) && "only its own sessions closed");
+  request(server8::Op::step, 24, visiting, keyMask, frames);
+  const std::vector<server8::Status> stepped = {server8::Status::ok};
+  assert((answerFrom(guest, unused) == stepped) && "other session kept");
+  server.Disconnect(guest);
+  assert((server.OpenSessions() == 0) && "guest sessions closed");
+}
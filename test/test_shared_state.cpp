@@ -0,0 +1,101 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+
+#include "shared_state.h"
+#include "test_fixture.h"
+#include "test_shared_state.h"
+
+using fixture8::LoadRom;
+using fixture8::spriteRom;
+
+void TestSharedState::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestSharedState::sharedStateTest() {
+  const std::size_t frames = 2000;
+  const std::string name =
+      "/emu8-test-" + std::to_string(::getpid()); // NOLINT
+
+  Machine8 machine;
+  LoadRom(machine, spriteRom);
+  SharedExport8 exporter(name);
+  exporter.Publish(machine);
+
+  // a reader sees exactly what was published, in place
+  const SharedView8 view(name);
+  SharedFrame8 frame;
+  view.Read(frame);
+  const auto ram = machine.Memory().viewSequence(0, Memory8::memSize);
+  assert(std::equal(ram.begin(), ram.end(), frame.memory.begin()) &&
+         (frame.pc == machine.Registers().pc) && "published state read");
+
+  // a second emulator may not take over the segment, nor remove it
+  try {
+    SharedExport8 intruder(name);
+    assert(false && "segment shared by two exporters");
+  } catch (const std::runtime_error &err) {
+    std::ignore = err;
+  }
+  const SharedView8 still(name);
+
+  // a reader racing the writer only ever accepts whole frames, where the
+  // frame count and the copy of it in RAM agree
+  std::atomic<bool> torn{false};
+  std::thread reader([&] {
+    SharedFrame8 snapshot;
+    uint64_t last = 0;
+    while (last < frames) {
+      view.Read(snapshot);
+      const auto low = static_cast<Byte>(snapshot.frame);
+      if (snapshot.memory[0x300] != low || snapshot.display[0] != low ||
+          snapshot.frame < last) {
+        torn = true;
+      }
+      last = snapshot.frame;
+    }
+  });
+
+  for (std::size_t count = 1; count <= frames; count++) {
+    machine.EndFrame();
+    const auto low = static_cast<Byte>(machine.FrameCount());
+    machine.Memory().setByte(0x300, low);
+    machine.Display().Load(FrameBuffer8::Buffer{low});
+    exporter.Publish(machine);
+  }
+  reader.join();
+  assert(!torn && "seqlock never shows a torn frame");
+}
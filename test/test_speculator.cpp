@@ -0,0 +1,115 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "speculator.h"
+#include "test_fixture.h"
+#include "test_speculator.h"
+
+using fixture8::LoadRom;
+using fixture8::SameState;
+using fixture8::keyWaitRom;
+
+void TestSpeculator::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestSpeculator::speculationTest() {
+  const std::size_t threads = 3;
+  const std::size_t idleFrames = 5;
+
+  Machine8 machine;
+  Machine8 reference;
+  LoadRom(machine, keyWaitRom);
+  LoadRom(reference, keyWaitRom);
+  Speculator8 speculator(machine.GetMemBase(),
+                         machine.GetInstructionsPerTick(), threads);
+
+  // no key: nothing to commit, the frame runs as usual
+  for (std::size_t frame = 0; frame < idleFrames; frame++) {
+    speculator.Begin(machine);
+    assert(machine.WaitingForKey() && "blocked on Fx0A");
+    assert(!speculator.TryCommit(machine, 0x0) && "no key, no commit");
+    machine.EndFrame();
+    reference.RunFrame(0x0);
+  }
+
+  // every single key commits exactly the frame it would have produced
+  MachineState8 waiting;
+  machine.SaveState(waiting);
+  for (std::size_t key = 0; key < Keypad8::keyCount; key++) {
+    machine.LoadState(waiting);
+    reference.LoadState(waiting);
+    const auto keyMask = static_cast<Word>(1U << key);
+
+    speculator.Begin(machine);
+    assert(speculator.TryCommit(machine, keyMask) && "key press committed");
+    reference.RunFrame(keyMask);
+    assert(SameState(machine, reference) && "committed frame matches");
+  }
+
+  // chords and stale speculations fall back to normal execution
+  machine.LoadState(waiting);
+  speculator.Begin(machine);
+  assert(!speculator.TryCommit(machine, 0x3) && "chord not committed");
+
+  speculator.Begin(machine);
+  machine.RunFrame(0x0);
+  assert(!speculator.TryCommit(machine, 0x1) && "stale speculation dropped");
+
+  // waits for a key and returns with an empty stack if it is key 5: that
+  // branch faults on its worker, which must survive to serve the others
+  const std::vector<Byte> faultRom = {0xF0, 0x0A, 0x40, 0x05,
+                                      0x00, 0xEE, 0x12, 0x00};
+  const std::size_t faultKey = 0x5;
+  const auto faultMask = static_cast<Word>(1U << faultKey);
+  Machine8 faulting;
+  LoadRom(faulting, faultRom);
+  faulting.RunFrame(0x0);
+  faulting.SaveState(waiting);
+  for (std::size_t key = 0; key < Keypad8::keyCount; key++) {
+    faulting.LoadState(waiting);
+    const auto keyMask = static_cast<Word>(1U << key);
+    speculator.Begin(faulting);
+    assert((speculator.TryCommit(faulting, keyMask) == (key != faultKey)) &&
+           "only the faulting branch runs normally");
+  }
+
+  faulting.LoadState(waiting);
+  speculator.Begin(faulting);
+  assert(!speculator.TryCommit(faulting, faultMask) && "fault not cached");
+  try {
+    faulting.RunFrame(faultMask);
+    assert(false && "the real frame faults");
+  } catch (const std::runtime_error &err) {
+    std::ignore = err;
+  }
+}
@@ -0,0 +1,71 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "timeline.h"
+#include "test_timeline.h"
+
+void TestTimeline::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestTimeline::timelineTest() {
+  const std::size_t capacity = 2;
+  const uint64_t frame = 7;
+
+  // without a timeline a scope records nothing
+  { const Timeline8::Scope scope(nullptr, Timeline8::Track::audio, "unused"); }
+
+  Timeline8 timeline(capacity);
+  for (std::size_t event = 0; event <= capacity; event++) {
+    const Timeline8::Scope scope(&timeline, Timeline8::Track::emulation,
+                                 "execute", frame);
+  }
+  { const Timeline8::Scope scope(&timeline, Timeline8::Track::audio, "fill"); }
+
+  std::ostringstream out;
+  timeline.Write(out);
+  const auto json = out.str();
+  const auto count = [&json](const std::string &needle) {
+    std::size_t found = 0;
+    for (auto pos = json.find(needle); pos != std::string::npos;
+         pos = json.find(needle, pos + 1)) {
+      found++;
+    }
+    return found;
+  };
+  assert((json.find("\"traceEvents\"") != std::string::npos) &&
+         "timeline is a trace-event document");
+  assert((count("\"name\": \"execute\"") == capacity) &&
+         "a full track drops further events");
+  assert((count("\"name\": \"fill\"") == 1) &&
+         (count("\"name\": \"unused\"") == 0) &&
+         "events land only on the timeline they were given");
+}
@@ -0,0 +1,45 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TEST_TIMELINE_H
+#define TEST_TIMELINE_H
+
+#include <map>
+#include <string>
+
+#include "test.h"
+
+class TestTimeline;
+using TimelineMemFn = void (TestTimeline::*)();
+
+class TestTimeline : public Test {
+public:
+  TestTimeline() = default;
+  void runTests() override;
+
+private:
+  void timelineTest();
+
+  const std::map<std::string, TimelineMemFn> functionMap_ = {
+      {"Frame timeline", &TestTimeline::timelineTest}};
+};
+
+#endif /* TEST_TIMELINE_H */
@@ -0,0 +1,89 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "test_fixture.h"
+#include "trace.h"
+#include "test_trace.h"
+
+using fixture8::LoadRom;
+using fixture8::spriteRom;
+
+void TestTrace::runTests() {
+  for (const auto &[desc, func] : functionMap_) {
+    std::cout << "Running " << desc << "...";
+    std::invoke(func, this);
+    std::cout << "PASSED\n";
+  }
+}
+
+void TestTrace::traceTest() {
+  const std::size_t frames = 30;
+  const std::size_t length = 5;
+  const Word keyMask = 0x4;
+
+  // the ring keeps only the newest entries, rounded up to a power of two
+  Trace8 trace(length);
+  Machine8 machine;
+  LoadRom(machine, spriteRom);
+  machine.SetTrace(&trace);
+  for (std::size_t frame = 0; frame < frames; frame++) {
+    machine.RunFrame(keyMask);
+  }
+
+  const auto entries = trace.Entries();
+  const auto &last = entries.back();
+  assert((trace.Length() == 8) && (entries.size() == trace.Length()) &&
+         (trace.Recorded() == machine.InstructionCount()) &&
+         "trace keeps the newest instructions");
+  assert((last.opcode == machine.Memory().fetchInstruction(last.pc)) &&
+         "entries hold the opcode run at their PC");
+
+  std::vector<Byte> image;
+  trace.Serialize(image);
+  const auto copy = Trace8::Deserialize(image);
+  const auto copied = copy.Entries();
+  assert((copy.Recorded() == trace.Recorded()) &&
+         std::equal(copied.begin(), copied.end(), entries.begin(),
+                    entries.end(),
+                    [](const auto &lhs, const auto &rhs) {
+                      return lhs.pc == rhs.pc && lhs.opcode == rhs.opcode &&
+                             lhs.regI == rhs.regI && lhs.valX == rhs.valX &&
+                             lhs.valY == rhs.valY;
+                    }) &&
+         "trace survives a round trip");
+
+  image.pop_back();
+  bool thrown = false;
+  try {
+    std::ignore = Trace8::Deserialize(image);
+  } catch (const std::runtime_error &err) {
+    thrown = true;
+  }
+  assert(thrown && "truncated trace is rejected");
+}
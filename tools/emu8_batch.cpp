@@ -0,0 +1,269 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "batch_run.h"
+#include "byte_stream.h"
+#include "common.h"
+#include "machine.h"
+#include "memory.h"
+#include "movie.h"
+#include "work_pool.h"
+
+namespace bpo = boost::program_options;
+namespace fs = std::filesystem;
+
+namespace {
+
+// frames run per ROM when no limit is given at all: one emulated minute
+constexpr uint64_t defaultFrames = 3600;
+
+struct BatchSettings {
+  std::vector<std::string> inputs{};
+  std::string listFile{};
+  std::string movieDir{};
+  std::string outputFile{};
+  std::size_t threads{WorkPool8::DefaultThreads()};
+  bool affinity{false};
+  batch8::RunConfig config{};
+};
+
+void usage(const std::string &prog) {
+  const fs::path progPath{prog};
+  std::cerr << "usage: " << progPath.filename().string() << " "
+            << "[--affinity] [--eti660] [--frames count] [--help] "
+            << "[--instructions count] [--ipt count] [--list file] "
+            << "[--movies dir] [--output file] [--seconds limit] "
+            << "[--seed value] [--threads count] [rom|dir ...]\n";
+}
+
+auto parse_options(int argc, std::vector<char *> &argv,
+                   BatchSettings &settings) -> bool {
+  auto &config = settings.config;
+  auto &budget = config.budget;
+
+  bpo::options_description visible("Options");
+  // clang-format off
+  visible.add_options()
+    ("affinity", bpo::bool_switch(&settings.affinity),
+     "Pin each worker thread to its own CPU")
+    ("eti660", "Load ROMs using ETI 660 address conventions")
+    ("frames", bpo::value<uint64_t>(&budget.frames),
+     "Frame limit per ROM")
+    ("help", "Display help message")
+    ("instructions", bpo::value<uint64_t>(&budget.instructions),
+     "Instruction limit per ROM")
+    ("ipt", bpo::value<std::size_t>(&config.ipt)
+                    ->default_value(Machine8::iptDefault),
+     "Instructions per tick")
+    ("list", bpo::value<std::string>(&settings.listFile),
+     "File listing ROM paths, one per line")
+    ("movies", bpo::value<std::string>(&settings.movieDir),
+     "Directory holding input movies named after each ROM plus .movie")
+    ("output", bpo::value<std::string>(&settings.outputFile),
+     "Write JSON lines here instead of standard output")
+    ("seconds", bpo::value<double>(&budget.seconds),
+     "Wall time limit per ROM")
+    ("seed", bpo::value<uint64_t>(&config.seed),
+     "Random number generator seed for every run")
+    ("threads", bpo::value<std::size_t>(&settings.threads)
+                    ->default_value(WorkPool8::DefaultThreads()),
+     "Worker threads");
+  // clang-format on
+
+  bpo::options_description hidden("Hidden options");
+  // clang-format off
+  hidden.add_options()
+    ("inputs", bpo::value<std::vector<std::string>>(&settings.inputs),
+     "ROM files or directories");
+  // clang-format on
+
+  bpo::options_description cmdlineOptions;
+  cmdlineOptions.add(visible).add(hidden);
+
+  bpo::positional_options_description posOpt;
+  posOpt.add("inputs", -1);
+
+  bpo::variables_map varMap;
+  bpo::store(bpo::command_line_parser(argc, argv.data())
+                 .options(cmdlineOptions)
+                 .positional(posOpt)
+                 .run(),
+             varMap);
+  bpo::notify(varMap);
+
+  if (varMap.count("help") != 0) {
+    std::cout << visible << '\n';
+    return false;
+  }
+
+  if (varMap.count("eti660") != 0) {
+    config.memBase = Memory8::loadAddrEti660;
+  }
+
+  if (config.ipt == 0 || config.ipt > Machine8::iptMax) {
+    throw std::invalid_argument("--ipt must be from 1 to " +
+                                std::to_string(Machine8::iptMax));
+  }
+
+  return !settings.inputs.empty() || !settings.listFile.empty();
+}
+
+// expand directories (non-recursively, in name order) and list files into
+// individual ROM paths
+auto collect_roms(const BatchSettings &settings) -> std::vector<std::string> {
+  std::vector<std::string> roms;
+
+  if (!settings.listFile.empty()) {
+    std::ifstream list(settings.listFile);
+    if (!list.good()) {
+      throw std::runtime_error("Could not open ROM list: " +
+                               settings.listFile);
+    }
+
+    std::string line;
+    while (std::getline(list, line)) {
+      if (!line.empty() && line.front() != '#') {
+        roms.push_back(line);
+      }
+    }
+  }
+
+  for (const auto &input : settings.inputs) {
+    if (!fs::is_directory(input)) {
+      roms.push_back(input);
+      continue;
+    }
+
+    std::vector<std::string> entries;
+    for (const auto &entry : fs::directory_iterator(input)) {
+      const auto ext = entry.path().extension();
+      if (entry.is_regular_file() && ext != ".movie" && ext != ".state" &&
+          ext != ".core") {
+        entries.push_back(entry.path().string());
+      }
+    }
+    std::sort(entries.begin(), entries.end());
+    roms.insert(roms.end(), entries.begin(), entries.end());
+  }
+
+  return roms;
+}
+
+auto run_rom(const std::string &romPath, const BatchSettings &settings)
+    -> std::string {
+  batch8::RunResult result;
+  try {
+    const auto rom = ReadFileBytes(romPath);
+
+    std::optional<movie8::Movie> movie;
+    auto config = settings.config;
+    if (!settings.movieDir.empty()) {
+      const auto moviePath = fs::path(settings.movieDir) /
+                             (fs::path(romPath).filename().string() + ".movie");
+      if (fs::exists(moviePath)) {
+        movie = movie8::Movie::Load(moviePath.string());
+        config.movie = &movie.value();
+      }
+    }
+
+    const auto &budget = config.budget;
+    if (budget.frames == 0 && budget.instructions == 0 &&
+        budget.seconds <= 0.0 && config.movie == nullptr) {
+      config.budget.frames = defaultFrames;
+    }
+
+    result = batch8::Run(rom, config);
+  } catch (const std::exception &err) {
+    result.status = "error";
+    result.message = err.what();
+  }
+
+  return batch8::ToJson(romPath, result);
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  std::vector<char *> vecArgs(argv, argv + argc);
+
+  BatchSettings settings;
+  std::vector<std::string> roms;
+  try {
+    if (!parse_options(argc, vecArgs, settings)) {
+      usage(vecArgs.front());
+      return EXIT_FAILURE;
+    }
+    roms = collect_roms(settings);
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << '\n';
+    usage(vecArgs.front());
+    return EXIT_FAILURE;
+  }
+
+  // opened first, so that a bad path is reported before any work is done
+  std::ofstream outFile;
+  if (!settings.outputFile.empty()) {
+    outFile.open(settings.outputFile, std::ios::trunc);
+    if (!outFile.good()) {
+      std::cerr << "Could not create output file: " << settings.outputFile
+                << '\n';
+      return EXIT_FAILURE;
+    }
+  }
+  auto &out = settings.outputFile.empty() ? std::cout : outFile;
+
+  // results print in input order so that runs are easy to compare; each one
+  // is written and flushed as soon as every result before it is in, so an
+  // interrupted run keeps what it finished
+  std::vector<std::string> lines(roms.size());
+  std::vector<bool> done(roms.size(), false);
+  std::size_t written = 0;
+  std::mutex outMutex;
+  WorkPool8 pool(settings.threads, settings.affinity);
+  pool.Run(roms.size(), [&](std::size_t job, std::size_t /*worker*/) {
+    auto line = run_rom(roms[job], settings);
+
+    const std::lock_guard<std::mutex> lock(outMutex);
+    lines[job] = std::move(line);
+    done[job] = true;
+    for (; written < lines.size() && done[written]; written++) {
+      out << lines[written] << '\n';
+      lines[written].clear();
+    }
+    out.flush();
+  });
+
+  return out.good() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
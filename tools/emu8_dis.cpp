@@ -0,0 +1,119 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "byte_stream.h"
+#include "common.h"
+#include "disassembler.h"
+#include "memory.h"
+
+namespace bpo = boost::program_options;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct DisSettings {
+  std::string romFile{};
+  Address memBase{Memory8::loadAddrDefault};
+};
+
+void usage(const std::string &prog) {
+  const fs::path progPath{prog};
+  std::cerr << "usage: " << progPath.filename().string() << " "
+            << "[--eti660] [--help] romfile\n";
+}
+
+auto parse_options(int argc, std::vector<char *> &argv,
+                   DisSettings &settings) -> bool {
+  bpo::options_description visible("Options");
+  // clang-format off
+  visible.add_options()
+    ("eti660", "Load the ROM using ETI 660 address conventions")
+    ("help", "Display help message");
+  // clang-format on
+
+  bpo::options_description hidden("Hidden options");
+  // clang-format off
+  hidden.add_options()
+    ("rom", bpo::value<std::string>(&settings.romFile), "ROM file");
+  // clang-format on
+
+  bpo::options_description cmdlineOptions;
+  cmdlineOptions.add(visible).add(hidden);
+
+  bpo::positional_options_description posOpt;
+  posOpt.add("rom", 1);
+
+  bpo::variables_map varMap;
+  bpo::store(bpo::command_line_parser(argc, argv.data())
+                 .options(cmdlineOptions)
+                 .positional(posOpt)
+                 .run(),
+             varMap);
+  bpo::notify(varMap);
+
+  if (varMap.count("help") != 0) {
+    std::cout << visible << '\n';
+    return false;
+  }
+
+  if (varMap.count("eti660") != 0) {
+    settings.memBase = Memory8::loadAddrEti660;
+  }
+
+  return !settings.romFile.empty();
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  std::vector<char *> vecArgs(argv, argv + argc);
+
+  DisSettings settings;
+  try {
+    if (!parse_options(argc, vecArgs, settings)) {
+      usage(vecArgs.front());
+      return EXIT_FAILURE;
+    }
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << '\n';
+    usage(vecArgs.front());
+    return EXIT_FAILURE;
+  }
+
+  try {
+    const auto rom = ReadFileBytes(settings.romFile);
+    const auto analysis = dis8::Analyze(rom, settings.memBase);
+    dis8::Print(std::cout, rom, analysis);
+  } catch (const std::exception &err) {
+    std::cerr << "ERROR: " << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,244 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "byte_stream.h"
+#include "common.h"
+#include "explorer.h"
+#include "hash.h"
+#include "keypad.h"
+#include "machine.h"
+#include "memory.h"
+#include "movie.h"
+
+namespace bpo = boost::program_options;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct ExploreSettings {
+  std::string romFile{};
+  std::string mode{"bfs"};
+  std::string keys{};
+  std::string goal{};
+  std::string movieFile{};
+  Explorer8::Config config{};
+};
+
+void usage(const std::string &prog) {
+  const fs::path progPath{prog};
+  std::cerr << "usage: " << progPath.filename().string() << " "
+            << "[--depth count] [--eti660] [--frames count] "
+            << "[--goal addr=value] [--help] [--ipt count] [--keys digits] "
+            << "[--mode bfs|novelty] [--saveMovie file] [--seed value] "
+            << "[--states count] rom\n";
+}
+
+// "addr=value", each in decimal, or hex with a 0x prefix
+auto parse_goal(const std::string &text) -> Explorer8::Goal {
+  const auto split = text.find('=');
+  if (split == std::string::npos) {
+    throw std::invalid_argument("Goal must look like addr=value: " + text);
+  }
+
+  const auto addr = std::stoul(text.substr(0, split), nullptr, 0);
+  const auto value = std::stoul(text.substr(split + 1), nullptr, 0);
+  if (addr >= Memory8::memSize || value > BYTE_MAX) {
+    throw std::invalid_argument("Goal out of range: " + text);
+  }
+
+  return {static_cast<Address>(addr), static_cast<Byte>(value)};
+}
+
+// no keys, plus one action per hex digit given
+auto parse_keys(const std::string &digits) -> std::vector<Word> {
+  std::vector<Word> actions = {0x0};
+  for (const auto digit : digits) {
+    if (std::isxdigit(static_cast<unsigned char>(digit)) == 0) {
+      throw std::invalid_argument("Keys must be hex digits: " + digits);
+    }
+    const auto key = std::stoul(std::string(1, digit), nullptr, 16);
+    actions.push_back(static_cast<Word>(1U << key));
+  }
+  return actions;
+}
+
+auto parse_options(int argc, std::vector<char *> &argv,
+                   ExploreSettings &settings) -> bool {
+  auto &config = settings.config;
+
+  bpo::options_description visible("Options");
+  // clang-format off
+  visible.add_options()
+    ("depth", bpo::value<std::size_t>(&config.maxDepth)
+                  ->default_value(config.maxDepth),
+     "Longest input sequence, in actions")
+    ("eti660", "Load the ROM using ETI 660 address conventions")
+    ("frames", bpo::value<std::size_t>(&config.framesPerAction)
+                   ->default_value(config.framesPerAction),
+     "Frames each action holds its keys")
+    ("goal", bpo::value<std::string>(&settings.goal),
+     "Stop when RAM address addr holds value (addr=value)")
+    ("help", "Display help message")
+    ("ipt", bpo::value<std::size_t>(&config.ipt)
+                ->default_value(Machine8::iptDefault),
+     "Instructions per tick")
+    ("keys", bpo::value<std::string>(&settings.keys),
+     "Keys to try, as hex digits (default all)")
+    ("mode", bpo::value<std::string>(&settings.mode)->default_value("bfs"),
+     "Search mode: bfs keeps every new state, novelty only states with "
+     "RAM values not seen before")
+    ("saveMovie", bpo::value<std::string>(&settings.movieFile),
+     "Write the solution as an input movie")
+    ("seed", bpo::value<uint64_t>(&config.seed),
+     "Random number generator seed")
+    ("states", bpo::value<std::size_t>(&config.maxStates)
+                   ->default_value(config.maxStates),
+     "Distinct states to keep before stopping");
+  // clang-format on
+
+  bpo::options_description hidden("Hidden options");
+  // clang-format off
+  hidden.add_options()
+    ("rom", bpo::value<std::string>(&settings.romFile), "ROM file");
+  // clang-format on
+
+  bpo::options_description cmdlineOptions;
+  cmdlineOptions.add(visible).add(hidden);
+
+  bpo::positional_options_description posOpt;
+  posOpt.add("rom", 1);
+
+  bpo::variables_map varMap;
+  bpo::store(bpo::command_line_parser(argc, argv.data())
+                 .options(cmdlineOptions)
+                 .positional(posOpt)
+                 .run(),
+             varMap);
+  bpo::notify(varMap);
+
+  if (varMap.count("help") != 0) {
+    std::cout << visible << '\n';
+    return false;
+  }
+
+  if (varMap.count("eti660") != 0) {
+    config.memBase = Memory8::loadAddrEti660;
+  }
+
+  if (settings.mode == "novelty") {
+    config.mode = Explorer8::Mode::novelty;
+  } else if (settings.mode != "bfs") {
+    throw std::invalid_argument("Unknown search mode: " + settings.mode);
+  }
+
+  if (!settings.keys.empty()) {
+    config.actions = parse_keys(settings.keys);
+  }
+
+  if (!settings.goal.empty()) {
+    config.goal = parse_goal(settings.goal);
+  }
+
+  return !settings.romFile.empty();
+}
+
+void save_movie(const ExploreSettings &settings, const std::vector<Byte> &rom,
+                const Explorer8::Result &result) {
+  const auto &config = settings.config;
+  movie8::Movie movie(hash8::Fnv1a(rom), config.seed, config.memBase,
+                      config.ipt);
+  for (const auto keyMask : result.solution) {
+    for (std::size_t frame = 0; frame < config.framesPerAction; frame++) {
+      movie.Append(keyMask);
+    }
+  }
+  movie.Save(settings.movieFile);
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  std::vector<char *> vecArgs(argv, argv + argc);
+
+  ExploreSettings settings;
+  try {
+    if (!parse_options(argc, vecArgs, settings)) {
+      usage(vecArgs.front());
+      return EXIT_FAILURE;
+    }
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << '\n';
+    usage(vecArgs.front());
+    return EXIT_FAILURE;
+  }
+
+  try {
+    const auto rom = ReadFileBytes(settings.romFile);
+    Explorer8 explorer(settings.config);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = explorer.Run(rom);
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::cout << "depth: " << result.depth << '\n'
+              << "branches: " << result.branches << '\n'
+              << "states: " << result.states << '\n'
+              << "duplicates: " << result.duplicates << '\n'
+              << "pruned: " << result.pruned << '\n'
+              << "faults: " << result.faults << '\n'
+              << "covered: " << result.covered << " instruction addresses\n"
+              << "seconds: " << elapsed.count() << '\n';
+
+    if (settings.config.goal.has_value()) {
+      std::cout << "solved: " << (result.solved ? "yes" : "no") << '\n';
+    }
+
+    if (result.solved) {
+      std::cout << "solution:" << std::hex;
+      for (const auto keyMask : result.solution) {
+        std::cout << ' ' << std::setw(4) << std::setfill('0') << keyMask;
+      }
+      std::cout << std::dec << '\n';
+
+      if (!settings.movieFile.empty()) {
+        save_movie(settings, rom, result);
+      }
+    }
+  } catch (const std::exception &err) {
+    std::cerr << "ERROR: " << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "common.h"
+#include "profiler.h"
+#include "trace.h"
+
+namespace bpo = boost::program_options;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct TraceSettings {
+  std::string traceFile{};
+  std::size_t last{0};
+};
+
+void usage(const std::string &prog) {
+  const fs::path progPath{prog};
+  std::cerr << "usage: " << progPath.filename().string() << " "
+            << "[--help] [--last count] tracefile\n";
+}
+
+auto parse_options(int argc, std::vector<char *> &argv,
+                   TraceSettings &settings) -> bool {
+  bpo::options_description visible("Options");
+  // clang-format off
+  visible.add_options()
+    ("help", "Display help message")
+    ("last", bpo::value<std::size_t>(&settings.last),
+     "Only show the last count instructions");
+  // clang-format on
+
+  bpo::options_description hidden("Hidden options");
+  // clang-format off
+  hidden.add_options()
+    ("trace", bpo::value<std::string>(&settings.traceFile), "Trace file");
+  // clang-format on
+
+  bpo::options_description cmdlineOptions;
+  cmdlineOptions.add(visible).add(hidden);
+
+  bpo::positional_options_description posOpt;
+  posOpt.add("trace", 1);
+
+  bpo::variables_map varMap;
+  bpo::store(bpo::command_line_parser(argc, argv.data())
+                 .options(cmdlineOptions)
+                 .positional(posOpt)
+                 .run(),
+             varMap);
+  bpo::notify(varMap);
+
+  if (varMap.count("help") != 0) {
+    std::cout << visible << '\n';
+    return false;
+  }
+
+  return !settings.traceFile.empty();
+}
+
+// one instruction per line, numbered from the start of the run; Vx and Vy
+// are the registers the opcode names, as they were before it ran
+void print_trace(const Trace8 &trace, std::size_t last) {
+  constexpr int seqWidth = 12;
+
+  auto entries = trace.Entries();
+  if (last > 0 && last < entries.size()) {
+    entries.erase(entries.begin(),
+                  entries.end() - static_cast<std::ptrdiff_t>(last));
+  }
+
+  std::cout << trace.Recorded() << " instructions recorded, last "
+            << entries.size() << " shown\n"
+            << std::setw(seqWidth) << "seq"
+            << "  pc     opcode  class    I      Vx  Vy\n";
+
+  auto seq = trace.Recorded() - entries.size();
+  for (const auto &entry : entries) {
+    std::cout << std::dec << std::setfill(' ') << std::setw(seqWidth) << seq
+              << std::hex << std::uppercase << std::setfill('0') << "  0x"
+              << std::setw(3) << entry.pc << "  " << std::setw(4)
+              << entry.opcode << "    " << std::left << std::setfill(' ')
+              << std::setw(7)
+              << Profiler8::ClassName(Profiler8::Classify(entry.opcode))
+              << std::right << std::setfill('0') << "  " << std::setw(4)
+              << entry.regI << "   " << std::setw(2) << unsigned{entry.valX}
+              << "  " << std::setw(2) << unsigned{entry.valY} << '\n';
+    seq++;
+  }
+  std::cout << std::dec << std::nouppercase;
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  std::vector<char *> vecArgs(argv, argv + argc);
+
+  TraceSettings settings;
+  try {
+    if (!parse_options(argc, vecArgs, settings)) {
+      usage(vecArgs.front());
+      return EXIT_FAILURE;
+    }
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << '\n';
+    usage(vecArgs.front());
+    return EXIT_FAILURE;
+  }
+
+  try {
+    print_trace(Trace8::Load(settings.traceFile), settings.last);
+  } catch (const std::exception &err) {
+    std::cerr << "ERROR: " << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,349 @@
+/*
+ * emu8 - a C++ Chip-8 emulation program
+ * Copyright (C) 2023 Thomas Allen
+ *
+ * Contact: allen.thomas.c@gmail.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "byte_stream.h"
+#include "common.h"
+#include "machine.h"
+#include "memory.h"
+#include "server.h"
+
+namespace bpo = boost::program_options;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::size_t defaultSessions = 256;
+constexpr std::size_t readChunk = 0x10000;
+constexpr int listenBacklog = 64;
+
+volatile std::sig_atomic_t stopRequested = 0; // NOLINT
+
+extern "C" void request_stop(int /*signal*/) { stopRequested = 1; }
+
+struct DaemonSettings {
+  std::string socketPath{"emu8d.sock"};
+  std::vector<std::string> roms{};
+  std::size_t sessions{defaultSessions};
+  std::size_t memBase{Memory8::loadAddrDefault};
+  std::size_t ipt{Machine8::iptDefault};
+  bool hugePages{false};
+};
+
+struct Client {
+  int fd{-1};
+  std::vector<Byte> input{};
+  std::vector<Byte> output{};
+  std::size_t written{0};
+  server8::Connection connection{};
+};
+
+void usage(const std::string &prog) {
+  const fs::path progPath{prog};
+  std::cerr << "usage: " << progPath.filename().string() << " "
+            << "[--eti660] [--help] [--hugePages] [--ipt count] "
+            << "[--sessions count] [--socket path] [rom ...]\n";
+}
+
+auto parse_options(int argc, std::vector<char *> &argv,
+                   DaemonSettings &settings) -> bool {
+  bpo::options_description visible("Options");
+  // clang-format off
+  visible.add_options()
+    ("eti660", "Load ROMs using ETI 660 address conventions")
+    ("help", "Display help message")
+    ("hugePages", bpo::bool_switch(&settings.hugePages),
+     "Back the session pool with huge pages where available")
+    ("ipt", bpo::value<std::size_t>(&settings.ipt)
+                ->default_value(Machine8::iptDefault),
+     "Instructions per tick")
+    ("sessions", bpo::value<std::size_t>(&settings.sessions)
+                     ->default_value(defaultSessions),
+     "Machines kept ready for sessions")
+    ("socket", bpo::value<std::string>(&settings.socketPath)
+                   ->default_value(settings.socketPath),
+     "Path of the Unix socket to listen on");
+  // clang-format on
+
+  bpo::options_description hidden("Hidden options");
+  // clang-format off
+  hidden.add_options()
+    ("roms", bpo::value<std::vector<std::string>>(&settings.roms),
+     "ROMs to preload, numbered from 0");
+  // clang-format on
+
+  bpo::options_description cmdlineOptions;
+  cmdlineOptions.add(visible).add(hidden);
+
+  bpo::positional_options_description posOpt;
+  posOpt.add("roms", -1);
+
+  bpo::variables_map varMap;
+  bpo::store(bpo::command_line_parser(argc, argv.data())
+                 .options(cmdlineOptions)
+                 .positional(posOpt)
+                 .run(),
+             varMap);
+  bpo::notify(varMap);
+
+  if (varMap.count("help") != 0) {
+    std::cout << visible << '\n';
+    return false;
+  }
+
+  if (varMap.count("eti660") != 0) {
+    settings.memBase = Memory8::loadAddrEti660;
+  }
+
+  return true;
+}
+
+// remove the socket file an earlier server left behind, but only once it is
+// certain to be stale: it must be a socket, and nothing may be listening on it
+void clear_stale_socket(const std::string &path, const sockaddr_un &addr) {
+  struct stat info = {};
+  if (::lstat(path.c_str(), &info) < 0) {
+    if (errno == ENOENT) {
+      return;
+    }
+    throw std::runtime_error("Could not inspect " + path + ": " +
+                             std::strerror(errno));
+  }
+  if (!S_ISSOCK(info.st_mode)) {
+    throw std::runtime_error(path + " exists and is not a socket; refusing " +
+                             "to replace it");
+  }
+
+  const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (probe < 0) {
+    throw std::runtime_error(std::string("Could not create socket: ") +
+                             std::strerror(errno));
+  }
+  const int connected =
+      ::connect(probe, reinterpret_cast<const sockaddr *>(&addr), // NOLINT
+                sizeof(addr));
+  const int reason = errno;
+  ::close(probe);
+  if (connected == 0) {
+    throw std::runtime_error("Another server is already listening on " +
+                             path);
+  }
+  if (reason != ECONNREFUSED) {
+    throw std::runtime_error("Could not check whether " + path +
+                             " is in use: " + std::strerror(reason));
+  }
+
+  if (::unlink(path.c_str()) < 0) {
+    throw std::runtime_error("Could not remove stale socket " + path + ": " +
+                             std::strerror(errno));
+  }
+}
+
+auto open_socket(const std::string &path) -> int {
+  sockaddr_un addr = {};
+  if (path.size() >= sizeof(addr.sun_path)) {
+    throw std::invalid_argument("Socket path too long: " + path);
+  }
+  addr.sun_family = AF_UNIX;
+  std::copy(path.begin(), path.end(), std::begin(addr.sun_path));
+
+  const int listener =
+      ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listener < 0) {
+    throw std::runtime_error(std::string("Could not create socket: ") +
+                             std::strerror(errno));
+  }
+
+  try {
+    clear_stale_socket(path, addr);
+  } catch (...) {
+    ::close(listener);
+    throw;
+  }
+  if (::bind(listener, reinterpret_cast<sockaddr *>(&addr), // NOLINT
+             sizeof(addr)) < 0 ||
+      ::listen(listener, listenBacklog) < 0) {
+    const std::string reason = std::strerror(errno);
+    ::close(listener);
+    throw std::runtime_error("Could not listen on " + path + ": " + reason);
+  }
+
+  return listener;
+}
+
+// read whatever has arrived and answer every complete request in it; the
+// answers to one read go out together, in a single write where possible
+auto serve_client(Client &client, server8::Server &server) -> bool {
+  std::array<Byte, readChunk> chunk = {};
+  const auto got = ::read(client.fd, chunk.data(), chunk.size());
+  if (got == 0) {
+    return false;
+  }
+  if (got < 0) {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+  }
+
+  client.input.insert(client.input.end(), chunk.begin(),
+                      chunk.begin() + got);
+  try {
+    const auto used =
+        server.Process(client.input, client.output, client.connection);
+    client.input.erase(client.input.begin(),
+                       client.input.begin() +
+                           static_cast<std::ptrdiff_t>(used));
+  } catch (const std::exception &err) {
+    std::cerr << "Dropping client: " << err.what() << '\n';
+    return false;
+  }
+
+  return true;
+}
+
+auto flush_client(Client &client) -> bool {
+  while (client.written < client.output.size()) {
+    const auto sent =
+        ::send(client.fd, client.output.data() + client.written,
+               client.output.size() - client.written, MSG_NOSIGNAL);
+    if (sent < 0) {
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    client.written += static_cast<std::size_t>(sent);
+  }
+
+  client.output.clear();
+  client.written = 0;
+  return true;
+}
+
+void run(int listener, server8::Server &server) {
+  std::vector<Client> clients;
+  std::vector<pollfd> polls;
+
+  while (stopRequested == 0) {
+    polls.assign(1, pollfd{listener, POLLIN, 0});
+    for (const auto &client : clients) {
+      const short events = client.output.empty() ? POLLIN : POLLOUT;
+      polls.push_back(pollfd{client.fd, events, 0});
+    }
+
+    if (::poll(polls.data(), polls.size(), -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error(std::string("poll failed: ") +
+                               std::strerror(errno));
+    }
+
+    // clients are dropped from the back so indices into polls stay valid
+    for (std::size_t idx = clients.size(); idx > 0; idx--) {
+      auto &client = clients[idx - 1];
+      const auto revents = polls[idx].revents;
+      bool keep = true;
+
+      if ((revents & (POLLIN | POLLHUP)) != 0) {
+        keep = serve_client(client, server);
+      }
+      if (keep && !client.output.empty()) {
+        keep = flush_client(client);
+      }
+      if (!keep || (revents & (POLLERR | POLLNVAL)) != 0) {
+        // whatever the client left open goes with it, crashed or not
+        server.Disconnect(client.connection);
+        ::close(client.fd);
+        clients.erase(clients.begin() + static_cast<std::ptrdiff_t>(idx - 1));
+      }
+    }
+
+    if ((polls.front().revents & POLLIN) != 0) {
+      int accepted = -1;
+      while ((accepted = ::accept4(listener, nullptr, nullptr,
+                                   SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        clients.push_back(Client{accepted});
+      }
+    }
+  }
+
+  for (auto &client : clients) {
+    server.Disconnect(client.connection);
+    ::close(client.fd);
+  }
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  std::vector<char *> vecArgs(argv, argv + argc);
+
+  DaemonSettings settings;
+  try {
+    if (!parse_options(argc, vecArgs, settings)) {
+      usage(vecArgs.front());
+      return EXIT_FAILURE;
+    }
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << '\n';
+    usage(vecArgs.front());
+    return EXIT_FAILURE;
+  }
+
+  try {
+    server8::Server server(settings.sessions, settings.memBase, settings.ipt,
+                           settings.hugePages);
+    for (const auto &rom : settings.roms) {
+      std::cout << "rom " << server.AddRom(ReadFileBytes(rom)) << ": " << rom
+                << '\n';
+    }
+
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+
+    const int listener = open_socket(settings.socketPath);
+    std::cout << "listening on " << settings.socketPath << std::endl;
+    run(listener, server);
+
+    ::close(listener);
+    ::unlink(settings.socketPath.c_str());
+  } catch (const std::exception &err) {
+    std::cerr << "ERROR: " << err.what() << '\n';
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}